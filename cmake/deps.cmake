@@ -42,6 +42,22 @@ function(get_dependencies)
     add_subdirectory("${CMAKE_SOURCE_DIR}/external/fmt")
   endif()
 
+  # Optional, frame captures fall back to uncompressed PNG without it
+  find_package(ZLIB QUIET)
+  if(ZLIB_FOUND)
+    message(STATUS "Found system install of zlib.")
+  else()
+    message(STATUS "Could not find zlib, PNG captures will not be compressed.")
+  endif()
+
+  # Optional, images fall back to stb_image without it
+  find_package(JPEG QUIET)
+  if(JPEG_FOUND)
+    message(STATUS "Found system install of libjpeg.")
+  else()
+    message(STATUS "Could not find libjpeg, JPEG images will be decoded by stb_image.")
+  endif()
+
   add_library(glad "${CMAKE_SOURCE_DIR}/external/glad/src/glad.c")
   target_include_directories(glad PUBLIC "${CMAKE_SOURCE_DIR}/external/glad/include")
 
@@ -0,0 +1,339 @@
+#include "Animation.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define ANIMATION_USE_SSE
+#endif
+
+namespace Animation
+{
+
+static float getPhase(float time, float start, float inverse_duration, std::uint32_t playback) noexcept;
+static float ease(float weight, std::uint32_t easing) noexcept;
+
+std::size_t
+getComponentCount(TrackKind kind) noexcept
+{
+    switch (kind) {
+    case TrackKind::SCALAR:
+        return 1;
+    case TrackKind::VEC3:
+        return 3;
+    case TrackKind::COLOUR:
+    case TrackKind::ROTATION:
+        return 4;
+    }
+    return 1;
+}
+
+TrackGroup::TrackGroup(TrackKind track_kind) noexcept : kind{track_kind}, components{getComponentCount(track_kind)}
+{
+}
+
+TrackId
+TrackGroup::add(const Timing &timing, std::span<const float> track_key_times, std::span<const float> track_key_values, Easing easing)
+{
+    const std::size_t key_count = std::max(std::min(track_key_times.size(), track_key_values.size() / components), std::size_t{1});
+    if (starts.empty()) {
+        epoch = timing.start;
+    }
+    starts.push_back(static_cast<float>(timing.start - epoch));
+    inverse_durations.push_back(0.0 < timing.duration ? static_cast<float>(1.0 / timing.duration) : 0.0f);
+    playbacks.push_back(static_cast<std::uint32_t>(timing.playback));
+    easings.push_back(static_cast<std::uint32_t>(easing));
+    first_keys.push_back(static_cast<std::uint32_t>(key_times.size()));
+    key_counts.push_back(static_cast<std::uint32_t>(key_count));
+    cursors.push_back(0);
+
+    for (std::size_t key = 0; key < key_count; ++key) {
+        key_times.push_back(key < track_key_times.size() ? track_key_times[key] : 0.0f);
+        for (std::size_t component = 0; component < components; ++component) {
+            const std::size_t index = key * components + component;
+            key_values.push_back(index < track_key_values.size() ? track_key_values[index] : 0.0f);
+        }
+    }
+    /* Start at the first key until the first evaluate() */
+    values.insert(values.end(), key_values.end() - static_cast<std::ptrdiff_t>(key_count * components),
+                  key_values.end() - static_cast<std::ptrdiff_t>((key_count - 1) * components));
+    return static_cast<TrackId>(starts.size() - 1);
+}
+
+TrackId
+TrackGroup::addTween(const Timing &timing, std::span<const float> from, std::span<const float> to, Easing easing)
+{
+    static constexpr std::array<float, 2> TWEEN_TIMES{0.0f, 1.0f};
+    std::array<float, 8> tween_values{};
+    std::copy_n(from.begin(), std::min(from.size(), components), tween_values.begin());
+    std::copy_n(to.begin(), std::min(to.size(), components), tween_values.begin() + static_cast<std::ptrdiff_t>(components));
+    return add(timing, TWEEN_TIMES, std::span<const float>{tween_values.data(), components * 2}, easing);
+}
+
+void
+TrackGroup::restart(TrackId track, double start) noexcept
+{
+    starts[track] = static_cast<float>(start - epoch);
+    cursors[track] = 0;
+}
+
+void
+TrackGroup::clear(void) noexcept
+{
+    starts.clear();
+    inverse_durations.clear();
+    playbacks.clear();
+    easings.clear();
+    first_keys.clear();
+    key_counts.clear();
+    cursors.clear();
+    key_times.clear();
+    key_values.clear();
+    values.clear();
+}
+
+void
+TrackGroup::evaluate(double time) noexcept
+{
+    const auto local_time = static_cast<float>(time - epoch);
+    for (std::size_t begin = 0; begin < starts.size(); begin += BATCH_SIZE) {
+        const std::size_t count = std::min(BATCH_SIZE, starts.size() - begin);
+        evaluatePhases(local_time, begin, count);
+        findSegments(begin, count);
+        applyEasing(begin, count);
+        blendKeys(begin, count);
+    }
+}
+
+TrackKind
+TrackGroup::getKind(void) const noexcept
+{
+    return kind;
+}
+
+std::size_t
+TrackGroup::getTrackCount(void) const noexcept
+{
+    return starts.size();
+}
+
+std::span<const float>
+TrackGroup::getValues(void) const noexcept
+{
+    return values;
+}
+
+const float *
+TrackGroup::getValue(TrackId track) const noexcept
+{
+    return values.data() + static_cast<std::size_t>(track) * components;
+}
+
+void
+TrackGroup::copyTo(float *destination, std::size_t stride) const noexcept
+{
+    if (stride == components) {
+        std::memcpy(destination, values.data(), values.size() * sizeof(float));
+        return;
+    }
+    for (std::size_t track = 0; track < starts.size(); ++track) {
+        std::memcpy(destination + track * stride, values.data() + track * components, components * sizeof(float));
+    }
+}
+
+void
+TrackGroup::upload(Resource::Buffer &buffer, GLenum target) const noexcept
+{
+    const auto bytes = static_cast<GLsizeiptr>(values.size() * sizeof(float));
+    glBindBuffer(target, buffer.get());
+    glBufferData(target, bytes, nullptr, GL_STREAM_DRAW);
+    glBufferSubData(target, 0, bytes, values.data());
+    buffer.setSize(static_cast<std::size_t>(bytes));
+}
+
+#ifdef ANIMATION_USE_SSE
+/* SSE2 has no rounding instruction, truncate and step down where that rounded up */
+static inline __m128
+floorSse(__m128 value) noexcept
+{
+    const __m128 truncated = _mm_cvtepi32_ps(_mm_cvttps_epi32(value));
+    return _mm_sub_ps(truncated, _mm_and_ps(_mm_cmpgt_ps(truncated, value), _mm_set1_ps(1.0f)));
+}
+
+static inline __m128
+select(__m128 mask, __m128 if_true, __m128 if_false) noexcept
+{
+    return _mm_or_ps(_mm_and_ps(mask, if_true), _mm_andnot_ps(mask, if_false));
+}
+
+static inline __m128
+matches(const std::uint32_t *modes, std::uint32_t mode) noexcept
+{
+    const __m128i loaded = _mm_loadu_si128(reinterpret_cast<const __m128i *>(modes));
+    return _mm_castsi128_ps(_mm_cmpeq_epi32(loaded, _mm_set1_epi32(static_cast<int>(mode))));
+}
+#endif
+
+/* Position of every track between its first and last key, every playback mode is computed and the right one kept */
+void
+TrackGroup::evaluatePhases(float time, std::size_t begin, std::size_t count) noexcept
+{
+    std::size_t i = 0;
+#ifdef ANIMATION_USE_SSE
+    const __m128 now = _mm_set1_ps(time);
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 one = _mm_set1_ps(1.0f);
+    const __m128 two = _mm_set1_ps(2.0f);
+    const __m128 half = _mm_set1_ps(0.5f);
+    const __m128 sign_mask = _mm_set1_ps(-0.0f);
+    for (; i + 4 <= count; i += 4) {
+        const std::size_t track = begin + i;
+        const __m128 elapsed = _mm_mul_ps(_mm_sub_ps(now, _mm_loadu_ps(&starts[track])), _mm_loadu_ps(&inverse_durations[track]));
+        const __m128 once = _mm_min_ps(_mm_max_ps(elapsed, zero), one);
+        const __m128 loop = _mm_sub_ps(elapsed, floorSse(elapsed));
+        const __m128 cycle = _mm_mul_ps(elapsed, half);
+        const __m128 ping_pong = _mm_sub_ps(one, _mm_andnot_ps(sign_mask, _mm_sub_ps(_mm_mul_ps(_mm_sub_ps(cycle, floorSse(cycle)), two), one)));
+        __m128 phase = select(matches(&playbacks[track], static_cast<std::uint32_t>(Playback::LOOP)), loop, once);
+        phase = select(matches(&playbacks[track], static_cast<std::uint32_t>(Playback::PING_PONG)), ping_pong, phase);
+        _mm_store_ps(&phases[i], phase);
+    }
+#endif
+    for (; i < count; ++i) {
+        const std::size_t track = begin + i;
+        phases[i] = getPhase(time, starts[track], inverse_durations[track], playbacks[track]);
+    }
+}
+
+/* Keys are few and phases mostly move forwards, so the search is linear from the previous segment */
+void
+TrackGroup::findSegments(std::size_t begin, std::size_t count) noexcept
+{
+    for (std::size_t i = 0; i < count; ++i) {
+        const std::size_t track = begin + i;
+        const std::uint32_t key_count = key_counts[track];
+        if (1 == key_count) {
+            weights[i] = 0.0f;
+            continue;
+        }
+        const float *times = &key_times[first_keys[track]];
+        const float phase = phases[i];
+        std::uint32_t segment = std::min(cursors[track], key_count - 2);
+        if (phase < times[segment]) {
+            segment = 0;
+        }
+        while (segment + 2 < key_count && phase > times[segment + 1]) {
+            ++segment;
+        }
+        cursors[track] = segment;
+        const float length = times[segment + 1] - times[segment];
+        weights[i] = 0.0f < length ? std::clamp((phase - times[segment]) / length, 0.0f, 1.0f) : 1.0f;
+    }
+}
+
+void
+TrackGroup::applyEasing(std::size_t begin, std::size_t count) noexcept
+{
+    std::size_t i = 0;
+#ifdef ANIMATION_USE_SSE
+    const __m128 one = _mm_set1_ps(1.0f);
+    const __m128 two = _mm_set1_ps(2.0f);
+    const __m128 three = _mm_set1_ps(3.0f);
+    const __m128 four = _mm_set1_ps(4.0f);
+    const __m128 half = _mm_set1_ps(0.5f);
+    for (; i + 4 <= count; i += 4) {
+        const std::uint32_t *modes = &easings[begin + i];
+        const __m128 weight = _mm_load_ps(&weights[i]);
+        const __m128 inverse = _mm_sub_ps(one, weight);
+        const __m128 squared = _mm_mul_ps(weight, weight);
+        const __m128 cubed = _mm_mul_ps(squared, weight);
+        const __m128 inverse_cubed = _mm_mul_ps(_mm_mul_ps(inverse, inverse), inverse);
+        const __m128 smooth = _mm_mul_ps(squared, _mm_sub_ps(three, _mm_mul_ps(two, weight)));
+        const __m128 cubic_out = _mm_sub_ps(one, inverse_cubed);
+        const __m128 cubic_in_out = select(_mm_cmplt_ps(weight, half), _mm_mul_ps(four, cubed), _mm_sub_ps(one, _mm_mul_ps(four, inverse_cubed)));
+        const __m128 step = _mm_and_ps(_mm_cmpge_ps(weight, one), one);
+
+        __m128 eased = weight;
+        eased = select(matches(modes, static_cast<std::uint32_t>(Easing::SMOOTH_STEP)), smooth, eased);
+        eased = select(matches(modes, static_cast<std::uint32_t>(Easing::CUBIC_IN)), cubed, eased);
+        eased = select(matches(modes, static_cast<std::uint32_t>(Easing::CUBIC_OUT)), cubic_out, eased);
+        eased = select(matches(modes, static_cast<std::uint32_t>(Easing::CUBIC_IN_OUT)), cubic_in_out, eased);
+        eased = select(matches(modes, static_cast<std::uint32_t>(Easing::STEP)), step, eased);
+        _mm_store_ps(&weights[i], eased);
+    }
+#endif
+    for (; i < count; ++i) {
+        weights[i] = ease(weights[i], easings[begin + i]);
+    }
+}
+
+/* Linear blend of the two keys of the segment, rotations take the shortest arc and are renormalised */
+void
+TrackGroup::blendKeys(std::size_t begin, std::size_t count) noexcept
+{
+    for (std::size_t i = 0; i < count; ++i) {
+        const std::size_t track = begin + i;
+        const float *from = &key_values[(first_keys[track] + cursors[track]) * components];
+        const float *to = 1 == key_counts[track] ? from : from + components;
+        float *value = &values[track * components];
+        const float weight = weights[i];
+        if (TrackKind::ROTATION != kind) {
+            for (std::size_t component = 0; component < components; ++component) {
+                value[component] = from[component] + (to[component] - from[component]) * weight;
+            }
+            continue;
+        }
+        const float dot = from[0] * to[0] + from[1] * to[1] + from[2] * to[2] + from[3] * to[3];
+        const float sign = 0.0f > dot ? -1.0f : 1.0f;
+        float length_squared = 0.0f;
+        for (std::size_t component = 0; component < 4; ++component) {
+            value[component] = from[component] + (sign * to[component] - from[component]) * weight;
+            length_squared += value[component] * value[component];
+        }
+        const float inverse_length = 0.0f < length_squared ? 1.0f / std::sqrt(length_squared) : 0.0f;
+        for (std::size_t component = 0; component < 4; ++component) {
+            value[component] *= inverse_length;
+        }
+    }
+}
+
+static float
+getPhase(float time, float start, float inverse_duration, std::uint32_t playback) noexcept
+{
+    const float elapsed = (time - start) * inverse_duration;
+    switch (static_cast<Playback>(playback)) {
+    case Playback::LOOP:
+        return elapsed - std::floor(elapsed);
+    case Playback::PING_PONG: {
+        const float cycle = elapsed * 0.5f;
+        return 1.0f - std::fabs((cycle - std::floor(cycle)) * 2.0f - 1.0f);
+    }
+    case Playback::ONCE:
+    default:
+        return std::clamp(elapsed, 0.0f, 1.0f);
+    }
+}
+
+static float
+ease(float weight, std::uint32_t easing) noexcept
+{
+    const float inverse = 1.0f - weight;
+    switch (static_cast<Easing>(easing)) {
+    case Easing::SMOOTH_STEP:
+        return weight * weight * (3.0f - 2.0f * weight);
+    case Easing::CUBIC_IN:
+        return weight * weight * weight;
+    case Easing::CUBIC_OUT:
+        return 1.0f - inverse * inverse * inverse;
+    case Easing::CUBIC_IN_OUT:
+        return 0.5f > weight ? 4.0f * weight * weight * weight : 1.0f - 4.0f * inverse * inverse * inverse;
+    case Easing::STEP:
+        return 1.0f <= weight ? 1.0f : 0.0f;
+    case Easing::LINEAR:
+    default:
+        return weight;
+    }
+}
+
+}; // namespace Animation
@@ -0,0 +1,123 @@
+#ifndef ANIMATION_HPP
+#define ANIMATION_HPP
+
+#include <glad/glad.h>
+
+#include "Resource.hpp"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace Animation
+{
+
+using TrackId = std::uint32_t;
+
+enum class TrackKind
+{
+    SCALAR,
+    VEC3,
+    /* RGBA */
+    COLOUR,
+    /* Quaternion stored x, y, z, w, blended along the shortest arc and renormalised */
+    ROTATION
+};
+
+std::size_t getComponentCount(TrackKind kind) noexcept;
+
+/* Applied within every segment between two keys */
+enum class Easing : std::uint32_t
+{
+    LINEAR,
+    SMOOTH_STEP,
+    CUBIC_IN,
+    CUBIC_OUT,
+    CUBIC_IN_OUT,
+    /* Hold the value of a key until the next one */
+    STEP
+};
+
+enum class Playback : std::uint32_t
+{
+    /* Hold the last key once done */
+    ONCE,
+    LOOP,
+    /* Forwards then backwards, a cycle lasts twice the duration */
+    PING_PONG
+};
+
+struct Timing
+{
+    /* Seconds, on the clock given to evaluate() */
+    double start;
+    double duration;
+    Playback playback = Playback::ONCE;
+};
+
+/*
+ * Tracks of one kind stored as structure of arrays. evaluate() goes through them in batches: the phase of every
+ * track and its easing are computed four tracks at a time with SSE, the keys around the phase are then blended.
+ * Values are stored one track after the other so that they can be uploaded as they are to an instance buffer.
+ */
+class TrackGroup
+{
+  public:
+    explicit TrackGroup(TrackKind track_kind) noexcept;
+
+    /* Keys at times from 0 to 1 across the duration in ascending order, component count values per key */
+    TrackId add(const Timing &timing, std::span<const float> key_times, std::span<const float> key_values, Easing easing = Easing::LINEAR);
+    /* Two keys, from and to */
+    TrackId addTween(const Timing &timing, std::span<const float> from, std::span<const float> to, Easing easing = Easing::LINEAR);
+    void restart(TrackId track, double start) noexcept;
+    void clear(void) noexcept;
+
+    /* Sample every track at time, in seconds */
+    void evaluate(double time) noexcept;
+
+    TrackKind getKind(void) const noexcept;
+    std::size_t getTrackCount(void) const noexcept;
+    /* Values of the last evaluate(), getComponentCount() floats per track */
+    std::span<const float> getValues(void) const noexcept;
+    const float *getValue(TrackId track) const noexcept;
+
+    /* Copy the values of every track to destination, one track every stride floats */
+    void copyTo(float *destination, std::size_t stride) const noexcept;
+    /* Replace the contents of buffer with the values, orphaning its previous storage */
+    void upload(Resource::Buffer &buffer, GLenum target = GL_ARRAY_BUFFER) const noexcept;
+
+  private:
+    /* Tracks per batch, the scratch arrays of a batch stay in the L1 cache */
+    static constexpr std::size_t BATCH_SIZE{256};
+
+    void evaluatePhases(float time, std::size_t begin, std::size_t count) noexcept;
+    void findSegments(std::size_t begin, std::size_t count) noexcept;
+    void applyEasing(std::size_t begin, std::size_t count) noexcept;
+    void blendKeys(std::size_t begin, std::size_t count) noexcept;
+
+    TrackKind kind;
+    std::size_t components;
+
+    /* Time origin of the starts, so that they fit in a float with enough precision */
+    double epoch = 0.0;
+    std::vector<float> starts{};
+    std::vector<float> inverse_durations{};
+    std::vector<std::uint32_t> playbacks{};
+    std::vector<std::uint32_t> easings{};
+    std::vector<std::uint32_t> first_keys{};
+    std::vector<std::uint32_t> key_counts{};
+    /* Segment found during the last evaluate(), the search starts from it */
+    std::vector<std::uint32_t> cursors{};
+
+    std::vector<float> key_times{};
+    std::vector<float> key_values{};
+    std::vector<float> values{};
+
+    /* Scratch of the batch being evaluated */
+    alignas(16) std::array<float, BATCH_SIZE> phases{}, weights{};
+};
+
+}; // namespace Animation
+#endif
@@ -3,41 +3,268 @@
 
 #include <glad/glad.h>
 
+#include "Capture.hpp"
+#include "GlTrace.hpp"
+#include "HotReload.hpp"
+#include "Input.hpp"
+#include "JobSystem.hpp"
+#include "Loader.hpp"
+#include "NullGl.hpp"
+#include "Pacing.hpp"
+#include "Resource.hpp"
+#include "Scaling.hpp"
+#include "Telemetry.hpp"
+#include "Utils.hpp"
+
 #include <GLFW/glfw3.h>
 #include <fmt/core.h>
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <ctime>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <optional>
+#include <vector>
+
 class BaseApplication
 {
   public:
+    /*
+     * Launch options:
+     *   --headless               keep the window hidden
+     *   --frames=N               close after N frames
+     *   --capture=PATH           capture every frame, PATH is a directory for PNG or a file for Y4M
+     *   --capture-format=FORMAT  png (default) or y4m
+     *   --capture-drop           drop frames instead of waiting when the capture encoder falls behind
+     *   --gpu-budget-mb=N        evict least recently used evictable textures above N MiB
+     *   --resource-report        print the GPU memory used per resource category before exiting
+     *   --record=PATH            write the input events and time of every frame to PATH
+     *   --replay=PATH            render the frames recorded in PATH headless and as fast as possible
+     *   --frame-times=PATH       write the CPU time of every frame in milliseconds to PATH
+     *   --sync-loading           run background loading jobs on the main thread as soon as they are submitted
+     *   --pacing=MODE            throughput (2 frames in flight) or latency (1 frame in flight, late input sampling)
+     *   --frames-in-flight=N     override the frames in flight of the pacing mode
+     *   --no-late-sampling       sample input right away in latency pacing
+     *   --refresh-rate=HZ        refresh rate used by late sampling, the primary monitor's by default
+     *   --gl-trace[=PATH]        count the GL calls of every frame, print a summary and write the timeline to PATH (CSV or .json)
+     *   --workers=N              threads of the shared job system including the main one, one per hardware thread by default
+     *   --pin-workers            bind every job system worker to its own core
+     *   --continuous             render every iteration instead of waiting for input or animations when nothing changed
+     *   --dynamic-resolution[=MS] render offscreen at a scale keeping the frame under MS milliseconds, a refresh interval by default
+     *   --min-scale=F            lowest render scale of the dynamic resolution, 0.25 by default
+     *   --gl-backend=BACKEND     null or record, run without a GL driver to measure the CPU cost of every frame
+     *   --gl-log=PATH            write the calls recorded by the record backend to PATH (text when it ends in .txt)
+     *   --hot-reload             recompile shaders on the loader thread when their files change and swap them in once linked
+     *   --telemetry[=NAME]       publish every frame to the shared memory ring NAME for TelemetryMonitor
+     */
     int
-    run(void)
+    run(int argc = 0, char **argv = nullptr)
     {
+        options = Utils::CommandLine{argc, argv};
+        Utils::JobSystem::configure({options.getNumber<std::size_t>("workers", 0), options.hasFlag("pin-workers")});
         if (0 > init()) {
             cleanup();
             return -1;
         }
 
+        Resource::ResourceTracker &resources = Resource::ResourceTracker::getInstance();
+        GlTrace::Tracer &tracer = GlTrace::Tracer::getInstance();
+        NullGl::Backend &null_gl = NullGl::Backend::getInstance();
+        HotReload::Reloader &reloader = HotReload::Reloader::getInstance();
+        static constexpr std::size_t MEBIBYTE{1024 * 1024};
+        resources.setBudget(options.getNumber<std::size_t>("gpu-budget-mb", 0) * MEBIBYTE);
+
+        /* Replays have to load in lockstep with the recorded frames, and there is no context to share without a driver */
+        loader = std::make_unique<Loader::BackgroundLoader>(window, options.hasFlag("sync-loading") || replay || gl_backend);
+        if (options.hasFlag("hot-reload")) {
+            reloader.enable(*loader);
+        }
+        startDynamicResolution();
         setup();
-        while (!glfwWindowShouldClose(window)) {
-            processInputs();
-            render();
-            glfwPollEvents();
+        startCapture();
+        startPacing();
+        startTelemetry();
+        /* Captures, replays, paced runs and runs without a driver expect a frame on every iteration */
+        const bool idle_rendering = !options.hasFlag("continuous") && !replay && !capture && !pacer && !gl_backend;
+        renderLoop(idle_rendering);
+        if (idle_rendering) {
+            printIdleStats(loop_seconds, loop_cpu_seconds);
+        }
+        recorder.reset();
+        telemetry.reset();
+        if (pacer) {
+            pacer->finish(input);
+            pacer.reset();
+            printLatency();
+        }
+        if (replay || gl_backend) {
+            printFrameTimes(replay ? "Replay" : "Null GL backend");
+        }
+        if (const auto frame_times_path = options.getValue("frame-times")) {
+            writeFrameTimes(std::filesystem::path{*frame_times_path});
+        }
+        if (capture) {
+            capture->finish();
+            capture.reset();
+        }
+        if (dynamic_resolution) {
+            dynamic_resolution->printTrajectory();
+        }
+        if (options.hasFlag("resource-report")) {
+            resources.printReport();
+        }
+        if (tracer.isInstalled()) {
+            if (const auto trace_path = options.getValue("gl-trace")) {
+                tracer.writeTimeline(std::filesystem::path{*trace_path});
+            }
+            tracer.printSummary();
+        }
+        if (null_gl.isInstalled()) {
+            if (const auto log_path = options.getValue("gl-log")) {
+                null_gl.writeLog(std::filesystem::path{*log_path});
+            }
+            null_gl.printSummary();
         }
         teardown();
+        dynamic_resolution.reset();
+        reloader.disable();
+        loader.reset();
 
         cleanup();
         return 0;
     }
 
+    /*
+     * Running several scenes in one process: the host opens every window on the main thread, where GLFW wants it, then
+     * calls runHosted() on one thread per scene. The windows keep their size and the launch options that act on the
+     * whole process (tracing, null backend, hot reload, capture, pacing, record, replay and telemetry) are ignored. Textures load
+     * synchronously on the scene thread, which already has nothing else to do.
+     */
+    int
+    openHostedWindow(const Utils::CommandLine &host_options)
+    {
+        options = host_options;
+        is_hosted = true;
+        if (0 > createWindow()) {
+            return -1;
+        }
+        /* Callbacks run on the host thread and feed the single producer, single consumer event ring */
+        input.attach(window);
+        return 0;
+    }
+
+    /* The context is released on return, it has to be made current again before destroying the scene */
+    void
+    runHosted(void)
+    {
+        glfwMakeContextCurrent(window);
+        /* Scenes render back to back, like replays */
+        glfwSwapInterval(0);
+        glViewport(0, 0, hosted_framebuffer_width, hosted_framebuffer_height);
+        loader = std::make_unique<Loader::BackgroundLoader>(window, true);
+        startDynamicResolution();
+        setup();
+        renderLoop(false);
+        teardown();
+        dynamic_resolution.reset();
+        loader.reset();
+        glfwMakeContextCurrent(nullptr);
+    }
+
+    /* From any thread, the loop stops after the frame in progress */
+    void
+    requestClose(void) noexcept
+    {
+        close_requested.store(true, std::memory_order_relaxed);
+    }
+
+    std::uint64_t
+    getFrameCount(void) const noexcept
+    {
+        return frame_count;
+    }
+
+    GLFWwindow *
+    getWindow(void) const noexcept
+    {
+        return window;
+    }
+
+    /* Wall clock time spent in the render loop */
+    double
+    getLoopSeconds(void) const noexcept
+    {
+        return loop_seconds;
+    }
+
+    virtual ~BaseApplication() = default;
+
   private:
     int
     init(void)
     {
+        if (const auto backend_name = options.getValue("gl-backend")) {
+            gl_backend = NullGl::parseMode(*backend_name);
+            if (!gl_backend) {
+                fmt::print(stderr, "init: {}\n", "Unknown GL backend, expected null or record.");
+                return -1;
+            }
+#ifdef GLFW_PLATFORM_NULL
+            /* Without a display either */
+            glfwInitHint(GLFW_PLATFORM, GLFW_PLATFORM_NULL);
+#endif
+        }
         if (GLFW_FALSE == glfwInit()) {
             fmt::print(stderr, "init: {}\n", "Failed to initialise GLFW.");
             return -1;
         }
 
+        if (const auto replay_path = options.getValue("replay")) {
+            replay = std::make_unique<Input::InputReplay>(std::filesystem::path{*replay_path});
+            if (!replay->isOpen()) {
+                return -1;
+            }
+        }
+        if (const auto record_path = options.getValue("record"); record_path && !replay) {
+            recorder = std::make_unique<Input::InputRecorder>(std::filesystem::path{*record_path});
+        }
+
+        if (0 > createWindow()) {
+            return -1;
+        }
+        if (gl_backend) {
+            NullGl::Backend::getInstance().install(*gl_backend);
+        } else {
+            glfwMakeContextCurrent(window);
+            if (!gladLoadGLLoader(reinterpret_cast<GLADloadproc>(glfwGetProcAddress))) {
+                fmt::print(stderr, "init: {}\n", "Failed to initialise GLAD.");
+                return -1;
+            }
+        }
+        if (options.hasFlag("gl-trace") || options.getValue("gl-trace")) {
+            GlTrace::Tracer::getInstance().install();
+        }
+
+        glViewport(0, 0, WINDOW_WIDTH, WINDOW_HEIGHT);
+        glfwSetFramebufferSizeCallback(window, framebufferSizeCallback);
+        /* A replay only sees the recorded events and does not wait for the vertical blank */
+        if (!replay) {
+            input.attach(window);
+        } else if (!gl_backend) {
+            glfwSwapInterval(0);
+        }
+
+        return 0;
+    }
+
+    /* On the main thread, the hints are all set again since several windows may be created one after the other */
+    int
+    createWindow(void)
+    {
         glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
         glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
         glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
@@ -46,25 +273,276 @@ class BaseApplication
         glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
 #endif
 
-        static constexpr int WIDTH{800};
-        static constexpr int HEIGHT{600};
+        const bool is_visible = !options.hasFlag("headless") && !replay && !gl_backend;
+        glfwWindowHint(GLFW_VISIBLE, is_visible ? GLFW_TRUE : GLFW_FALSE);
+        glfwWindowHint(GLFW_CLIENT_API, gl_backend ? GLFW_NO_API : GLFW_OPENGL_API);
+        glfwWindowHint(GLFW_RESIZABLE, is_hosted ? GLFW_FALSE : GLFW_TRUE);
+        /* The default, asked for explicitly since occlusion culling relies on it */
+        glfwWindowHint(GLFW_DEPTH_BITS, 24);
 
-        window = glfwCreateWindow(WIDTH, HEIGHT, "Baguet's GL playground", nullptr, nullptr);
+        window = glfwCreateWindow(WINDOW_WIDTH, WINDOW_HEIGHT, "Baguet's GL playground", nullptr, nullptr);
         if (nullptr == window) {
-            fmt::print(stderr, "init: {}\n", "Failed to create GLFW window.");
+            fmt::print(stderr, "createWindow: {}\n", "Failed to create GLFW window.");
             return -1;
         }
-        glfwMakeContextCurrent(window);
+        /* Monitors and window sizes can only be queried from the main thread */
+        const GLFWvidmode *video_mode = glfwGetVideoMode(glfwGetPrimaryMonitor());
+        monitor_refresh_rate = nullptr == video_mode ? 60.0 : static_cast<double>(video_mode->refreshRate);
+        glfwGetFramebufferSize(window, &hosted_framebuffer_width, &hosted_framebuffer_height);
+        return 0;
+    }
 
-        if (!gladLoadGLLoader(reinterpret_cast<GLADloadproc>(glfwGetProcAddress))) {
-            fmt::print(stderr, "init: {}\n", "Failed to initialise GLAD.");
-            return -1;
+    /* Events are polled by the host thread when hosted, the scene thread only consumes them */
+    void
+    renderLoop(bool idle_rendering)
+    {
+        Resource::ResourceTracker &resources = Resource::ResourceTracker::getInstance();
+        GlTrace::Tracer &tracer = GlTrace::Tracer::getInstance();
+        NullGl::Backend &null_gl = NullGl::Backend::getInstance();
+        HotReload::Reloader &reloader = HotReload::Reloader::getInstance();
+        const auto max_frames = options.getNumber<std::uint64_t>("frames", 0);
+        const double loop_start = glfwGetTime();
+        const std::clock_t loop_cpu_start = std::clock();
+        while (!glfwWindowShouldClose(window) && !close_requested.load(std::memory_order_relaxed)) {
+            if (pacer) {
+                pacer->waitForFrameStart(input);
+            }
+            /* Events are sampled as late as possible, right before they are consumed */
+            if (idle_rendering) {
+                waitForDamage();
+            } else if (!is_hosted) {
+                glfwPollEvents();
+            }
+            const auto frame_start = std::chrono::steady_clock::now();
+            const std::clock_t frame_cpu_start = std::clock();
+            if (!replay) {
+                frame_time = glfwGetTime();
+            } else if (!replay->nextFrame(input, frame_time)) {
+                break;
+            }
+            input.update();
+            const bool shaders_changed = reloader.poll();
+            /* Held actions are applied every frame, not only when their key repeats */
+            if (!input.getFrameEvents().empty() || input.isAnyDown() || hasFramebufferResized() || shaders_changed || reloader.isReloading()) {
+                damage.markDirty();
+            }
+            processInputs();
+            const auto input_end = std::chrono::steady_clock::now();
+            if (idle_rendering && !damage.needsRedraw(glfwGetTime())) {
+                damage.frameSkipped();
+                continue;
+            }
+            resources.beginFrame();
+            if (recorder) {
+                recorder->recordFrame(frame_time, input.getFrameEvents());
+            }
+            if (dynamic_resolution) {
+                int width, height;
+                getFramebufferSize(width, height);
+                dynamic_resolution->beginFrame(width, height);
+            }
+            const auto render_start = std::chrono::steady_clock::now();
+            render();
+            const auto render_end = std::chrono::steady_clock::now();
+            if (dynamic_resolution) {
+                dynamic_resolution->endFrame(std::chrono::duration<double, std::milli>(render_end - render_start).count());
+            }
+            if (capture) {
+                int width, height;
+                getFramebufferSize(width, height);
+                capture->capture(width, height);
+            }
+            if (pacer) {
+                const double cost = glfwGetTime() - pacer->getFrameStart();
+                swapBuffers();
+                pacer->endFrame(replay ? std::nullopt : input.getOldestEventTime(), cost);
+            } else {
+                swapBuffers();
+                input.notifyPresented(glfwGetTime());
+            }
+            tracer.endFrame();
+            null_gl.endFrame();
+            damage.frameRendered(glfwGetTime());
+            frame_cpu_seconds += static_cast<double>(std::clock() - frame_cpu_start) / CLOCKS_PER_SEC;
+            const auto frame_end = std::chrono::steady_clock::now();
+            frame_durations.push_back(std::chrono::duration<double, std::milli>(frame_end - frame_start).count());
+            if (telemetry) {
+                auto milliseconds = [](auto start, auto end) { return std::chrono::duration<float, std::milli>(end - start).count(); };
+                const GlTrace::FrameStats traced = tracer.isInstalled() ? tracer.getFrames().back() : GlTrace::FrameStats{};
+                telemetry->publish({frame_count, frame_time, milliseconds(frame_start, frame_end), milliseconds(frame_start, input_end),
+                                    milliseconds(render_start, render_end), milliseconds(render_end, frame_end), static_cast<std::uint32_t>(traced.draws),
+                                    static_cast<std::uint32_t>(traced.calls), resources.getReport().total_bytes});
+            }
+            if (++frame_count == max_frames) {
+                glfwSetWindowShouldClose(window, GLFW_TRUE);
+            }
         }
+        loop_seconds = glfwGetTime() - loop_start;
+        loop_cpu_seconds = static_cast<double>(std::clock() - loop_cpu_start) / CLOCKS_PER_SEC;
+    }
 
-        glViewport(0, 0, WIDTH, HEIGHT);
-        glfwSetFramebufferSizeCallback(window, framebufferSizeCallback);
+    void
+    startCapture(void)
+    {
+        const auto capture_path = options.getValue("capture");
+        if (!capture_path) {
+            return;
+        }
+        const auto format = Capture::parseFormat(options.getValue("capture-format").value_or("png"));
+        if (!format) {
+            fmt::print(stderr, "startCapture: {}\n", "Unknown capture format, expected png or y4m.");
+            return;
+        }
+        capture = std::make_unique<Capture::FrameCapture>(std::filesystem::path{*capture_path}, *format, options.hasFlag("capture-drop"));
+    }
 
-        return 0;
+    void
+    startPacing(void)
+    {
+        const auto mode_name = options.getValue("pacing");
+        if (!mode_name) {
+            return;
+        }
+        const auto mode = Pacing::parseMode(*mode_name);
+        if (!mode) {
+            fmt::print(stderr, "startPacing: {}\n", "Unknown pacing mode, expected throughput or latency.");
+            return;
+        }
+
+        Pacing::Options pacing_options = Pacing::getDefaultOptions(*mode, getRefreshRate());
+        pacing_options.frames_in_flight = options.getNumber<std::size_t>("frames-in-flight", pacing_options.frames_in_flight);
+        pacing_options.late_sampling = pacing_options.late_sampling && !options.hasFlag("no-late-sampling") && !replay;
+        pacer = std::make_unique<Pacing::FramePacer>(pacing_options);
+    }
+
+    void
+    startTelemetry(void)
+    {
+        if (!options.hasFlag("telemetry") && !options.getValue("telemetry")) {
+            return;
+        }
+        telemetry = std::make_unique<Telemetry::Publisher>(options.getValue("telemetry").value_or(Telemetry::DEFAULT_NAME));
+        if (!telemetry->isOpen()) {
+            telemetry.reset();
+        }
+    }
+
+    void
+    startDynamicResolution(void)
+    {
+        if (!options.hasFlag("dynamic-resolution") && !options.getValue("dynamic-resolution")) {
+            return;
+        }
+        Scaling::GovernorOptions governor_options{options.getNumber<double>("dynamic-resolution", 1e3 / getRefreshRate())};
+        governor_options.min_scale = std::clamp(options.getNumber<float>("min-scale", governor_options.min_scale), governor_options.step,
+                                                governor_options.max_scale);
+        dynamic_resolution = std::make_unique<Scaling::DynamicResolution>(governor_options);
+    }
+
+    double
+    getRefreshRate(void) const
+    {
+        return options.getNumber<double>("refresh-rate", monitor_refresh_rate);
+    }
+
+    /* Block until an event arrives or the next animation is due, unless something already changed */
+    void
+    waitForDamage(void)
+    {
+        /* Shader files are not events, they are checked a few times per second while idle */
+        static constexpr double HOT_RELOAD_INTERVAL{0.25};
+        const double now = glfwGetTime();
+        const bool hot_reload = HotReload::Reloader::getInstance().isEnabled();
+        if (damage.needsRedraw(now) || input.isAnyDown()) {
+            glfwPollEvents();
+        } else if (const std::optional<double> timeout = damage.getWaitTimeout(now)) {
+            glfwWaitEventsTimeout(hot_reload ? std::min(*timeout, HOT_RELOAD_INTERVAL) : *timeout);
+        } else if (hot_reload) {
+            glfwWaitEventsTimeout(HOT_RELOAD_INTERVAL);
+        } else {
+            glfwWaitEvents();
+        }
+    }
+
+    /* Hosted windows never change size, and their size can only be queried from the main thread */
+    void
+    getFramebufferSize(int &width, int &height) const
+    {
+        if (is_hosted) {
+            width = hosted_framebuffer_width;
+            height = hosted_framebuffer_height;
+        } else {
+            glfwGetFramebufferSize(window, &width, &height);
+        }
+    }
+
+    bool
+    hasFramebufferResized(void)
+    {
+        int width, height;
+        getFramebufferSize(width, height);
+        const bool resized = width != framebuffer_width || height != framebuffer_height;
+        framebuffer_width = width;
+        framebuffer_height = height;
+        return resized;
+    }
+
+    /* Compared against rendering every refresh, at the CPU cost of the frames that were rendered */
+    void
+    printIdleStats(double wall_seconds, double cpu_seconds) const
+    {
+        const Pacing::DamageStats &stats = damage.getStats();
+        if (0 == stats.rendered_frames || 0.0 >= wall_seconds) {
+            return;
+        }
+        const double refreshes = std::max(wall_seconds * getRefreshRate(), static_cast<double>(stats.rendered_frames));
+        const double continuous_cpu_seconds = frame_cpu_seconds / static_cast<double>(stats.rendered_frames) * refreshes;
+        const double saved = 0.0 < continuous_cpu_seconds ? std::max(1.0 - cpu_seconds / continuous_cpu_seconds, 0.0) : 0.0;
+        fmt::print("Idle rendering: {} frames rendered over {:.0f} refreshes, {:.1f}% skipped, {} wake ups without changes, "
+                   "CPU {:.1f}% of a core, about {:.1f}% saved\n",
+                   stats.rendered_frames, refreshes, 100.0 * (1.0 - static_cast<double>(stats.rendered_frames) / refreshes), stats.skipped_frames,
+                   100.0 * cpu_seconds / wall_seconds, 100.0 * saved);
+    }
+
+    void
+    printLatency(void) const
+    {
+        const Input::LatencyStats &latency = input.getLatencyStats();
+        if (0 == latency.samples) {
+            return;
+        }
+        fmt::print("Input to present latency: average {:.2f} ms, max {:.2f} ms over {} frames with input\n", latency.average * 1e3, latency.max * 1e3,
+                   latency.samples);
+    }
+
+    void
+    printFrameTimes(const char *label)
+    {
+        if (frame_durations.empty()) {
+            return;
+        }
+        std::vector<double> sorted{frame_durations};
+        std::sort(sorted.begin(), sorted.end());
+        double total = 0.0;
+        for (double duration : sorted) {
+            total += duration;
+        }
+        auto percentile = [&sorted](double fraction) { return sorted[static_cast<std::size_t>(fraction * static_cast<double>(sorted.size() - 1))]; };
+        fmt::print("{}: {} frames in {:.1f} ms, average {:.3f} ms, median {:.3f} ms, 99th percentile {:.3f} ms, max {:.3f} ms\n", label, sorted.size(),
+                   total, total / static_cast<double>(sorted.size()), percentile(0.5), percentile(0.99), sorted.back());
+    }
+
+    void
+    writeFrameTimes(const std::filesystem::path &file_path)
+    {
+        std::ofstream stream{file_path, std::ios::out | std::ios::trunc};
+        if (!stream.is_open()) {
+            fmt::print(stderr, "writeFrameTimes: Failed to open file {}.\n", file_path.string());
+            return;
+        }
+        for (double duration : frame_durations) {
+            stream << fmt::format("{:.4f}\n", duration);
+        }
     }
 
     virtual void setup(void) = 0;
@@ -72,6 +550,15 @@ class BaseApplication
     virtual void render(void) = 0;
     virtual void teardown(void) = 0;
 
+    /* Nothing to present without a context */
+    void
+    swapBuffers(void)
+    {
+        if (!gl_backend) {
+            glfwSwapBuffers(window);
+        }
+    }
+
     void
     cleanup(void)
     {
@@ -85,11 +572,64 @@ class BaseApplication
         glViewport(0, 0, width, height);
     }
 
+    std::unique_ptr<Capture::FrameCapture> capture = nullptr;
+    std::unique_ptr<Input::InputRecorder> recorder = nullptr;
+    std::unique_ptr<Input::InputReplay> replay = nullptr;
+    std::unique_ptr<Pacing::FramePacer> pacer = nullptr;
+    std::unique_ptr<Scaling::DynamicResolution> dynamic_resolution = nullptr;
+    std::unique_ptr<Telemetry::Publisher> telemetry = nullptr;
+    /* Set when the GL calls go to the null backend instead of a driver */
+    std::optional<NullGl::Mode> gl_backend{};
+    std::vector<double> frame_durations{};
+    /* CPU time spent in the iterations that rendered a frame */
+    double frame_cpu_seconds = 0.0;
+    int framebuffer_width = 0;
+    int framebuffer_height = 0;
+
+    static constexpr int WINDOW_WIDTH{800};
+    static constexpr int WINDOW_HEIGHT{600};
+
+    bool is_hosted = false;
+    std::atomic<bool> close_requested{false};
+    int hosted_framebuffer_width = WINDOW_WIDTH;
+    int hosted_framebuffer_height = WINDOW_HEIGHT;
+    double monitor_refresh_rate = 60.0;
+    double loop_seconds = 0.0;
+    double loop_cpu_seconds = 0.0;
+
   protected:
     /* The window should be accessible to the derived classes */
     GLFWwindow *window = nullptr;
 
-    ~BaseApplication() = default;
+    /* Action states, refreshed from the window events before each processInputs() */
+    Input::InputSystem input{};
+
+    /* What changed since the last frame, iterations without damage block on events instead of rendering */
+    Pacing::DamageTracker damage{};
+
+    /* Uploads and compiles on a context shared with the window */
+    std::unique_ptr<Loader::BackgroundLoader> loader = nullptr;
+
+    /* Launch options, also available to the derived classes for their own knobs */
+    Utils::CommandLine options{};
+    std::uint64_t frame_count = 0;
+    /* Seconds since GLFW was initialised when the frame started, or the recorded value when replaying */
+    double frame_time = 0.0;
+
+    /* Framebuffer render() draws to and its size, offscreen and smaller than the window with dynamic resolution */
+    Scaling::RenderTarget
+    getRenderTarget(void) const
+    {
+        if (dynamic_resolution) {
+            const Scaling::RenderTarget target = dynamic_resolution->getRenderTarget();
+            if (0 != target.width) {
+                return target;
+            }
+        }
+        int width, height;
+        getFramebufferSize(width, height);
+        return {0, width, height};
+    }
 };
 
 #endif
@@ -0,0 +1,374 @@
+#include "Capture.hpp"
+
+#include <array>
+#include <cstring>
+#include <fmt/core.h>
+
+#ifdef CAPTURE_HAS_ZLIB
+#include <zlib.h>
+#endif
+
+namespace Capture
+{
+
+/* Frames waiting for the encoder beyond this stall the render loop, or are dropped when that is allowed */
+static constexpr std::size_t MAX_QUEUED_FRAMES{32};
+static constexpr std::size_t BYTES_PER_PIXEL{4};
+
+static std::uint32_t crc32Update(std::uint32_t crc, const std::uint8_t *data, std::size_t size) noexcept;
+static std::uint32_t adler32(const std::vector<std::uint8_t> &data) noexcept;
+static std::vector<std::uint8_t> deflate(const std::vector<std::uint8_t> &raw);
+static void writeChunk(std::ofstream &stream, const char (&type)[5], const std::vector<std::uint8_t> &data);
+static void appendBigEndian(std::vector<std::uint8_t> &bytes, std::uint32_t value);
+
+std::optional<Format>
+parseFormat(std::string_view name) noexcept
+{
+    if ("png" == name) {
+        return Format::PNG;
+    }
+    if ("y4m" == name) {
+        return Format::Y4M;
+    }
+    return std::nullopt;
+}
+
+FrameCapture::FrameCapture(std::filesystem::path output, Format capture_format, bool may_drop, std::size_t ring_size)
+    : output_path{std::move(output)}, format{capture_format}, may_drop_frames{may_drop}
+{
+    slots.resize(ring_size);
+    for (Slot &slot : slots) {
+        glGenBuffers(1, &slot.buffer);
+        slot.fence = nullptr;
+        slot.index = 0;
+        slot.width = slot.height = 0;
+        slot.capacity = 0;
+    }
+
+    std::error_code error{};
+    if (Format::PNG == format) {
+        std::filesystem::create_directories(output_path, error);
+    } else {
+        if (output_path.has_parent_path()) {
+            std::filesystem::create_directories(output_path.parent_path(), error);
+        }
+        video_stream.open(output_path, std::ios::out | std::ios::binary | std::ios::trunc);
+    }
+    if (error || (Format::Y4M == format && !video_stream.is_open())) {
+        fmt::print(stderr, "FrameCapture: Failed to prepare output '{}'.\n", output_path.string());
+    }
+
+    encoder = std::jthread{[this](std::stop_token stop_token) { encoderLoop(stop_token); }};
+}
+
+FrameCapture::~FrameCapture() noexcept
+{
+    encoder.request_stop();
+    frames_available.notify_all();
+    if (encoder.joinable()) {
+        encoder.join();
+    }
+    for (Slot &slot : slots) {
+        if (nullptr != slot.fence) {
+            glDeleteSync(slot.fence);
+        }
+        glDeleteBuffers(1, &slot.buffer);
+    }
+}
+
+void
+FrameCapture::capture(GLsizei width, GLsizei height)
+{
+    /* The slot about to be reused is the oldest one in flight, its copy has to be collected first */
+    if (pending.size() == slots.size()) {
+        retrieve(true);
+    }
+
+    Slot &slot = slots[next_slot];
+    const auto size = static_cast<GLsizeiptr>(width) * height * static_cast<GLsizeiptr>(BYTES_PER_PIXEL);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.buffer);
+    if (slot.capacity < size) {
+        glBufferData(GL_PIXEL_PACK_BUFFER, size, nullptr, GL_STREAM_READ);
+        slot.capacity = size;
+    }
+    /* With a pack buffer bound, this only queues the copy instead of waiting for the frame to finish */
+    glReadBuffer(GL_BACK);
+    glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    slot.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    slot.index = frame_index++;
+    slot.width = width;
+    slot.height = height;
+
+    pending.push_back(next_slot);
+    next_slot = (next_slot + 1) % slots.size();
+
+    /* Collect whatever earlier copies already landed, without waiting on the ones still running */
+    while (1 < pending.size()) {
+        const GLenum status = glClientWaitSync(slots[pending.front()].fence, 0, 0);
+        if (GL_ALREADY_SIGNALED != status && GL_CONDITION_SATISFIED != status) {
+            break;
+        }
+        retrieve(false);
+    }
+}
+
+void
+FrameCapture::retrieve(bool wait)
+{
+    Slot &slot = slots[pending.front()];
+    pending.pop_front();
+
+    if (wait) {
+        static constexpr GLuint64 ONE_SECOND{1000000000};
+        GLenum status = glClientWaitSync(slot.fence, GL_SYNC_FLUSH_COMMANDS_BIT, ONE_SECOND);
+        while (GL_TIMEOUT_EXPIRED == status) {
+            status = glClientWaitSync(slot.fence, GL_SYNC_FLUSH_COMMANDS_BIT, ONE_SECOND);
+        }
+    }
+    glDeleteSync(slot.fence);
+    slot.fence = nullptr;
+
+    Frame frame{slot.index, slot.width, slot.height, {}};
+    const auto size = static_cast<GLsizeiptr>(slot.width) * slot.height * static_cast<GLsizeiptr>(BYTES_PER_PIXEL);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.buffer);
+    const void *mapped = glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, size, GL_MAP_READ_BIT);
+    if (nullptr != mapped) {
+        frame.pixels.resize(static_cast<std::size_t>(size));
+        std::memcpy(frame.pixels.data(), mapped, frame.pixels.size());
+        glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+    }
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    if (frame.pixels.empty()) {
+        std::lock_guard lock{mutex};
+        ++dropped_frames;
+        return;
+    }
+
+    {
+        std::unique_lock lock{mutex};
+        if (may_drop_frames && encode_queue.size() >= MAX_QUEUED_FRAMES) {
+            ++dropped_frames;
+            return;
+        }
+        /* Golden images and recordings need every frame, a slow encoder slows the render loop down instead */
+        frames_consumed.wait(lock, [this] { return encode_queue.size() < MAX_QUEUED_FRAMES; });
+        encode_queue.push_back(std::move(frame));
+    }
+    frames_available.notify_one();
+}
+
+void
+FrameCapture::finish(void)
+{
+    while (!pending.empty()) {
+        retrieve(true);
+    }
+    std::unique_lock lock{mutex};
+    frames_consumed.wait(lock, [this] { return encode_queue.empty() && !is_encoding; });
+    if (0 != dropped_frames) {
+        fmt::print(stderr, "FrameCapture: {} frames were dropped, because the encoder fell behind or could not be read back.\n", dropped_frames);
+    }
+}
+
+std::uint64_t
+FrameCapture::getCapturedFrameCount(void) const noexcept
+{
+    return frame_index;
+}
+
+std::uint64_t
+FrameCapture::getDroppedFrameCount(void) const noexcept
+{
+    std::lock_guard lock{mutex};
+    return dropped_frames;
+}
+
+void
+FrameCapture::encoderLoop(std::stop_token stop_token)
+{
+    while (true) {
+        Frame frame;
+        {
+            std::unique_lock lock{mutex};
+            frames_available.wait(lock, stop_token, [this] { return !encode_queue.empty(); });
+            if (encode_queue.empty()) {
+                return;
+            }
+            frame = std::move(encode_queue.front());
+            encode_queue.pop_front();
+            is_encoding = true;
+        }
+
+        if (Format::PNG == format) {
+            writePng(output_path / fmt::format("frame_{:06}.png", frame.index), frame);
+        } else if (0 == stream_width) {
+            stream_width = frame.width;
+            stream_height = frame.height;
+            writeY4mHeader(video_stream, frame.width, frame.height);
+            writeY4mFrame(video_stream, frame);
+        } else if (frame.width == stream_width && frame.height == stream_height) {
+            writeY4mFrame(video_stream, frame);
+        } else {
+            fmt::print(stderr, "FrameCapture: Skipping frame {}, the video size cannot change.\n", frame.index);
+        }
+
+        {
+            std::lock_guard lock{mutex};
+            is_encoding = false;
+        }
+        frames_consumed.notify_all();
+    }
+}
+
+void
+writePng(const std::filesystem::path &file_path, const Frame &frame)
+{
+    const auto width = static_cast<std::size_t>(frame.width);
+    const auto height = static_cast<std::size_t>(frame.height);
+
+    /* Each scanline starts with its filter type (0, none) and drops the alpha channel */
+    std::vector<std::uint8_t> raw{};
+    raw.reserve(height * (1 + width * 3));
+    for (std::size_t row = height; row-- > 0;) {
+        raw.push_back(0);
+        const std::uint8_t *pixel = frame.pixels.data() + row * width * BYTES_PER_PIXEL;
+        for (std::size_t column = 0; column < width; ++column, pixel += BYTES_PER_PIXEL) {
+            raw.insert(raw.end(), pixel, pixel + 3);
+        }
+    }
+
+    std::ofstream stream{file_path, std::ios::out | std::ios::binary | std::ios::trunc};
+    if (!stream.is_open()) {
+        fmt::print(stderr, "writePng: Failed to open file {}.\n", file_path.string());
+        return;
+    }
+    static constexpr std::array<std::uint8_t, 8> SIGNATURE{0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'};
+    stream.write(reinterpret_cast<const char *>(SIGNATURE.data()), SIGNATURE.size());
+
+    std::vector<std::uint8_t> header{};
+    appendBigEndian(header, static_cast<std::uint32_t>(width));
+    appendBigEndian(header, static_cast<std::uint32_t>(height));
+    /* 8 bits per channel, truecolour, deflate, adaptive filtering, no interlace */
+    header.insert(header.end(), {8, 2, 0, 0, 0});
+    writeChunk(stream, "IHDR", header);
+    writeChunk(stream, "IDAT", deflate(raw));
+    writeChunk(stream, "IEND", {});
+}
+
+void
+writeY4mHeader(std::ofstream &stream, GLsizei width, GLsizei height)
+{
+    stream << fmt::format("YUV4MPEG2 W{} H{} F60:1 Ip A1:1 C444\n", width, height);
+}
+
+void
+writeY4mFrame(std::ofstream &stream, const Frame &frame)
+{
+    /* BT.601 studio range, planar 4:4:4 */
+    const auto pixel_count = static_cast<std::size_t>(frame.width) * static_cast<std::size_t>(frame.height);
+    const auto width = static_cast<std::size_t>(frame.width);
+    std::vector<std::uint8_t> planes(pixel_count * 3);
+    std::size_t output = 0;
+    for (std::size_t row = static_cast<std::size_t>(frame.height); row-- > 0;) {
+        const std::uint8_t *pixel = frame.pixels.data() + row * width * BYTES_PER_PIXEL;
+        for (std::size_t column = 0; column < width; ++column, pixel += BYTES_PER_PIXEL, ++output) {
+            const int red = pixel[0];
+            const int green = pixel[1];
+            const int blue = pixel[2];
+            planes[output] = static_cast<std::uint8_t>(16 + ((66 * red + 129 * green + 25 * blue + 128) >> 8));
+            planes[pixel_count + output] = static_cast<std::uint8_t>(128 + ((-38 * red - 74 * green + 112 * blue + 128) >> 8));
+            planes[2 * pixel_count + output] = static_cast<std::uint8_t>(128 + ((112 * red - 94 * green - 18 * blue + 128) >> 8));
+        }
+    }
+    stream << "FRAME\n";
+    stream.write(reinterpret_cast<const char *>(planes.data()), static_cast<std::streamsize>(planes.size()));
+}
+
+static std::uint32_t
+crc32Update(std::uint32_t crc, const std::uint8_t *data, std::size_t size) noexcept
+{
+    static const std::array<std::uint32_t, 256> table = [] {
+        std::array<std::uint32_t, 256> entries{};
+        for (std::uint32_t i = 0; i < entries.size(); ++i) {
+            std::uint32_t value = i;
+            for (int bit = 0; bit < 8; ++bit) {
+                value = (value & 1u) ? 0xEDB88320u ^ (value >> 1) : value >> 1;
+            }
+            entries[i] = value;
+        }
+        return entries;
+    }();
+    for (std::size_t i = 0; i < size; ++i) {
+        crc = table[(crc ^ data[i]) & 0xFFu] ^ (crc >> 8);
+    }
+    return crc;
+}
+
+static std::uint32_t
+adler32(const std::vector<std::uint8_t> &data) noexcept
+{
+    static constexpr std::uint32_t MODULO{65521};
+    std::uint32_t low = 1, high = 0;
+    for (std::uint8_t byte : data) {
+        low = (low + byte) % MODULO;
+        high = (high + low) % MODULO;
+    }
+    return (high << 16) | low;
+}
+
+static std::vector<std::uint8_t>
+deflate(const std::vector<std::uint8_t> &raw)
+{
+#ifdef CAPTURE_HAS_ZLIB
+    const uLong raw_size = raw.size();
+    uLongf compressed_size = compressBound(raw_size);
+    std::vector<std::uint8_t> compressed(compressed_size);
+    if (Z_OK == compress2(compressed.data(), &compressed_size, raw.data(), raw_size, Z_BEST_SPEED)) {
+        compressed.resize(compressed_size);
+        return compressed;
+    }
+#endif
+    /* Without zlib, emit a valid zlib stream made of stored (uncompressed) blocks */
+    static constexpr std::size_t MAX_BLOCK_SIZE{65535};
+    std::vector<std::uint8_t> stream{0x78, 0x01};
+    std::size_t offset = 0;
+    do {
+        const std::size_t block_size = std::min(MAX_BLOCK_SIZE, raw.size() - offset);
+        const bool is_last = offset + block_size == raw.size();
+        const auto length = static_cast<std::uint16_t>(block_size);
+        const auto complement = static_cast<std::uint16_t>(~length);
+        stream.insert(stream.end(), {static_cast<std::uint8_t>(is_last ? 1 : 0),
+                                     static_cast<std::uint8_t>(length & 0xFF), static_cast<std::uint8_t>(length >> 8),
+                                     static_cast<std::uint8_t>(complement & 0xFF), static_cast<std::uint8_t>(complement >> 8)});
+        stream.insert(stream.end(), raw.begin() + static_cast<std::ptrdiff_t>(offset), raw.begin() + static_cast<std::ptrdiff_t>(offset + block_size));
+        offset += block_size;
+    } while (offset < raw.size());
+    appendBigEndian(stream, adler32(raw));
+    return stream;
+}
+
+static void
+writeChunk(std::ofstream &stream, const char (&type)[5], const std::vector<std::uint8_t> &data)
+{
+    std::vector<std::uint8_t> length{};
+    appendBigEndian(length, static_cast<std::uint32_t>(data.size()));
+    stream.write(reinterpret_cast<const char *>(length.data()), static_cast<std::streamsize>(length.size()));
+    stream.write(type, 4);
+    stream.write(reinterpret_cast<const char *>(data.data()), static_cast<std::streamsize>(data.size()));
+
+    std::uint32_t crc = crc32Update(0xFFFFFFFFu, reinterpret_cast<const std::uint8_t *>(type), 4);
+    crc = crc32Update(crc, data.data(), data.size()) ^ 0xFFFFFFFFu;
+    std::vector<std::uint8_t> checksum{};
+    appendBigEndian(checksum, crc);
+    stream.write(reinterpret_cast<const char *>(checksum.data()), static_cast<std::streamsize>(checksum.size()));
+}
+
+static void
+appendBigEndian(std::vector<std::uint8_t> &bytes, std::uint32_t value)
+{
+    bytes.insert(bytes.end(), {static_cast<std::uint8_t>(value >> 24), static_cast<std::uint8_t>(value >> 16),
+                               static_cast<std::uint8_t>(value >> 8), static_cast<std::uint8_t>(value)});
+}
+
+}; // namespace Capture
@@ -0,0 +1,105 @@
+#ifndef CAPTURE_HPP
+#define CAPTURE_HPP
+
+#include <glad/glad.h>
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+#include <optional>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+namespace Capture
+{
+
+enum class Format
+{
+    /* One PNG file per frame, for golden image comparisons */
+    PNG,
+    /* A single raw YUV4MPEG2 stream, for recordings */
+    Y4M
+};
+
+std::optional<Format> parseFormat(std::string_view name) noexcept;
+
+struct Frame
+{
+    std::uint64_t index;
+    GLsizei width, height;
+    /* RGBA rows, bottom row first as returned by glReadPixels */
+    std::vector<std::uint8_t> pixels;
+};
+
+/* Encode one frame, rows are flipped so the output is top row first */
+void writePng(const std::filesystem::path &file_path, const Frame &frame);
+void writeY4mHeader(std::ofstream &stream, GLsizei width, GLsizei height);
+void writeY4mFrame(std::ofstream &stream, const Frame &frame);
+
+/*
+ * Asynchronous back buffer capture.
+ * Each frame is read into one of a ring of pixel pack buffers, the copy is only mapped once its fence
+ * has signalled (usually one or two frames later), and the encoding happens on a worker thread.
+ * When the encoder falls behind, the render loop waits for it so that every frame is written, unless dropping
+ * frames was allowed.
+ */
+class FrameCapture
+{
+  public:
+    FrameCapture(std::filesystem::path output_path, Format format, bool may_drop_frames = false, std::size_t ring_size = 3);
+    ~FrameCapture() noexcept;
+
+    FrameCapture(const FrameCapture &) = delete;
+    FrameCapture(FrameCapture &&) = delete;
+    FrameCapture &operator=(const FrameCapture &) = delete;
+    FrameCapture &operator=(FrameCapture &&) = delete;
+
+    /* Queue a read of the back buffer, call after rendering and before swapping */
+    void capture(GLsizei width, GLsizei height);
+
+    /* Retrieve the frames still in flight and wait for the encoder, the GL context must still be current */
+    void finish(void);
+
+    std::uint64_t getCapturedFrameCount(void) const noexcept;
+    std::uint64_t getDroppedFrameCount(void) const noexcept;
+
+  private:
+    struct Slot
+    {
+        GLuint buffer;
+        GLsync fence;
+        std::uint64_t index;
+        GLsizei width, height;
+        GLsizeiptr capacity;
+    };
+
+    void retrieve(bool wait);
+    void encoderLoop(std::stop_token stop_token);
+
+    std::filesystem::path output_path;
+    Format format;
+    bool may_drop_frames;
+    std::vector<Slot> slots{};
+    /* Slots in flight, oldest first */
+    std::deque<std::size_t> pending{};
+    std::size_t next_slot = 0;
+    std::uint64_t frame_index = 0;
+
+    mutable std::mutex mutex{};
+    std::condition_variable_any frames_available{};
+    std::condition_variable_any frames_consumed{};
+    std::deque<Frame> encode_queue{};
+    bool is_encoding = false;
+    std::uint64_t dropped_frames = 0;
+    std::ofstream video_stream{};
+    /* A Y4M stream has a single size, set by its first frame */
+    GLsizei stream_width = 0, stream_height = 0;
+    std::jthread encoder{};
+};
+
+}; // namespace Capture
+#endif
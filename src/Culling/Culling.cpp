@@ -0,0 +1,505 @@
+#include "Culling.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <limits>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define CULLING_USE_SSE
+#endif
+
+namespace Culling
+{
+
+BoundingBox
+BoundingBox::merge(const BoundingBox &lhs, const BoundingBox &rhs) noexcept
+{
+    return {glm::min(lhs.min, rhs.min), glm::max(lhs.max, rhs.max)};
+}
+
+BoundingBox
+BoundingBox::transformed(const glm::mat4 &transformation) const noexcept
+{
+    /* Arvo's method: transform the centre, and project the extents on the absolute value of the matrix */
+    const glm::vec3 centre = getCentre();
+    const glm::vec3 extents = getExtents();
+    const glm::vec4 new_centre = transformation * glm::vec4(centre, 1.0f);
+    glm::vec3 new_extents{0.0f};
+    for (int row = 0; row < 3; ++row) {
+        for (int column = 0; column < 3; ++column) {
+            new_extents[row] += std::fabs(transformation[column][row]) * extents[column];
+        }
+    }
+    const glm::vec3 projected_centre{new_centre.x, new_centre.y, new_centre.z};
+    return {projected_centre - new_extents, projected_centre + new_extents};
+}
+
+glm::vec3
+BoundingBox::getCentre(void) const noexcept
+{
+    return (min + max) * 0.5f;
+}
+
+glm::vec3
+BoundingBox::getExtents(void) const noexcept
+{
+    return (max - min) * 0.5f;
+}
+
+float
+BoundingBox::getSurfaceArea(void) const noexcept
+{
+    const glm::vec3 size = max - min;
+    return 2.0f * (size.x * size.y + size.y * size.z + size.z * size.x);
+}
+
+bool
+operator==(const BoundingBox &lhs, const BoundingBox &rhs) noexcept
+{
+    return lhs.min == rhs.min && lhs.max == rhs.max;
+}
+
+Frustum::Frustum(const glm::mat4 &view_projection) noexcept
+{
+    /* Gribb-Hartmann extraction, GLM matrices are column major so a row is m[0][i], m[1][i], ... */
+    auto row = [&view_projection](int i) {
+        return glm::vec4(view_projection[0][i], view_projection[1][i], view_projection[2][i], view_projection[3][i]);
+    };
+    const std::array<glm::vec4, 6> planes{
+        row(3) + row(0), /* Left */
+        row(3) - row(0), /* Right */
+        row(3) + row(1), /* Bottom */
+        row(3) - row(1), /* Top */
+        row(3) + row(2), /* Near */
+        row(3) - row(2), /* Far */
+    };
+
+    for (std::size_t i = 0; i < LANES; ++i) {
+        glm::vec4 plane{0.0f, 0.0f, 0.0f, 1.0f};
+        if (i < planes.size()) {
+            plane = planes[i];
+            const float length = std::sqrt(plane.x * plane.x + plane.y * plane.y + plane.z * plane.z);
+            if (length > 0.0f) {
+                plane = plane / length;
+            }
+        }
+        normals_x[i] = plane.x;
+        normals_y[i] = plane.y;
+        normals_z[i] = plane.z;
+        distances[i] = plane.w;
+    }
+}
+
+Containment
+Frustum::test(const BoundingBox &box, std::uint32_t &plane_mask) const noexcept
+{
+    const glm::vec3 centre = box.getCentre();
+    const glm::vec3 extents = box.getExtents();
+    std::uint32_t outside_bits = 0;
+    std::uint32_t straddle_bits = 0;
+
+#ifdef CULLING_USE_SSE
+    const __m128 sign_mask = _mm_set1_ps(-0.0f);
+    const __m128 centre_x = _mm_set1_ps(centre.x);
+    const __m128 centre_y = _mm_set1_ps(centre.y);
+    const __m128 centre_z = _mm_set1_ps(centre.z);
+    const __m128 extents_x = _mm_set1_ps(extents.x);
+    const __m128 extents_y = _mm_set1_ps(extents.y);
+    const __m128 extents_z = _mm_set1_ps(extents.z);
+    const __m128 zero = _mm_setzero_ps();
+
+    for (std::size_t lane = 0; lane < LANES; lane += 4) {
+        const __m128 normal_x = _mm_load_ps(&normals_x[lane]);
+        const __m128 normal_y = _mm_load_ps(&normals_y[lane]);
+        const __m128 normal_z = _mm_load_ps(&normals_z[lane]);
+
+        /* Signed distance of the centre and projected radius of the box on each plane normal */
+        __m128 distance = _mm_load_ps(&distances[lane]);
+        distance = _mm_add_ps(distance, _mm_mul_ps(normal_x, centre_x));
+        distance = _mm_add_ps(distance, _mm_mul_ps(normal_y, centre_y));
+        distance = _mm_add_ps(distance, _mm_mul_ps(normal_z, centre_z));
+        __m128 radius = _mm_mul_ps(_mm_andnot_ps(sign_mask, normal_x), extents_x);
+        radius = _mm_add_ps(radius, _mm_mul_ps(_mm_andnot_ps(sign_mask, normal_y), extents_y));
+        radius = _mm_add_ps(radius, _mm_mul_ps(_mm_andnot_ps(sign_mask, normal_z), extents_z));
+
+        const int outside = _mm_movemask_ps(_mm_cmplt_ps(_mm_add_ps(distance, radius), zero));
+        const int straddle = _mm_movemask_ps(_mm_cmplt_ps(_mm_sub_ps(distance, radius), zero));
+        outside_bits |= static_cast<std::uint32_t>(outside) << lane;
+        straddle_bits |= static_cast<std::uint32_t>(straddle) << lane;
+    }
+#else
+    for (std::size_t lane = 0; lane < LANES; ++lane) {
+        const float distance = normals_x[lane] * centre.x + normals_y[lane] * centre.y + normals_z[lane] * centre.z + distances[lane];
+        const float radius = std::fabs(normals_x[lane]) * extents.x + std::fabs(normals_y[lane]) * extents.y + std::fabs(normals_z[lane]) * extents.z;
+        if (distance + radius < 0.0f) {
+            outside_bits |= 1u << lane;
+        }
+        if (distance - radius < 0.0f) {
+            straddle_bits |= 1u << lane;
+        }
+    }
+#endif
+
+    if (0 != (outside_bits & plane_mask)) {
+        return Containment::OUTSIDE;
+    }
+    plane_mask &= straddle_bits;
+    return 0 == plane_mask ? Containment::INSIDE : Containment::INTERSECTING;
+}
+
+Containment
+Frustum::test(const BoundingBox &box) const noexcept
+{
+    std::uint32_t plane_mask = ALL_PLANES;
+    return test(box, plane_mask);
+}
+
+void
+BoundingVolumeHierarchy::build(const std::vector<BoundingBox> &object_boxes)
+{
+    boxes = object_boxes;
+    rebuild();
+}
+
+void
+BoundingVolumeHierarchy::rebuild(void)
+{
+    const auto object_count = static_cast<std::uint32_t>(boxes.size());
+    nodes.clear();
+    ordered_objects.resize(object_count);
+    leaf_of_object.resize(object_count);
+    for (std::uint32_t i = 0; i < object_count; ++i) {
+        ordered_objects[i] = i;
+    }
+
+    if (0 != object_count) {
+        /* A balanced binary tree with leaves of up to MAX_LEAF_SIZE objects has less than this many nodes */
+        nodes.reserve(2 * (object_count / MAX_LEAF_SIZE + 1));
+        nodes.push_back({{}, 0, 0, NO_PARENT});
+        buildNode(0, 0, object_count);
+    }
+    built_surface_area = current_surface_area = getTotalSurfaceArea();
+}
+
+void
+BoundingVolumeHierarchy::buildNode(std::uint32_t node_index, std::uint32_t begin, std::uint32_t end)
+{
+    BoundingBox bounds = boxes[ordered_objects[begin]];
+    BoundingBox centroid_bounds{bounds.getCentre(), bounds.getCentre()};
+    for (std::uint32_t i = begin + 1; i < end; ++i) {
+        const BoundingBox &box = boxes[ordered_objects[i]];
+        const glm::vec3 centre = box.getCentre();
+        bounds = BoundingBox::merge(bounds, box);
+        centroid_bounds = BoundingBox::merge(centroid_bounds, {centre, centre});
+    }
+    nodes[node_index].box = bounds;
+
+    if (end - begin <= MAX_LEAF_SIZE) {
+        nodes[node_index].first = begin;
+        nodes[node_index].count = end - begin;
+        for (std::uint32_t i = begin; i < end; ++i) {
+            leaf_of_object[ordered_objects[i]] = node_index;
+        }
+        return;
+    }
+
+    /* Median split along the axis where the centroids are the most spread out */
+    const glm::vec3 spread = centroid_bounds.max - centroid_bounds.min;
+    int axis = 0;
+    if (spread.y > spread[axis]) {
+        axis = 1;
+    }
+    if (spread.z > spread[axis]) {
+        axis = 2;
+    }
+    const std::uint32_t middle = begin + (end - begin) / 2;
+    std::nth_element(ordered_objects.begin() + begin, ordered_objects.begin() + middle, ordered_objects.begin() + end,
+                     [this, axis](ObjectId lhs, ObjectId rhs) {
+                         return boxes[lhs].getCentre()[axis] < boxes[rhs].getCentre()[axis];
+                     });
+
+    const auto left = static_cast<std::uint32_t>(nodes.size());
+    nodes[node_index].first = left;
+    nodes[node_index].count = 0;
+    nodes.push_back({{}, 0, 0, node_index});
+    nodes.push_back({{}, 0, 0, node_index});
+    buildNode(left, begin, middle);
+    buildNode(left + 1, middle, end);
+}
+
+void
+BoundingVolumeHierarchy::update(ObjectId object, const BoundingBox &box) noexcept
+{
+    boxes[object] = box;
+    if (nodes.empty()) {
+        return;
+    }
+
+    /* Walk up from the leaf, stopping as soon as a node is left unchanged since its ancestors are then up to date */
+    std::uint32_t node_index = leaf_of_object[object];
+    while (NO_PARENT != node_index) {
+        const BoundingBox previous = nodes[node_index].box;
+        refitNode(node_index);
+        if (nodes[node_index].box == previous) {
+            break;
+        }
+        current_surface_area += nodes[node_index].box.getSurfaceArea() - previous.getSurfaceArea();
+        node_index = nodes[node_index].parent;
+    }
+}
+
+void
+BoundingVolumeHierarchy::refitNode(std::uint32_t node_index) noexcept
+{
+    Node &node = nodes[node_index];
+    if (0 == node.count) {
+        node.box = BoundingBox::merge(nodes[node.first].box, nodes[node.first + 1].box);
+        return;
+    }
+    node.box = boxes[ordered_objects[node.first]];
+    for (std::uint32_t i = node.first + 1; i < node.first + node.count; ++i) {
+        node.box = BoundingBox::merge(node.box, boxes[ordered_objects[i]]);
+    }
+}
+
+bool
+BoundingVolumeHierarchy::needsRebuild(void) const noexcept
+{
+    /* The summed node surface area is a proxy for the expected traversal cost */
+    static constexpr float DEGRADATION_THRESHOLD{2.0f};
+    return current_surface_area > built_surface_area * DEGRADATION_THRESHOLD;
+}
+
+float
+BoundingVolumeHierarchy::getTotalSurfaceArea(void) const noexcept
+{
+    float total = 0.0f;
+    for (const Node &node : nodes) {
+        total += node.box.getSurfaceArea();
+    }
+    return total;
+}
+
+void
+BoundingVolumeHierarchy::cull(const Frustum &frustum, std::vector<ObjectId> &visible) const
+{
+    if (nodes.empty()) {
+        return;
+    }
+
+    struct StackEntry
+    {
+        std::uint32_t node_index;
+        std::uint32_t plane_mask;
+    };
+    /* Median splits keep the tree balanced, so its depth is bounded by log2 of the object count */
+    std::array<StackEntry, 64> stack;
+    std::size_t stack_size = 0;
+    stack[stack_size++] = {0, Frustum::ALL_PLANES};
+
+    while (0 != stack_size) {
+        StackEntry entry = stack[--stack_size];
+        const Node &node = nodes[entry.node_index];
+
+        const Containment containment = frustum.test(node.box, entry.plane_mask);
+        if (Containment::OUTSIDE == containment) {
+            continue;
+        }
+        if (Containment::INSIDE == containment) {
+            appendSubtree(entry.node_index, visible);
+            continue;
+        }
+
+        if (0 == node.count) {
+            stack[stack_size++] = {node.first + 1, entry.plane_mask};
+            stack[stack_size++] = {node.first, entry.plane_mask};
+            continue;
+        }
+        for (std::uint32_t i = node.first; i < node.first + node.count; ++i) {
+            std::uint32_t plane_mask = entry.plane_mask;
+            if (Containment::OUTSIDE != frustum.test(boxes[ordered_objects[i]], plane_mask)) {
+                visible.push_back(ordered_objects[i]);
+            }
+        }
+    }
+}
+
+void
+BoundingVolumeHierarchy::appendSubtree(std::uint32_t node_index, std::vector<ObjectId> &visible) const
+{
+    /* The objects of a subtree are contiguous, only its leftmost and rightmost leaves are needed */
+    std::uint32_t leftmost = node_index;
+    while (0 == nodes[leftmost].count) {
+        leftmost = nodes[leftmost].first;
+    }
+    std::uint32_t rightmost = node_index;
+    while (0 == nodes[rightmost].count) {
+        rightmost = nodes[rightmost].first + 1;
+    }
+    const auto begin = ordered_objects.begin() + nodes[leftmost].first;
+    const auto end = ordered_objects.begin() + nodes[rightmost].first + nodes[rightmost].count;
+    visible.insert(visible.end(), begin, end);
+}
+
+std::size_t
+BoundingVolumeHierarchy::getObjectCount(void) const noexcept
+{
+    return boxes.size();
+}
+
+const BoundingBox &
+BoundingVolumeHierarchy::getBounds(ObjectId object) const noexcept
+{
+    return boxes[object];
+}
+
+
+DepthPyramid::DepthPyramid(std::uint32_t pyramid_size) : size{std::bit_ceil(std::max(pyramid_size, 1u))}
+{
+    std::size_t offset = 0;
+    for (std::uint32_t level_size = size; 0 < level_size; level_size >>= 1) {
+        level_offsets.push_back(offset);
+        offset += std::size_t{level_size} * level_size;
+    }
+    depths.assign(offset, FAR_DEPTH);
+}
+
+void
+DepthPyramid::clear(void) noexcept
+{
+    std::fill(depths.begin(), depths.end(), FAR_DEPTH);
+}
+
+void
+DepthPyramid::addOccluder(const std::array<glm::vec2, 4> &corners, float depth)
+{
+    /* In texel units, texel (x, y) spans [x, x + 1] x [y, y + 1] */
+    const float scale = 0.5f * static_cast<float>(size);
+    std::array<glm::vec2, 4> points{};
+    float low_y = std::numeric_limits<float>::max();
+    float high_y = std::numeric_limits<float>::lowest();
+    float area = 0.0f;
+    for (std::size_t i = 0; i < points.size(); ++i) {
+        points[i] = (corners[i] + 1.0f) * scale;
+        low_y = std::min(low_y, points[i].y);
+        high_y = std::max(high_y, points[i].y);
+    }
+    for (std::size_t i = 0; i < points.size(); ++i) {
+        const glm::vec2 &next = points[(i + 1) % points.size()];
+        area += points[i].x * next.y - next.x * points[i].y;
+    }
+    if (0.0f == area) {
+        return;
+    }
+    const float orientation = area < 0.0f ? -1.0f : 1.0f;
+
+    /* Texel corners that can be inside, a texel is covered when its four corners are */
+    const float limit = static_cast<float>(size);
+    const auto first_y = static_cast<std::uint32_t>(std::ceil(std::clamp(low_y, 0.0f, limit)));
+    const auto last_y = static_cast<std::uint32_t>(std::floor(std::clamp(high_y, 0.0f, limit)));
+    if (last_y <= first_y) {
+        return;
+    }
+
+    /* Along a row of corners every edge bounds x on one side, the quad being convex what is inside is one span */
+    spans.resize(last_y - first_y + 1);
+    for (std::uint32_t y = first_y; y <= last_y; ++y) {
+        glm::vec2 &span = spans[y - first_y];
+        span = glm::vec2(0.0f, limit);
+        const float row = static_cast<float>(y);
+        for (std::size_t i = 0; i < points.size(); ++i) {
+            const glm::vec2 edge = (points[(i + 1) % points.size()] - points[i]) * orientation;
+            /* Inside when edge.x * (row - a.y) - edge.y * (x - a.x) >= 0 */
+            const float constant = edge.x * (row - points[i].y);
+            if (0.0f == edge.y) {
+                span.y = constant < 0.0f ? -1.0f : span.y;
+            } else if (0.0f < edge.y) {
+                span.y = std::min(span.y, points[i].x + constant / edge.y);
+            } else {
+                span.x = std::max(span.x, points[i].x + constant / edge.y);
+            }
+        }
+    }
+    for (std::uint32_t y = first_y; y < last_y; ++y) {
+        /* Both corner rows of the texels have to be inside */
+        const float left = std::max(spans[y - first_y].x, spans[y - first_y + 1].x);
+        const float right = std::min(spans[y - first_y].y, spans[y - first_y + 1].y);
+        if (right - left < 1.0f) {
+            continue;
+        }
+        const auto first_x = static_cast<std::uint32_t>(std::ceil(left));
+        const auto end_x = static_cast<std::uint32_t>(std::floor(right));
+        float *texels = &depths[std::size_t{y} * size];
+        for (std::uint32_t x = first_x; x < end_x; ++x) {
+            texels[x] = std::min(texels[x], depth);
+        }
+    }
+}
+
+void
+DepthPyramid::build(void) noexcept
+{
+    for (std::size_t level = 1; level < level_offsets.size(); ++level) {
+        const std::size_t below_size = size >> (level - 1);
+        const std::size_t level_size = size >> level;
+        const float *below = &depths[level_offsets[level - 1]];
+        float *texels = &depths[level_offsets[level]];
+        for (std::size_t y = 0; y < level_size; ++y) {
+            const float *top = below + 2 * y * below_size;
+            const float *bottom = top + below_size;
+            for (std::size_t x = 0; x < level_size; ++x) {
+                texels[y * level_size + x] = std::max(std::max(top[2 * x], top[2 * x + 1]), std::max(bottom[2 * x], bottom[2 * x + 1]));
+            }
+        }
+    }
+}
+
+bool
+DepthPyramid::isOccluded(const BoundingBox &box) const noexcept
+{
+    /* Parts outside the NDC square are never seen, those are left to frustum culling */
+    const float scale = 0.5f * static_cast<float>(size);
+    const float min_x = (std::max(box.min.x, -1.0f) + 1.0f) * scale;
+    const float max_x = (std::min(box.max.x, 1.0f) + 1.0f) * scale;
+    const float min_y = (std::max(box.min.y, -1.0f) + 1.0f) * scale;
+    const float max_y = (std::min(box.max.y, 1.0f) + 1.0f) * scale;
+    if (min_x > max_x || min_y > max_y) {
+        return false;
+    }
+    const std::uint32_t last = size - 1;
+    const std::uint32_t first_x = std::min(static_cast<std::uint32_t>(min_x), last);
+    const std::uint32_t last_x = std::min(static_cast<std::uint32_t>(max_x), last);
+    const std::uint32_t first_y = std::min(static_cast<std::uint32_t>(min_y), last);
+    const std::uint32_t last_y = std::min(static_cast<std::uint32_t>(max_y), last);
+
+    /* The finest level where the box spans at most 4x4 texels, coarser ones reach too far past its edges */
+    std::uint32_t level = 0;
+    while (3 < (last_x >> level) - (first_x >> level) || 3 < (last_y >> level) - (first_y >> level)) {
+        ++level;
+    }
+    const std::size_t level_size = size >> level;
+    const float *texels = &depths[level_offsets[level]];
+    float farthest = std::numeric_limits<float>::lowest();
+    for (std::uint32_t y = first_y >> level; y <= last_y >> level; ++y) {
+        for (std::uint32_t x = first_x >> level; x <= last_x >> level; ++x) {
+            farthest = std::max(farthest, texels[y * level_size + x]);
+        }
+    }
+    return box.min.z > farthest;
+}
+
+std::uint32_t
+DepthPyramid::getSize(void) const noexcept
+{
+    return size;
+}
+
+std::size_t
+DepthPyramid::getLevelCount(void) const noexcept
+{
+    return level_offsets.size();
+}
+
+}; // namespace Culling
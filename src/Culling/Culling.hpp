@@ -0,0 +1,152 @@
+#ifndef CULLING_HPP
+#define CULLING_HPP
+
+#include <glm/glm.hpp>
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+namespace Culling
+{
+
+using ObjectId = std::uint32_t;
+
+struct BoundingBox
+{
+    glm::vec3 min, max;
+
+    /* Smallest box enclosing both boxes */
+    static BoundingBox merge(const BoundingBox &lhs, const BoundingBox &rhs) noexcept;
+
+    /* Axis-aligned box enclosing this box once transformed by the given matrix */
+    BoundingBox transformed(const glm::mat4 &transformation) const noexcept;
+
+    glm::vec3 getCentre(void) const noexcept;
+    glm::vec3 getExtents(void) const noexcept;
+    float getSurfaceArea(void) const noexcept;
+};
+
+bool operator==(const BoundingBox &lhs, const BoundingBox &rhs) noexcept;
+
+enum class Containment
+{
+    OUTSIDE,
+    INTERSECTING,
+    INSIDE
+};
+
+class Frustum
+{
+  public:
+    /* Extract the six clip planes of a view-projection matrix, identity yields the NDC cube */
+    explicit Frustum(const glm::mat4 &view_projection) noexcept;
+
+    /*
+     * Test a box against the planes whose bit is set in plane_mask.
+     * On return, plane_mask only keeps the planes the box straddles so that children can skip the others.
+     */
+    Containment test(const BoundingBox &box, std::uint32_t &plane_mask) const noexcept;
+    Containment test(const BoundingBox &box) const noexcept;
+
+    static constexpr std::uint32_t ALL_PLANES{0x3F};
+
+  private:
+    /* Planes are stored as structure of arrays padded to 8 lanes, the two extra planes never reject */
+    static constexpr std::size_t LANES{8};
+    alignas(16) std::array<float, LANES> normals_x, normals_y, normals_z, distances;
+};
+
+/*
+ * Bounding volume hierarchy over objects identified by a dense index.
+ * Moving objects only refit the path from their leaf to the root, a full rebuild is only needed
+ * when the tree quality has degraded too much (see needsRebuild()).
+ */
+class BoundingVolumeHierarchy
+{
+  public:
+    /* Build the tree from scratch, object i gets ObjectId i */
+    void build(const std::vector<BoundingBox> &object_boxes);
+
+    /* Update the bounds of a moving object and refit its ancestors */
+    void update(ObjectId object, const BoundingBox &box) noexcept;
+
+    /* Rebuild with the current object bounds */
+    void rebuild(void);
+
+    /* Whether refitting has inflated the tree enough that a rebuild would pay off */
+    bool needsRebuild(void) const noexcept;
+
+    /* Append the objects intersecting the frustum to visible, in tree order */
+    void cull(const Frustum &frustum, std::vector<ObjectId> &visible) const;
+
+    std::size_t getObjectCount(void) const noexcept;
+    const BoundingBox &getBounds(ObjectId object) const noexcept;
+
+  private:
+    static constexpr std::uint32_t MAX_LEAF_SIZE{4};
+    static constexpr std::uint32_t NO_PARENT{UINT32_MAX};
+
+    struct Node
+    {
+        BoundingBox box;
+        /* Index of the left child (right is left + 1) or first object for leaves */
+        std::uint32_t first;
+        /* Number of objects, 0 for inner nodes */
+        std::uint32_t count;
+        std::uint32_t parent;
+    };
+
+    void buildNode(std::uint32_t node_index, std::uint32_t begin, std::uint32_t end);
+    void refitNode(std::uint32_t node_index) noexcept;
+    void appendSubtree(std::uint32_t node_index, std::vector<ObjectId> &visible) const;
+    float getTotalSurfaceArea(void) const noexcept;
+
+    std::vector<Node> nodes{};
+    /* Objects sorted in leaf order, leaves reference ranges of this array */
+    std::vector<ObjectId> ordered_objects{};
+    std::vector<BoundingBox> boxes{};
+    std::vector<std::uint32_t> leaf_of_object{};
+    float built_surface_area = 0.0f;
+    float current_surface_area = 0.0f;
+};
+
+/*
+ * Hierarchical depth buffer over the NDC square, built on the CPU from a few large occluders.
+ * Occluders only write the texels they fully cover and every level keeps the farthest depth of the 2x2 texels below,
+ * so that a box is tested against at most 4x4 texels of one level and is never reported hidden when it is not.
+ */
+class DepthPyramid
+{
+  public:
+    /* Level 0 is size x size texels, rounded up to a power of two */
+    explicit DepthPyramid(std::uint32_t size = 256);
+
+    /* Every texel back to the far plane */
+    void clear(void) noexcept;
+
+    /* Convex quad in NDC at a single depth, in either winding */
+    void addOccluder(const std::array<glm::vec2, 4> &corners, float depth);
+
+    /* Reduce level 0 into the levels above, once the occluders are in */
+    void build(void) noexcept;
+
+    /* Whether the box, in NDC, is behind the occluders everywhere it covers */
+    bool isOccluded(const BoundingBox &box) const noexcept;
+
+    std::uint32_t getSize(void) const noexcept;
+    std::size_t getLevelCount(void) const noexcept;
+
+  private:
+    static constexpr float FAR_DEPTH{1.0f};
+
+    std::uint32_t size;
+    /* Level i is (size >> i) squared texels, all levels in one allocation */
+    std::vector<float> depths{};
+    std::vector<std::size_t> level_offsets{};
+    /* Part of every row of texel corners inside the occluder being added */
+    std::vector<glm::vec2> spans{};
+};
+
+}; // namespace Culling
+#endif
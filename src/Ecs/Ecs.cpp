@@ -0,0 +1,214 @@
+#include "Ecs.hpp"
+
+#include <cstdlib>
+#include <fmt/core.h>
+
+namespace Ecs
+{
+
+static constexpr std::uint8_t NO_COLUMN{0xFF};
+
+ComponentId
+allocateComponentId(void) noexcept
+{
+    static std::atomic<ComponentId> next_id{0};
+    const ComponentId id = next_id++;
+    if (id >= MAX_COMPONENTS) {
+        fmt::print(stderr, "allocateComponentId: More than {} component types are in use.\n", MAX_COMPONENTS);
+        std::abort();
+    }
+    return id;
+}
+
+Archetype::Archetype(ComponentMask archetype_mask) noexcept : mask{archetype_mask}
+{
+    column_of_component.fill(NO_COLUMN);
+}
+
+ComponentMask
+Archetype::getMask(void) const noexcept
+{
+    return mask;
+}
+
+std::size_t
+Archetype::getSize(void) const noexcept
+{
+    return entities.size();
+}
+
+const std::vector<Entity> &
+Archetype::getEntities(void) const noexcept
+{
+    return entities;
+}
+
+void
+Archetype::addColumn(ComponentId component, std::size_t element_size)
+{
+    column_of_component[component] = static_cast<std::uint8_t>(columns.size());
+    columns.push_back({component, element_size, {}});
+}
+
+std::byte *
+Archetype::getElement(ComponentId component, std::size_t row) noexcept
+{
+    Column &column = columns[column_of_component[component]];
+    return column.data.data() + row * column.element_size;
+}
+
+std::size_t
+Archetype::pushRow(Entity entity)
+{
+    const std::size_t row = entities.size();
+    entities.push_back(entity);
+    for (Column &column : columns) {
+        column.data.resize(column.data.size() + column.element_size);
+    }
+    return row;
+}
+
+bool
+Archetype::removeRow(std::size_t row, Entity &moved_entity) noexcept
+{
+    const std::size_t last = entities.size() - 1;
+    const bool has_moved = row != last;
+    if (has_moved) {
+        for (Column &column : columns) {
+            std::memcpy(column.data.data() + row * column.element_size, column.data.data() + last * column.element_size, column.element_size);
+        }
+        entities[row] = entities[last];
+        moved_entity = entities[row];
+    }
+    entities.pop_back();
+    for (Column &column : columns) {
+        column.data.resize(column.data.size() - column.element_size);
+    }
+    return has_moved;
+}
+
+void
+World::destroy(Entity entity) noexcept
+{
+    if (!isAlive(entity)) {
+        return;
+    }
+    EntityRecord &record = records[entity.index];
+    Entity moved_entity{};
+    if (archetypes[record.archetype].removeRow(record.row, moved_entity)) {
+        records[moved_entity.index].row = record.row;
+    }
+    ++record.generation;
+    free_indices.push_back(entity.index);
+    --entity_count;
+}
+
+bool
+World::isAlive(Entity entity) const noexcept
+{
+    return entity.index < records.size() && records[entity.index].generation == entity.generation;
+}
+
+std::size_t
+World::getEntityCount(void) const noexcept
+{
+    return entity_count;
+}
+
+Entity
+World::allocateEntity(void)
+{
+    ++entity_count;
+    if (!free_indices.empty()) {
+        const std::uint32_t index = free_indices.back();
+        free_indices.pop_back();
+        return {index, records[index].generation};
+    }
+    records.push_back({0, 0, 0});
+    return {static_cast<std::uint32_t>(records.size() - 1), 0};
+}
+
+Archetype &
+World::getArchetype(ComponentMask mask, const std::vector<ComponentLayout> &layout)
+{
+    const auto found = archetype_index_of_mask.find(mask);
+    if (archetype_index_of_mask.end() != found) {
+        return archetypes[found->second];
+    }
+    archetype_index_of_mask.emplace(mask, static_cast<std::uint32_t>(archetypes.size()));
+    Archetype &archetype = archetypes.emplace_back(mask);
+    for (const ComponentLayout &component : layout) {
+        archetype.addColumn(component.component, component.element_size);
+    }
+    return archetype;
+}
+
+std::vector<World::ComponentLayout>
+World::getLayout(const Archetype &source, ComponentMask mask)
+{
+    std::vector<ComponentLayout> layout{};
+    for (const Archetype::Column &column : source.columns) {
+        if (0 != (mask & (ComponentMask{1} << column.component))) {
+            layout.push_back({column.component, column.element_size});
+        }
+    }
+    return layout;
+}
+
+void
+World::moveEntity(Entity entity, Archetype &target)
+{
+    EntityRecord &record = records[entity.index];
+    Archetype &source = archetypes[record.archetype];
+    const std::size_t target_row = target.pushRow(entity);
+    for (const Archetype::Column &column : target.columns) {
+        if (0 != (source.getMask() & (ComponentMask{1} << column.component))) {
+            std::memcpy(target.getElement(column.component, target_row), source.getElement(column.component, record.row), column.element_size);
+        }
+    }
+
+    Entity moved_entity{};
+    if (source.removeRow(record.row, moved_entity)) {
+        records[moved_entity.index].row = record.row;
+    }
+    record.archetype = archetype_index_of_mask.at(target.getMask());
+    record.row = static_cast<std::uint32_t>(target_row);
+}
+
+void
+Schedule::addSystem(std::string name, ComponentMask reads, ComponentMask writes, System system)
+{
+    bool conflicts = stages.empty();
+    if (!conflicts) {
+        for (const SystemEntry &entry : stages.back()) {
+            if (0 != (writes & (entry.reads | entry.writes)) || 0 != (reads & entry.writes)) {
+                conflicts = true;
+                break;
+            }
+        }
+    }
+    if (conflicts) {
+        stages.emplace_back();
+    }
+    stages.back().push_back({std::move(name), reads, writes, std::move(system)});
+}
+
+void
+Schedule::run(World &world)
+{
+    for (std::vector<SystemEntry> &stage : stages) {
+        Utils::JobSystem::getInstance().parallelFor(stage.size(), [&stage, &world](std::size_t begin, std::size_t end) {
+            for (std::size_t i = begin; i < end; ++i) {
+                stage[i].system(world);
+            }
+        });
+    }
+}
+
+std::size_t
+Schedule::getStageCount(void) const noexcept
+{
+    return stages.size();
+}
+
+}; // namespace Ecs
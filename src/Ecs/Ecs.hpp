@@ -0,0 +1,276 @@
+#ifndef ECS_HPP
+#define ECS_HPP
+
+#include "JobSystem.hpp"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+namespace Ecs
+{
+
+struct Entity
+{
+    std::uint32_t index, generation;
+};
+
+using ComponentId = std::uint32_t;
+using ComponentMask = std::uint64_t;
+
+static constexpr ComponentId MAX_COMPONENTS{64};
+
+/* Component ids are handed out on first use, they only need to be stable within a run */
+ComponentId allocateComponentId(void) noexcept;
+
+template <class T>
+inline ComponentId
+componentId(void) noexcept
+{
+    static const ComponentId id = allocateComponentId();
+    return id;
+}
+
+template <class... Ts>
+inline ComponentMask
+componentMask(void) noexcept
+{
+    return (ComponentMask{0} | ... | (ComponentMask{1} << componentId<Ts>()));
+}
+
+/* All the entities sharing the exact same set of components, each component is stored in its own array */
+class Archetype
+{
+  public:
+    explicit Archetype(ComponentMask archetype_mask) noexcept;
+
+    ComponentMask getMask(void) const noexcept;
+    std::size_t getSize(void) const noexcept;
+    const std::vector<Entity> &getEntities(void) const noexcept;
+
+    template <class T>
+    T *
+    getColumn(void) noexcept
+    {
+        return reinterpret_cast<T *>(columns[column_of_component[componentId<T>()]].data.data());
+    }
+
+  private:
+    friend class World;
+
+    struct Column
+    {
+        ComponentId component;
+        std::size_t element_size;
+        std::vector<std::byte> data;
+    };
+
+    void addColumn(ComponentId component, std::size_t element_size);
+    std::byte *getElement(ComponentId component, std::size_t row) noexcept;
+    std::size_t pushRow(Entity entity);
+    /* Swap-remove a row, returns the entity moved into its place if any */
+    bool removeRow(std::size_t row, Entity &moved_entity) noexcept;
+
+    ComponentMask mask;
+    std::vector<Entity> entities{};
+    std::vector<Column> columns{};
+    std::array<std::uint8_t, MAX_COMPONENTS> column_of_component{};
+};
+
+class World
+{
+  public:
+    template <class... Ts>
+    Entity
+    create(const Ts &...components)
+    {
+        static_assert((std::is_trivially_copyable_v<Ts> && ...), "Components are moved around with memcpy.");
+        Archetype &archetype = getArchetype(componentMask<Ts...>(), {{componentId<Ts>(), sizeof(Ts)}...});
+        const Entity entity = allocateEntity();
+        const std::size_t row = archetype.pushRow(entity);
+        (std::memcpy(archetype.getElement(componentId<Ts>(), row), &components, sizeof(Ts)), ...);
+        records[entity.index].archetype = archetype_index_of_mask.at(archetype.getMask());
+        records[entity.index].row = static_cast<std::uint32_t>(row);
+        return entity;
+    }
+
+    void destroy(Entity entity) noexcept;
+    bool isAlive(Entity entity) const noexcept;
+
+    template <class T>
+    T *
+    get(Entity entity) noexcept
+    {
+        if (!isAlive(entity)) {
+            return nullptr;
+        }
+        const EntityRecord &record = records[entity.index];
+        Archetype &archetype = archetypes[record.archetype];
+        if (0 == (archetype.getMask() & componentMask<T>())) {
+            return nullptr;
+        }
+        return reinterpret_cast<T *>(archetype.getElement(componentId<T>(), record.row));
+    }
+
+    /* Add a component to an entity, moving it to another archetype, or overwrite it if already present */
+    template <class T>
+    void
+    add(Entity entity, const T &component)
+    {
+        static_assert(std::is_trivially_copyable_v<T>, "Components are moved around with memcpy.");
+        if (T *existing = get<T>(entity)) {
+            *existing = component;
+            return;
+        }
+        if (!isAlive(entity)) {
+            return;
+        }
+        const Archetype &source = archetypes[records[entity.index].archetype];
+        const ComponentMask source_mask = source.getMask();
+        std::vector<ComponentLayout> layout = getLayout(source, source_mask);
+        layout.push_back({componentId<T>(), sizeof(T)});
+        moveEntity(entity, getArchetype(source_mask | componentMask<T>(), layout));
+        *get<T>(entity) = component;
+    }
+
+    template <class T>
+    void
+    remove(Entity entity)
+    {
+        if (nullptr == get<T>(entity)) {
+            return;
+        }
+        const Archetype &source = archetypes[records[entity.index].archetype];
+        const ComponentMask target_mask = source.getMask() & ~componentMask<T>();
+        moveEntity(entity, getArchetype(target_mask, getLayout(source, target_mask)));
+    }
+
+    /* Call function(Ts &...) for every entity owning at least all of Ts, one contiguous array per component */
+    template <class... Ts, class Function>
+    void
+    each(Function &&function)
+    {
+        const ComponentMask required = componentMask<Ts...>();
+        for (Archetype &archetype : archetypes) {
+            if ((archetype.getMask() & required) != required) {
+                continue;
+            }
+            iterateRows<Ts...>(archetype, 0, archetype.getSize(), function);
+        }
+    }
+
+    /*
+     * Same as each(), but rows are split in chunks of at least min_chunk_size spread over the worker pool.
+     * The function must only touch the components it is given.
+     */
+    template <class... Ts, class Function>
+    void
+    parallelEach(Function &&function, std::size_t min_chunk_size = 1024)
+    {
+        struct Chunk
+        {
+            Archetype *archetype;
+            std::size_t begin, end;
+        };
+        const ComponentMask required = componentMask<Ts...>();
+        Utils::JobSystem &jobs = Utils::JobSystem::getInstance();
+        const std::size_t worker_count = jobs.getWorkerCount();
+        std::vector<Chunk> chunks{};
+        for (Archetype &archetype : archetypes) {
+            if ((archetype.getMask() & required) != required) {
+                continue;
+            }
+            const std::size_t size = archetype.getSize();
+            const std::size_t chunk_size = std::max(min_chunk_size, (size + worker_count - 1) / worker_count);
+            for (std::size_t begin = 0; begin < size; begin += chunk_size) {
+                chunks.push_back({&archetype, begin, std::min(size, begin + chunk_size)});
+            }
+        }
+        if (1 >= chunks.size()) {
+            for (const Chunk &chunk : chunks) {
+                iterateRows<Ts...>(*chunk.archetype, chunk.begin, chunk.end, function);
+            }
+            return;
+        }
+        jobs.parallelFor(chunks.size(), [&chunks, &function](std::size_t begin, std::size_t end) {
+            for (std::size_t i = begin; i < end; ++i) {
+                iterateRows<Ts...>(*chunks[i].archetype, chunks[i].begin, chunks[i].end, function);
+            }
+        });
+    }
+
+    std::size_t getEntityCount(void) const noexcept;
+
+  private:
+    struct EntityRecord
+    {
+        std::uint32_t generation;
+        std::uint32_t archetype;
+        std::uint32_t row;
+    };
+
+    struct ComponentLayout
+    {
+        ComponentId component;
+        std::size_t element_size;
+    };
+
+    template <class... Ts, class Function>
+    static void
+    iterateRows(Archetype &archetype, std::size_t begin, std::size_t end, Function &function)
+    {
+        std::tuple<Ts *...> columns{archetype.getColumn<Ts>()...};
+        for (std::size_t row = begin; row < end; ++row) {
+            function(std::get<Ts *>(columns)[row]...);
+        }
+    }
+
+    Entity allocateEntity(void);
+    Archetype &getArchetype(ComponentMask mask, const std::vector<ComponentLayout> &layout);
+    static std::vector<ComponentLayout> getLayout(const Archetype &source, ComponentMask mask);
+    void moveEntity(Entity entity, Archetype &target);
+
+    std::vector<Archetype> archetypes{};
+    std::unordered_map<ComponentMask, std::uint32_t> archetype_index_of_mask{};
+    std::vector<EntityRecord> records{};
+    std::vector<std::uint32_t> free_indices{};
+    std::size_t entity_count = 0;
+};
+
+/*
+ * Ordered list of systems. Consecutive systems whose component accesses do not conflict are grouped
+ * into a stage and run concurrently, stages run one after the other.
+ * Systems must not create or destroy entities, or add or remove components.
+ */
+class Schedule
+{
+  public:
+    using System = std::function<void(World &)>;
+
+    void addSystem(std::string name, ComponentMask reads, ComponentMask writes, System system);
+    void run(World &world);
+
+    std::size_t getStageCount(void) const noexcept;
+
+  private:
+    struct SystemEntry
+    {
+        std::string name;
+        ComponentMask reads, writes;
+        System system;
+    };
+
+    std::vector<std::vector<SystemEntry>> stages{};
+};
+
+}; // namespace Ecs
+#endif
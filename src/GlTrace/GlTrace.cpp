@@ -0,0 +1,483 @@
+#include "GlTrace.hpp"
+#include "GlEntryPoints.hpp"
+
+#include <fmt/core.h>
+
+#include <algorithm>
+#include <fstream>
+#include <numeric>
+
+namespace GlTrace
+{
+
+static constexpr std::string_view ENTRY_POINT_NAMES[]{
+#define GLTRACE_NAME(name) #name,
+    GLTRACE_ENTRY_POINTS(GLTRACE_NAME)
+#undef GLTRACE_NAME
+};
+
+std::string_view
+getEntryPointName(std::size_t entry_point) noexcept
+{
+    return entry_point < ENTRY_POINT_COUNT ? ENTRY_POINT_NAMES[entry_point] : std::string_view{};
+}
+
+/* Binds, capabilities and fixed function state, uniforms are counted on their own */
+static bool
+isStateChange(std::string_view name) noexcept
+{
+    static constexpr std::string_view PREFIXES[]{"glBind", "glUseProgram", "glEnable", "glDisable", "glBlend", "glDepthFunc", "glDepthMask",
+                                                 "glColorMask", "glStencil", "glActiveTexture", "glViewport", "glScissor", "glCullFace",
+                                                 "glFrontFace", "glPolygonMode", "glPolygonOffset", "glPixelStore", "glTexParameter"};
+    return std::any_of(std::begin(PREFIXES), std::end(PREFIXES), [name](std::string_view prefix) { return name.starts_with(prefix); });
+}
+
+template <std::size_t Index, class Function>
+struct CountingWrapper;
+
+template <std::size_t Index, class Result, class... Arguments>
+struct CountingWrapper<Index, Result(APIENTRYP)(Arguments...)>
+{
+    static inline Result(APIENTRYP original)(Arguments...) = nullptr;
+
+    static Result APIENTRY
+    call(Arguments... arguments)
+    {
+        Tracer::getInstance().countCall(Index);
+        return original(arguments...);
+    }
+};
+
+template <std::size_t Index, class Function>
+static void
+installCounter(Function &pointer) noexcept
+{
+    if (nullptr != pointer) {
+        CountingWrapper<Index, Function>::original = pointer;
+        pointer = &CountingWrapper<Index, Function>::call;
+    }
+}
+
+static std::uint64_t
+getTexelSize(GLenum format, GLenum type) noexcept
+{
+    switch (type) {
+    case GL_UNSIGNED_BYTE_3_3_2:
+    case GL_UNSIGNED_BYTE_2_3_3_REV:
+        return 1;
+    case GL_UNSIGNED_SHORT_5_6_5:
+    case GL_UNSIGNED_SHORT_5_6_5_REV:
+    case GL_UNSIGNED_SHORT_4_4_4_4:
+    case GL_UNSIGNED_SHORT_4_4_4_4_REV:
+    case GL_UNSIGNED_SHORT_5_5_5_1:
+    case GL_UNSIGNED_SHORT_1_5_5_5_REV:
+        return 2;
+    case GL_UNSIGNED_INT_8_8_8_8:
+    case GL_UNSIGNED_INT_8_8_8_8_REV:
+    case GL_UNSIGNED_INT_10_10_10_2:
+    case GL_UNSIGNED_INT_2_10_10_10_REV:
+    case GL_UNSIGNED_INT_24_8:
+    case GL_UNSIGNED_INT_10F_11F_11F_REV:
+    case GL_UNSIGNED_INT_5_9_9_9_REV:
+        return 4;
+    case GL_FLOAT_32_UNSIGNED_INT_24_8_REV:
+        return 8;
+    default:
+        break;
+    }
+
+    std::uint64_t components = 4;
+    switch (format) {
+    case GL_RED:
+    case GL_RED_INTEGER:
+    case GL_DEPTH_COMPONENT:
+    case GL_STENCIL_INDEX:
+        components = 1;
+        break;
+    case GL_RG:
+    case GL_RG_INTEGER:
+        components = 2;
+        break;
+    case GL_RGB:
+    case GL_BGR:
+    case GL_RGB_INTEGER:
+    case GL_BGR_INTEGER:
+        components = 3;
+        break;
+    default:
+        break;
+    }
+    switch (type) {
+    case GL_SHORT:
+    case GL_UNSIGNED_SHORT:
+    case GL_HALF_FLOAT:
+        return components * 2;
+    case GL_INT:
+    case GL_UNSIGNED_INT:
+    case GL_FLOAT:
+        return components * 4;
+    default:
+        return components;
+    }
+}
+
+static std::uint64_t
+getTextureBytes(GLsizei width, GLsizei height, GLsizei depth, GLenum format, GLenum type, const void *pixels) noexcept
+{
+    if (nullptr == pixels || width <= 0 || height <= 0 || depth <= 0) {
+        return 0;
+    }
+    return static_cast<std::uint64_t>(width) * static_cast<std::uint64_t>(height) * static_cast<std::uint64_t>(depth) * getTexelSize(format, type);
+}
+
+/* Upload and draw entry points also feed the byte and primitive counters, they wrap the counting wrappers */
+static PFNGLBUFFERDATAPROC next_buffer_data = nullptr;
+static PFNGLBUFFERSUBDATAPROC next_buffer_sub_data = nullptr;
+static PFNGLMAPBUFFERRANGEPROC next_map_buffer_range = nullptr;
+static PFNGLTEXIMAGE2DPROC next_tex_image_2d = nullptr;
+static PFNGLTEXSUBIMAGE2DPROC next_tex_sub_image_2d = nullptr;
+static PFNGLTEXIMAGE3DPROC next_tex_image_3d = nullptr;
+static PFNGLTEXSUBIMAGE3DPROC next_tex_sub_image_3d = nullptr;
+static PFNGLDRAWARRAYSPROC next_draw_arrays = nullptr;
+static PFNGLDRAWARRAYSINSTANCEDPROC next_draw_arrays_instanced = nullptr;
+static PFNGLDRAWELEMENTSPROC next_draw_elements = nullptr;
+static PFNGLDRAWELEMENTSBASEVERTEXPROC next_draw_elements_base_vertex = nullptr;
+static PFNGLDRAWELEMENTSINSTANCEDPROC next_draw_elements_instanced = nullptr;
+static PFNGLDRAWELEMENTSINSTANCEDBASEVERTEXPROC next_draw_elements_instanced_base_vertex = nullptr;
+static PFNGLDRAWRANGEELEMENTSPROC next_draw_range_elements = nullptr;
+static PFNGLDRAWRANGEELEMENTSBASEVERTEXPROC next_draw_range_elements_base_vertex = nullptr;
+
+static std::uint64_t
+toCount(GLsizei count) noexcept
+{
+    return count > 0 ? static_cast<std::uint64_t>(count) : 0;
+}
+
+static void APIENTRY
+traceBufferData(GLenum target, GLsizeiptr size, const void *data, GLenum usage)
+{
+    if (nullptr != data && size > 0) {
+        Tracer::getInstance().countBufferBytes(static_cast<std::uint64_t>(size));
+    }
+    next_buffer_data(target, size, data, usage);
+}
+
+static void APIENTRY
+traceBufferSubData(GLenum target, GLintptr offset, GLsizeiptr size, const void *data)
+{
+    if (size > 0) {
+        Tracer::getInstance().countBufferBytes(static_cast<std::uint64_t>(size));
+    }
+    next_buffer_sub_data(target, offset, size, data);
+}
+
+static void *APIENTRY
+traceMapBufferRange(GLenum target, GLintptr offset, GLsizeiptr length, GLbitfield access)
+{
+    if (0 != (access & GL_MAP_WRITE_BIT) && length > 0) {
+        Tracer::getInstance().countBufferBytes(static_cast<std::uint64_t>(length));
+    }
+    return next_map_buffer_range(target, offset, length, access);
+}
+
+static void APIENTRY
+traceTexImage2D(GLenum target, GLint level, GLint internal_format, GLsizei width, GLsizei height, GLint border, GLenum format, GLenum type,
+                const void *pixels)
+{
+    Tracer::getInstance().countTextureBytes(getTextureBytes(width, height, 1, format, type, pixels));
+    next_tex_image_2d(target, level, internal_format, width, height, border, format, type, pixels);
+}
+
+static void APIENTRY
+traceTexSubImage2D(GLenum target, GLint level, GLint x, GLint y, GLsizei width, GLsizei height, GLenum format, GLenum type, const void *pixels)
+{
+    Tracer::getInstance().countTextureBytes(getTextureBytes(width, height, 1, format, type, pixels));
+    next_tex_sub_image_2d(target, level, x, y, width, height, format, type, pixels);
+}
+
+static void APIENTRY
+traceTexImage3D(GLenum target, GLint level, GLint internal_format, GLsizei width, GLsizei height, GLsizei depth, GLint border, GLenum format,
+                GLenum type, const void *pixels)
+{
+    Tracer::getInstance().countTextureBytes(getTextureBytes(width, height, depth, format, type, pixels));
+    next_tex_image_3d(target, level, internal_format, width, height, depth, border, format, type, pixels);
+}
+
+static void APIENTRY
+traceTexSubImage3D(GLenum target, GLint level, GLint x, GLint y, GLint z, GLsizei width, GLsizei height, GLsizei depth, GLenum format,
+                   GLenum type, const void *pixels)
+{
+    Tracer::getInstance().countTextureBytes(getTextureBytes(width, height, depth, format, type, pixels));
+    next_tex_sub_image_3d(target, level, x, y, z, width, height, depth, format, type, pixels);
+}
+
+static void APIENTRY
+traceDrawArrays(GLenum mode, GLint first, GLsizei count)
+{
+    Tracer::getInstance().countDraw(mode, toCount(count));
+    next_draw_arrays(mode, first, count);
+}
+
+static void APIENTRY
+traceDrawArraysInstanced(GLenum mode, GLint first, GLsizei count, GLsizei instances)
+{
+    Tracer::getInstance().countDraw(mode, toCount(count) * toCount(instances));
+    next_draw_arrays_instanced(mode, first, count, instances);
+}
+
+static void APIENTRY
+traceDrawElements(GLenum mode, GLsizei count, GLenum type, const void *indices)
+{
+    Tracer::getInstance().countDraw(mode, toCount(count));
+    next_draw_elements(mode, count, type, indices);
+}
+
+static void APIENTRY
+traceDrawElementsBaseVertex(GLenum mode, GLsizei count, GLenum type, const void *indices, GLint base_vertex)
+{
+    Tracer::getInstance().countDraw(mode, toCount(count));
+    next_draw_elements_base_vertex(mode, count, type, indices, base_vertex);
+}
+
+static void APIENTRY
+traceDrawElementsInstanced(GLenum mode, GLsizei count, GLenum type, const void *indices, GLsizei instances)
+{
+    Tracer::getInstance().countDraw(mode, toCount(count) * toCount(instances));
+    next_draw_elements_instanced(mode, count, type, indices, instances);
+}
+
+static void APIENTRY
+traceDrawElementsInstancedBaseVertex(GLenum mode, GLsizei count, GLenum type, const void *indices, GLsizei instances, GLint base_vertex)
+{
+    Tracer::getInstance().countDraw(mode, toCount(count) * toCount(instances));
+    next_draw_elements_instanced_base_vertex(mode, count, type, indices, instances, base_vertex);
+}
+
+static void APIENTRY
+traceDrawRangeElements(GLenum mode, GLuint start, GLuint end, GLsizei count, GLenum type, const void *indices)
+{
+    Tracer::getInstance().countDraw(mode, toCount(count));
+    next_draw_range_elements(mode, start, end, count, type, indices);
+}
+
+static void APIENTRY
+traceDrawRangeElementsBaseVertex(GLenum mode, GLuint start, GLuint end, GLsizei count, GLenum type, const void *indices, GLint base_vertex)
+{
+    Tracer::getInstance().countDraw(mode, toCount(count));
+    next_draw_range_elements_base_vertex(mode, start, end, count, type, indices, base_vertex);
+}
+
+template <class Function>
+static void
+installHook(Function &pointer, Function &next, Function hook) noexcept
+{
+    if (nullptr != pointer) {
+        next = pointer;
+        pointer = hook;
+    }
+}
+
+Tracer &
+Tracer::getInstance(void)
+{
+    static Tracer tracer{};
+    return tracer;
+}
+
+void
+Tracer::install(void) noexcept
+{
+    static_assert(ENTRY_POINT_COUNT <= MAX_ENTRY_POINTS, "Not enough call counters for every entry point.");
+    if (is_installed) {
+        return;
+    }
+
+#define GLTRACE_INSTALL(name) installCounter<name##_INDEX>(glad_##name);
+    GLTRACE_ENTRY_POINTS(GLTRACE_INSTALL)
+#undef GLTRACE_INSTALL
+
+    installHook(glad_glBufferData, next_buffer_data, traceBufferData);
+    installHook(glad_glBufferSubData, next_buffer_sub_data, traceBufferSubData);
+    installHook(glad_glMapBufferRange, next_map_buffer_range, traceMapBufferRange);
+    installHook(glad_glTexImage2D, next_tex_image_2d, traceTexImage2D);
+    installHook(glad_glTexSubImage2D, next_tex_sub_image_2d, traceTexSubImage2D);
+    installHook(glad_glTexImage3D, next_tex_image_3d, traceTexImage3D);
+    installHook(glad_glTexSubImage3D, next_tex_sub_image_3d, traceTexSubImage3D);
+    installHook(glad_glDrawArrays, next_draw_arrays, traceDrawArrays);
+    installHook(glad_glDrawArraysInstanced, next_draw_arrays_instanced, traceDrawArraysInstanced);
+    installHook(glad_glDrawElements, next_draw_elements, traceDrawElements);
+    installHook(glad_glDrawElementsBaseVertex, next_draw_elements_base_vertex, traceDrawElementsBaseVertex);
+    installHook(glad_glDrawElementsInstanced, next_draw_elements_instanced, traceDrawElementsInstanced);
+    installHook(glad_glDrawElementsInstancedBaseVertex, next_draw_elements_instanced_base_vertex, traceDrawElementsInstancedBaseVertex);
+    installHook(glad_glDrawRangeElements, next_draw_range_elements, traceDrawRangeElements);
+    installHook(glad_glDrawRangeElementsBaseVertex, next_draw_range_elements_base_vertex, traceDrawRangeElementsBaseVertex);
+    is_installed = true;
+}
+
+bool
+Tracer::isInstalled(void) const noexcept
+{
+    return is_installed;
+}
+
+void
+Tracer::countCall(std::size_t entry_point) noexcept
+{
+    call_counts[entry_point].fetch_add(1, std::memory_order_relaxed);
+}
+
+void
+Tracer::countDraw(GLenum mode, std::uint64_t vertices) noexcept
+{
+    std::uint64_t count = 0;
+    switch (mode) {
+    case GL_POINTS:
+        count = vertices;
+        break;
+    case GL_LINES:
+        count = vertices / 2;
+        break;
+    case GL_LINE_STRIP:
+    case GL_LINE_LOOP:
+        count = vertices > 1 ? vertices - (GL_LINE_STRIP == mode ? 1 : 0) : 0;
+        break;
+    case GL_TRIANGLES:
+        count = vertices / 3;
+        break;
+    case GL_TRIANGLE_STRIP:
+    case GL_TRIANGLE_FAN:
+        count = vertices > 2 ? vertices - 2 : 0;
+        break;
+    default:
+        break;
+    }
+    draws.fetch_add(1, std::memory_order_relaxed);
+    primitives.fetch_add(count, std::memory_order_relaxed);
+}
+
+void
+Tracer::countBufferBytes(std::uint64_t bytes) noexcept
+{
+    buffer_bytes.fetch_add(bytes, std::memory_order_relaxed);
+}
+
+void
+Tracer::countTextureBytes(std::uint64_t bytes) noexcept
+{
+    texture_bytes.fetch_add(bytes, std::memory_order_relaxed);
+}
+
+void
+Tracer::endFrame(void)
+{
+    if (!is_installed) {
+        return;
+    }
+
+    FrameStats frame{0, 0, 0, 0, 0, 0, 0};
+    std::vector<std::pair<std::uint16_t, std::uint32_t>> calls{};
+    for (std::size_t entry_point = 0; entry_point < ENTRY_POINT_COUNT; ++entry_point) {
+        const std::uint64_t count = call_counts[entry_point].exchange(0, std::memory_order_relaxed);
+        if (0 == count) {
+            continue;
+        }
+        calls.emplace_back(static_cast<std::uint16_t>(entry_point), static_cast<std::uint32_t>(std::min<std::uint64_t>(count, UINT32_MAX)));
+        total_calls[entry_point] += count;
+        frame.calls += count;
+        const std::string_view name = ENTRY_POINT_NAMES[entry_point];
+        if (name.starts_with("glUniform")) {
+            frame.uniform_updates += count;
+        } else if (isStateChange(name)) {
+            frame.state_changes += count;
+        }
+    }
+    frame.draws = draws.exchange(0, std::memory_order_relaxed);
+    frame.primitives = primitives.exchange(0, std::memory_order_relaxed);
+    frame.buffer_bytes = buffer_bytes.exchange(0, std::memory_order_relaxed);
+    frame.texture_bytes = texture_bytes.exchange(0, std::memory_order_relaxed);
+    frames.push_back(frame);
+    frame_calls.push_back(std::move(calls));
+}
+
+void
+Tracer::writeTimeline(const std::filesystem::path &file_path) const
+{
+    std::ofstream stream{file_path, std::ios::out | std::ios::trunc};
+    if (!stream.is_open()) {
+        fmt::print(stderr, "writeTimeline: Failed to open file {}.\n", file_path.string());
+        return;
+    }
+
+    if (".json" != file_path.extension()) {
+        stream << "frame,calls,draws,primitives,state_changes,uniform_updates,buffer_bytes,texture_bytes\n";
+        for (std::size_t i = 0; i < frames.size(); ++i) {
+            const FrameStats &frame = frames[i];
+            stream << fmt::format("{},{},{},{},{},{},{},{}\n", i, frame.calls, frame.draws, frame.primitives, frame.state_changes, frame.uniform_updates,
+                                  frame.buffer_bytes, frame.texture_bytes);
+        }
+        return;
+    }
+
+    stream << "[\n";
+    for (std::size_t i = 0; i < frames.size(); ++i) {
+        const FrameStats &frame = frames[i];
+        stream << fmt::format("  {{\"frame\": {}, \"calls\": {}, \"draws\": {}, \"primitives\": {}, \"state_changes\": {}, \"uniform_updates\": {}, "
+                              "\"buffer_bytes\": {}, \"texture_bytes\": {}, \"entry_points\": {{",
+                              i, frame.calls, frame.draws, frame.primitives, frame.state_changes, frame.uniform_updates, frame.buffer_bytes,
+                              frame.texture_bytes);
+        const char *separator = "";
+        for (const auto &[entry_point, count] : frame_calls[i]) {
+            stream << fmt::format("{}\"{}\": {}", separator, ENTRY_POINT_NAMES[entry_point], count);
+            separator = ", ";
+        }
+        stream << (i + 1 < frames.size() ? "}},\n" : "}}\n");
+    }
+    stream << "]\n";
+}
+
+void
+Tracer::printSummary(void) const
+{
+    if (frames.empty()) {
+        return;
+    }
+
+    FrameStats total{0, 0, 0, 0, 0, 0, 0};
+    for (const FrameStats &frame : frames) {
+        total.calls += frame.calls;
+        total.draws += frame.draws;
+        total.primitives += frame.primitives;
+        total.state_changes += frame.state_changes;
+        total.uniform_updates += frame.uniform_updates;
+        total.buffer_bytes += frame.buffer_bytes;
+        total.texture_bytes += frame.texture_bytes;
+    }
+    const auto count = static_cast<double>(frames.size());
+    fmt::print("GL trace over {} frames, per frame:\n", frames.size());
+    fmt::print("  {:<16} {:>12.1f}\n", "calls", static_cast<double>(total.calls) / count);
+    fmt::print("  {:<16} {:>12.1f}\n", "draws", static_cast<double>(total.draws) / count);
+    fmt::print("  {:<16} {:>12.1f}\n", "primitives", static_cast<double>(total.primitives) / count);
+    fmt::print("  {:<16} {:>12.1f}\n", "state changes", static_cast<double>(total.state_changes) / count);
+    fmt::print("  {:<16} {:>12.1f}\n", "uniform updates", static_cast<double>(total.uniform_updates) / count);
+    fmt::print("  {:<16} {:>12.1f}\n", "buffer bytes", static_cast<double>(total.buffer_bytes) / count);
+    fmt::print("  {:<16} {:>12.1f}\n", "texture bytes", static_cast<double>(total.texture_bytes) / count);
+
+    static constexpr std::size_t TOP_COUNT{10};
+    std::vector<std::size_t> order(ENTRY_POINT_COUNT);
+    std::iota(order.begin(), order.end(), std::size_t{0});
+    const std::size_t shown = std::min(TOP_COUNT, order.size());
+    std::partial_sort(order.begin(), order.begin() + static_cast<std::ptrdiff_t>(shown), order.end(),
+                      [this](std::size_t lhs, std::size_t rhs) { return total_calls[lhs] > total_calls[rhs]; });
+    fmt::print("Most called entry points:\n");
+    for (std::size_t i = 0; i < shown && 0 != total_calls[order[i]]; ++i) {
+        fmt::print("  {:<32} {:>12}\n", ENTRY_POINT_NAMES[order[i]], total_calls[order[i]]);
+    }
+}
+
+const std::vector<FrameStats> &
+Tracer::getFrames(void) const noexcept
+{
+    return frames;
+}
+
+}; // namespace GlTrace
@@ -0,0 +1,78 @@
+#ifndef GLTRACE_HPP
+#define GLTRACE_HPP
+
+#include <glad/glad.h>
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace GlTrace
+{
+
+struct FrameStats
+{
+    std::uint64_t calls, draws, primitives, state_changes, uniform_updates;
+    /* Bytes handed to buffer and texture uploads, mapped ranges included */
+    std::uint64_t buffer_bytes, texture_bytes;
+};
+
+/*
+ * Counts the GL calls of every frame by swapping glad's function pointers for counting wrappers.
+ * Nothing is swapped until install() is called, so a disabled tracer costs nothing.
+ */
+class Tracer
+{
+  public:
+    static Tracer &getInstance(void);
+
+    /* Wrap every loaded entry point, call once after glad has loaded them */
+    void install(void) noexcept;
+    bool isInstalled(void) const noexcept;
+
+    /* Close the current frame and start counting the next one */
+    void endFrame(void);
+
+    /* JSON when the extension is .json, CSV otherwise */
+    void writeTimeline(const std::filesystem::path &file_path) const;
+    void printSummary(void) const;
+
+    const std::vector<FrameStats> &getFrames(void) const noexcept;
+
+    /* Used by the wrappers */
+    void countCall(std::size_t entry_point) noexcept;
+    void countDraw(GLenum mode, std::uint64_t vertices) noexcept;
+    void countBufferBytes(std::uint64_t bytes) noexcept;
+    void countTextureBytes(std::uint64_t bytes) noexcept;
+
+    Tracer(const Tracer &) = delete;
+    Tracer(Tracer &&) = delete;
+    Tracer &operator=(const Tracer &) = delete;
+    Tracer &operator=(Tracer &&) = delete;
+
+  private:
+    Tracer(void) = default;
+    ~Tracer() = default;
+
+    static constexpr std::size_t MAX_ENTRY_POINTS{512};
+
+    bool is_installed = false;
+    /* Updated from any thread with a current context, read when closing a frame */
+    std::array<std::atomic<std::uint64_t>, MAX_ENTRY_POINTS> call_counts{};
+    std::atomic<std::uint64_t> draws{0}, primitives{0}, buffer_bytes{0}, texture_bytes{0};
+
+    std::vector<FrameStats> frames{};
+    /* Entry point and call count of the entry points used in each frame */
+    std::vector<std::vector<std::pair<std::uint16_t, std::uint32_t>>> frame_calls{};
+    std::array<std::uint64_t, MAX_ENTRY_POINTS> total_calls{};
+};
+
+std::string_view getEntryPointName(std::size_t entry_point) noexcept;
+
+}; // namespace GlTrace
+#endif
@@ -0,0 +1,197 @@
+#include "HotReload.hpp"
+
+#include <fmt/core.h>
+
+#include <algorithm>
+#include <array>
+
+#ifdef __linux__
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+namespace HotReload
+{
+
+static std::filesystem::path getCanonicalPath(const std::filesystem::path &file_path);
+
+FileWatcher::FileWatcher(void) noexcept
+{
+#ifdef __linux__
+    descriptor = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (0 > descriptor) {
+        fmt::print(stderr, "FileWatcher: {}\n", "Failed to initialise inotify, files will not be watched.");
+    }
+#else
+    fmt::print(stderr, "FileWatcher: {}\n", "Files can only be watched on Linux.");
+#endif
+}
+
+FileWatcher::~FileWatcher() noexcept
+{
+#ifdef __linux__
+    if (0 <= descriptor) {
+        close(descriptor);
+    }
+#endif
+}
+
+bool
+FileWatcher::isOpen(void) const noexcept
+{
+    return 0 <= descriptor;
+}
+
+void
+FileWatcher::watch(const std::filesystem::path &file_path)
+{
+    if (!isOpen()) {
+        return;
+    }
+#ifdef __linux__
+    const std::filesystem::path canonical_path = getCanonicalPath(file_path);
+    if (!files.insert(canonical_path.string()).second) {
+        return;
+    }
+    const std::filesystem::path directory = canonical_path.parent_path();
+    /* Watching a directory twice returns the same descriptor */
+    const int watch_descriptor = inotify_add_watch(descriptor, directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO);
+    if (0 > watch_descriptor) {
+        fmt::print(stderr, "FileWatcher::watch: Failed to watch directory {}.\n", directory.string());
+        return;
+    }
+    directories[watch_descriptor] = directory;
+#endif
+}
+
+std::vector<std::filesystem::path>
+FileWatcher::poll(void)
+{
+    std::vector<std::filesystem::path> changed{};
+#ifdef __linux__
+    if (!isOpen()) {
+        return changed;
+    }
+    alignas(inotify_event) std::array<char, 4096> buffer{};
+    while (true) {
+        const ssize_t length = read(descriptor, buffer.data(), buffer.size());
+        if (0 >= length) {
+            break;
+        }
+        for (ssize_t offset = 0; offset < length;) {
+            const auto *event = reinterpret_cast<const inotify_event *>(buffer.data() + offset);
+            offset += static_cast<ssize_t>(sizeof(inotify_event) + event->len);
+            const auto directory = directories.find(event->wd);
+            if (0 == event->len || directories.end() == directory) {
+                continue;
+            }
+            std::filesystem::path file_path = directory->second / event->name;
+            /* Only the files asked for, several events for one file are reported once */
+            if (files.contains(file_path.string()) && std::find(changed.begin(), changed.end(), file_path) == changed.end()) {
+                changed.push_back(std::move(file_path));
+            }
+        }
+    }
+#endif
+    return changed;
+}
+
+Reloader &
+Reloader::getInstance(void)
+{
+    static Reloader reloader{};
+    return reloader;
+}
+
+void
+Reloader::enable(Loader::BackgroundLoader &background_loader)
+{
+    loader = &background_loader;
+    if (nullptr == watcher) {
+        watcher = std::make_unique<FileWatcher>();
+    }
+}
+
+void
+Reloader::disable(void) noexcept
+{
+    loader = nullptr;
+}
+
+bool
+Reloader::isEnabled(void) const noexcept
+{
+    return nullptr != loader;
+}
+
+void
+Reloader::watch(const std::filesystem::path &file_path)
+{
+    if (isEnabled()) {
+        watcher->watch(file_path);
+    }
+}
+
+bool
+Reloader::poll(void)
+{
+    if (!isEnabled()) {
+        return false;
+    }
+    const std::vector<std::filesystem::path> changed = watcher->poll();
+    for (const std::filesystem::path &file_path : changed) {
+        ++versions[file_path.string()];
+        ++generation;
+        fmt::print("Reloader: {} changed.\n", file_path.string());
+    }
+    return !changed.empty();
+}
+
+void
+Reloader::reloadStarted(void) noexcept
+{
+    ++pending_reloads;
+}
+
+void
+Reloader::reloadFinished(void) noexcept
+{
+    if (0 < pending_reloads) {
+        --pending_reloads;
+    }
+}
+
+bool
+Reloader::isReloading(void) const noexcept
+{
+    return 0 < pending_reloads;
+}
+
+std::uint64_t
+Reloader::getGeneration(void) const noexcept
+{
+    return generation;
+}
+
+std::uint64_t
+Reloader::getVersion(const std::filesystem::path &file_path) const
+{
+    const auto version = versions.find(getCanonicalPath(file_path).string());
+    return versions.end() == version ? 0 : version->second;
+}
+
+Loader::BackgroundLoader *
+Reloader::getLoader(void) const noexcept
+{
+    return loader;
+}
+
+static std::filesystem::path
+getCanonicalPath(const std::filesystem::path &file_path)
+{
+    std::error_code error{};
+    std::filesystem::path canonical_path = std::filesystem::weakly_canonical(file_path, error);
+    return error ? file_path : canonical_path;
+}
+
+}; // namespace HotReload
@@ -0,0 +1,93 @@
+#ifndef HOTRELOAD_HPP
+#define HOTRELOAD_HPP
+
+#include "Loader.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace HotReload
+{
+
+/*
+ * Reports the watched files written since the last poll, with inotify on Linux and never elsewhere.
+ * Directories are watched rather than files so that editors replacing a file by renaming a new one over it are seen.
+ */
+class FileWatcher
+{
+  public:
+    FileWatcher(void) noexcept;
+    ~FileWatcher() noexcept;
+
+    FileWatcher(const FileWatcher &) = delete;
+    FileWatcher(FileWatcher &&) = delete;
+    FileWatcher &operator=(const FileWatcher &) = delete;
+    FileWatcher &operator=(FileWatcher &&) = delete;
+
+    bool isOpen(void) const noexcept;
+    void watch(const std::filesystem::path &file_path);
+
+    /* Never blocks, the paths are canonical */
+    std::vector<std::filesystem::path> poll(void);
+
+  private:
+    int descriptor = -1;
+    /* Watch descriptor to canonical directory */
+    std::unordered_map<int, std::filesystem::path> directories{};
+    std::unordered_set<std::string> files{};
+};
+
+/*
+ * Tracks how many times every watched file changed so that shaders can tell when to recompile, and hands them the
+ * loader their compiles run on so that the frame loop never waits for the driver.
+ * Disabled until enable() is called, shaders created before are never reloaded.
+ */
+class Reloader
+{
+  public:
+    static Reloader &getInstance(void);
+
+    void enable(Loader::BackgroundLoader &background_loader);
+    /* Before the loader goes away */
+    void disable(void) noexcept;
+    bool isEnabled(void) const noexcept;
+
+    void watch(const std::filesystem::path &file_path);
+    /* Once per frame, counts the changes seen since the last call and tells whether there were any */
+    bool poll(void);
+
+    /* Compiles submitted by shaders and not yet swapped in, the frame loop keeps rendering until they are */
+    void reloadStarted(void) noexcept;
+    void reloadFinished(void) noexcept;
+    bool isReloading(void) const noexcept;
+
+    /* Changes of any file so far, cheap enough to compare on every use of a shader */
+    std::uint64_t getGeneration(void) const noexcept;
+    /* Changes of one file so far */
+    std::uint64_t getVersion(const std::filesystem::path &file_path) const;
+    Loader::BackgroundLoader *getLoader(void) const noexcept;
+
+    Reloader(const Reloader &) = delete;
+    Reloader(Reloader &&) = delete;
+    Reloader &operator=(const Reloader &) = delete;
+    Reloader &operator=(Reloader &&) = delete;
+
+  private:
+    Reloader(void) = default;
+    ~Reloader() = default;
+
+    Loader::BackgroundLoader *loader = nullptr;
+    std::unique_ptr<FileWatcher> watcher = nullptr;
+    std::uint64_t generation = 0;
+    std::size_t pending_reloads = 0;
+    std::unordered_map<std::string, std::uint64_t> versions{};
+};
+
+}; // namespace HotReload
+#endif
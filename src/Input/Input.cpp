@@ -0,0 +1,369 @@
+#include "Input.hpp"
+
+#include <fmt/core.h>
+
+#include <algorithm>
+#include <array>
+#include <iterator>
+
+namespace Input
+{
+
+void
+InputSystem::attach(GLFWwindow *window) noexcept
+{
+    glfwSetWindowUserPointer(window, this);
+    glfwSetKeyCallback(window, keyCallback);
+    glfwSetMouseButtonCallback(window, mouseButtonCallback);
+    glfwSetCursorPosCallback(window, cursorPositionCallback);
+    glfwSetScrollCallback(window, scrollCallback);
+}
+
+void
+InputSystem::bind(ActionId action, int key) noexcept
+{
+    if (action < MAX_ACTIONS && key >= 0 && static_cast<std::size_t>(key) < KEY_COUNT) {
+        key_bindings[static_cast<std::size_t>(key)] = action;
+    }
+}
+
+void
+InputSystem::bind(std::initializer_list<Binding> bindings) noexcept
+{
+    for (const Binding &binding : bindings) {
+        bind(binding.action, binding.key);
+    }
+}
+
+void
+InputSystem::bindMouseButton(ActionId action, int button) noexcept
+{
+    if (action < MAX_ACTIONS && button >= 0 && static_cast<std::size_t>(button) < MOUSE_BUTTON_COUNT) {
+        mouse_bindings[static_cast<std::size_t>(button)] = action;
+    }
+}
+
+void
+InputSystem::pushEvent(const Event &event) noexcept
+{
+    if (!queue.push(event)) {
+        ++dropped_events;
+    }
+}
+
+void
+InputSystem::update(void) noexcept
+{
+    for (ActionId action : edged_actions) {
+        actions[action].pressed = false;
+        actions[action].released = false;
+    }
+    edged_actions.clear();
+    frame_events.clear();
+    scroll_offset = 0.0;
+
+    Event event;
+    while (queue.pop(event)) {
+        frame_events.push_back(event);
+        switch (event.type) {
+        case EventType::KEY:
+            if (event.code >= 0 && static_cast<std::size_t>(event.code) < KEY_COUNT) {
+                applyButton(key_bindings[static_cast<std::size_t>(event.code)], event.action);
+            }
+            break;
+        case EventType::MOUSE_BUTTON:
+            if (event.code >= 0 && static_cast<std::size_t>(event.code) < MOUSE_BUTTON_COUNT) {
+                applyButton(mouse_bindings[static_cast<std::size_t>(event.code)], event.action);
+            }
+            break;
+        case EventType::CURSOR:
+            cursor_x = event.x;
+            cursor_y = event.y;
+            break;
+        case EventType::SCROLL:
+            scroll_offset += event.y;
+            break;
+        }
+    }
+}
+
+void
+InputSystem::applyButton(ActionId action, int glfw_action) noexcept
+{
+    /* Repeats do not change the state of an action that is already held */
+    if (NO_ACTION == action || GLFW_REPEAT == glfw_action) {
+        return;
+    }
+    ActionState &state = actions[action];
+    if (GLFW_PRESS == glfw_action) {
+        if (0 == state.held_count++) {
+            state.pressed = true;
+            edged_actions.push_back(action);
+        }
+    } else if (0 != state.held_count) {
+        if (0 == --state.held_count) {
+            state.released = true;
+            edged_actions.push_back(action);
+        }
+    }
+}
+
+bool
+InputSystem::isDown(ActionId action) const noexcept
+{
+    return action < MAX_ACTIONS && 0 != actions[action].held_count;
+}
+
+bool
+InputSystem::isAnyDown(void) const noexcept
+{
+    return std::any_of(actions.begin(), actions.end(), [](const ActionState &state) { return 0 != state.held_count; });
+}
+
+bool
+InputSystem::wasPressed(ActionId action) const noexcept
+{
+    return action < MAX_ACTIONS && actions[action].pressed;
+}
+
+bool
+InputSystem::wasReleased(ActionId action) const noexcept
+{
+    return action < MAX_ACTIONS && actions[action].released;
+}
+
+double
+InputSystem::getCursorX(void) const noexcept
+{
+    return cursor_x;
+}
+
+double
+InputSystem::getCursorY(void) const noexcept
+{
+    return cursor_y;
+}
+
+double
+InputSystem::getScrollOffset(void) const noexcept
+{
+    return scroll_offset;
+}
+
+const std::vector<Event> &
+InputSystem::getFrameEvents(void) const noexcept
+{
+    return frame_events;
+}
+
+void
+InputSystem::notifyPresented(double present_time) noexcept
+{
+    if (const std::optional<double> oldest_event = getOldestEventTime()) {
+        recordLatency(*oldest_event, present_time);
+    }
+}
+
+std::optional<double>
+InputSystem::getOldestEventTime(void) const noexcept
+{
+    if (frame_events.empty()) {
+        return std::nullopt;
+    }
+    return std::min_element(frame_events.begin(), frame_events.end(), [](const Event &lhs, const Event &rhs) {
+               return lhs.timestamp < rhs.timestamp;
+           })->timestamp;
+}
+
+void
+InputSystem::recordLatency(double event_time, double present_time) noexcept
+{
+    latency.last = present_time - event_time;
+    latency.max = std::max(latency.max, latency.last);
+    ++latency.samples;
+    latency.average += (latency.last - latency.average) / static_cast<double>(latency.samples);
+}
+
+const LatencyStats &
+InputSystem::getLatencyStats(void) const noexcept
+{
+    return latency;
+}
+
+std::uint64_t
+InputSystem::getDroppedEventCount(void) const noexcept
+{
+    return dropped_events;
+}
+
+void
+InputSystem::keyCallback(GLFWwindow *window, int key, int, int action, int)
+{
+    auto *input = static_cast<InputSystem *>(glfwGetWindowUserPointer(window));
+    input->pushEvent({glfwGetTime(), EventType::KEY, action, key, 0.0, 0.0});
+}
+
+void
+InputSystem::mouseButtonCallback(GLFWwindow *window, int button, int action, int)
+{
+    auto *input = static_cast<InputSystem *>(glfwGetWindowUserPointer(window));
+    input->pushEvent({glfwGetTime(), EventType::MOUSE_BUTTON, action, button, 0.0, 0.0});
+}
+
+void
+InputSystem::cursorPositionCallback(GLFWwindow *window, double x, double y)
+{
+    auto *input = static_cast<InputSystem *>(glfwGetWindowUserPointer(window));
+    input->pushEvent({glfwGetTime(), EventType::CURSOR, 0, 0, x, y});
+}
+
+void
+InputSystem::scrollCallback(GLFWwindow *window, double x, double y)
+{
+    auto *input = static_cast<InputSystem *>(glfwGetWindowUserPointer(window));
+    input->pushEvent({glfwGetTime(), EventType::SCROLL, 0, 0, x, y});
+}
+
+static constexpr std::array<char, 4> LOG_MAGIC{'G', 'L', 'I', 'R'};
+static constexpr std::uint32_t LOG_VERSION{1};
+
+template <class T>
+static void
+writeValue(std::ofstream &stream, const T &value)
+{
+    stream.write(reinterpret_cast<const char *>(&value), sizeof value);
+}
+
+template <class T>
+static bool
+readValue(const std::vector<char> &bytes, std::size_t &offset, T &value) noexcept
+{
+    if (bytes.size() - offset < sizeof value) {
+        return false;
+    }
+    std::copy_n(bytes.data() + offset, sizeof value, reinterpret_cast<char *>(&value));
+    offset += sizeof value;
+    return true;
+}
+
+InputRecorder::InputRecorder(const std::filesystem::path &file_path) : stream{file_path, std::ios::out | std::ios::binary | std::ios::trunc}
+{
+    if (!stream.is_open()) {
+        fmt::print(stderr, "InputRecorder: Failed to open file {}.\n", file_path.string());
+        return;
+    }
+    stream.write(LOG_MAGIC.data(), LOG_MAGIC.size());
+    writeValue(stream, LOG_VERSION);
+}
+
+bool
+InputRecorder::isOpen(void) const noexcept
+{
+    return stream.is_open();
+}
+
+void
+InputRecorder::recordFrame(double time, const std::vector<Event> &events)
+{
+    if (!stream.is_open()) {
+        return;
+    }
+    writeValue(stream, time);
+    writeValue(stream, static_cast<std::uint16_t>(std::min<std::size_t>(events.size(), UINT16_MAX)));
+    for (std::size_t i = 0; i < events.size() && i < UINT16_MAX; ++i) {
+        const Event &event = events[i];
+        writeValue(stream, static_cast<std::uint8_t>(event.type));
+        if (EventType::KEY == event.type || EventType::MOUSE_BUTTON == event.type) {
+            writeValue(stream, static_cast<std::int8_t>(event.action));
+            writeValue(stream, static_cast<std::int16_t>(event.code));
+        } else {
+            writeValue(stream, event.x);
+            writeValue(stream, event.y);
+        }
+    }
+}
+
+InputReplay::InputReplay(const std::filesystem::path &file_path)
+{
+    std::ifstream stream{file_path, std::ios::in | std::ios::binary};
+    if (!stream.is_open()) {
+        fmt::print(stderr, "InputReplay: Failed to open file {}.\n", file_path.string());
+        return;
+    }
+    const std::vector<char> bytes{std::istreambuf_iterator<char>{stream}, std::istreambuf_iterator<char>{}};
+
+    std::size_t offset = 0;
+    std::array<char, 4> magic{};
+    std::uint32_t version = 0;
+    if (!readValue(bytes, offset, magic) || LOG_MAGIC != magic || !readValue(bytes, offset, version) || LOG_VERSION != version) {
+        fmt::print(stderr, "InputReplay: {} is not an input log.\n", file_path.string());
+        return;
+    }
+
+    /* A truncated frame at the end, from a crashed recording for instance, is dropped */
+    double time = 0.0;
+    std::uint16_t event_count = 0;
+    while (readValue(bytes, offset, time) && readValue(bytes, offset, event_count)) {
+        /* The whole frame is queued before the update() consuming it, it has to fit in the queue */
+        if (event_count > InputSystem::QUEUE_CAPACITY) {
+            fmt::print(stderr, "InputReplay: frame {} of {} has {} events, more than the {} an update can take.\n", frames.size(),
+                       file_path.string(), event_count, InputSystem::QUEUE_CAPACITY);
+            return;
+        }
+        const std::size_t first_event = events.size();
+        bool is_complete = true;
+        for (std::uint16_t i = 0; i < event_count && is_complete; ++i) {
+            Event event{time, EventType::KEY, 0, 0, 0.0, 0.0};
+            std::uint8_t type = 0;
+            is_complete = readValue(bytes, offset, type);
+            if (!is_complete) {
+                break;
+            }
+            event.type = static_cast<EventType>(type);
+            if (EventType::KEY == event.type || EventType::MOUSE_BUTTON == event.type) {
+                std::int8_t action = 0;
+                std::int16_t code = 0;
+                is_complete = readValue(bytes, offset, action) && readValue(bytes, offset, code);
+                event.action = action;
+                event.code = code;
+            } else {
+                is_complete = readValue(bytes, offset, event.x) && readValue(bytes, offset, event.y);
+            }
+            events.push_back(event);
+        }
+        if (!is_complete) {
+            events.resize(first_event);
+            break;
+        }
+        frames.push_back({time, first_event, event_count});
+    }
+    is_open = true;
+}
+
+bool
+InputReplay::isOpen(void) const noexcept
+{
+    return is_open;
+}
+
+std::size_t
+InputReplay::getFrameCount(void) const noexcept
+{
+    return frames.size();
+}
+
+bool
+InputReplay::nextFrame(InputSystem &input, double &time) noexcept
+{
+    if (next_frame == frames.size()) {
+        return false;
+    }
+    const Frame &frame = frames[next_frame++];
+    for (std::size_t i = frame.first_event; i < frame.first_event + frame.event_count; ++i) {
+        input.pushEvent(events[i]);
+    }
+    time = frame.time;
+    return true;
+}
+
+}; // namespace Input
@@ -0,0 +1,226 @@
+#ifndef INPUT_HPP
+#define INPUT_HPP
+
+#include <GLFW/glfw3.h>
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <initializer_list>
+#include <optional>
+#include <vector>
+
+namespace Input
+{
+
+using ActionId = std::uint32_t;
+
+static constexpr ActionId NO_ACTION{UINT32_MAX};
+static constexpr std::size_t MAX_ACTIONS{64};
+
+enum class EventType : std::uint8_t
+{
+    KEY,
+    MOUSE_BUTTON,
+    CURSOR,
+    SCROLL
+};
+
+struct Event
+{
+    /* glfwGetTime() when the event was handed to us by glfwPollEvents() */
+    double timestamp;
+    EventType type;
+    /* GLFW_PRESS, GLFW_RELEASE or GLFW_REPEAT for keys and buttons */
+    int action;
+    /* Key or mouse button */
+    int code;
+    /* Cursor position or scroll offsets */
+    double x, y;
+};
+
+/* Single producer, single consumer ring buffer, push() and pop() never block nor allocate */
+template <class T, std::size_t Capacity>
+class EventRing
+{
+    static_assert(0 == (Capacity & (Capacity - 1)), "Capacity must be a power of two.");
+
+  public:
+    bool
+    push(const T &value) noexcept
+    {
+        const std::size_t tail = write_index.load(std::memory_order_relaxed);
+        if (tail - read_index.load(std::memory_order_acquire) == Capacity) {
+            return false;
+        }
+        slots[tail & (Capacity - 1)] = value;
+        write_index.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool
+    pop(T &value) noexcept
+    {
+        const std::size_t head = read_index.load(std::memory_order_relaxed);
+        if (head == write_index.load(std::memory_order_acquire)) {
+            return false;
+        }
+        value = slots[head & (Capacity - 1)];
+        read_index.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+  private:
+    std::array<T, Capacity> slots{};
+    alignas(64) std::atomic<std::size_t> write_index{0};
+    alignas(64) std::atomic<std::size_t> read_index{0};
+};
+
+struct Binding
+{
+    ActionId action;
+    int key;
+};
+
+struct LatencyStats
+{
+    /* Seconds between the oldest event consumed in a frame and that frame being presented */
+    double last, average, max;
+    std::uint64_t samples;
+};
+
+/*
+ * Keyboard and mouse input gathered through GLFW callbacks rather than polling.
+ * Events are queued as they arrive and turned into action states once per frame by update(),
+ * so the per-frame cost only depends on the number of events received.
+ */
+class InputSystem
+{
+  public:
+    /* Events that can wait for the next update(), more are counted as dropped */
+    static constexpr std::size_t QUEUE_CAPACITY{1024};
+
+    /* Install the callbacks, the window user pointer is taken over to reach this object */
+    void attach(GLFWwindow *window) noexcept;
+
+    void bind(ActionId action, int key) noexcept;
+    void bind(std::initializer_list<Binding> bindings) noexcept;
+    void bindMouseButton(ActionId action, int button) noexcept;
+
+    /* Drain the queued events and refresh the action states, call once per frame before querying */
+    void update(void) noexcept;
+
+    /* Hand an event to the input system as if it came from GLFW */
+    void pushEvent(const Event &event) noexcept;
+
+    /* Level query: is any key bound to the action held */
+    bool isDown(ActionId action) const noexcept;
+    /* Whether any bound action is held, its effect then keeps going between events */
+    bool isAnyDown(void) const noexcept;
+    /* Edge queries: did the action go down or up during the last update */
+    bool wasPressed(ActionId action) const noexcept;
+    bool wasReleased(ActionId action) const noexcept;
+
+    double getCursorX(void) const noexcept;
+    double getCursorY(void) const noexcept;
+    double getScrollOffset(void) const noexcept;
+
+    /* Events consumed by the last update() */
+    const std::vector<Event> &getFrameEvents(void) const noexcept;
+
+    /* Record that the frame built from the last update() has been presented at the given time */
+    void notifyPresented(double present_time) noexcept;
+    /* Timestamp of the oldest event consumed by the last update(), if any */
+    std::optional<double> getOldestEventTime(void) const noexcept;
+    /* Account for a frame presented later than the next update(), by a frame pacer for instance */
+    void recordLatency(double event_time, double present_time) noexcept;
+    const LatencyStats &getLatencyStats(void) const noexcept;
+    std::uint64_t getDroppedEventCount(void) const noexcept;
+
+  private:
+    static void keyCallback(GLFWwindow *window, int key, int scancode, int action, int mods);
+    static void mouseButtonCallback(GLFWwindow *window, int button, int action, int mods);
+    static void cursorPositionCallback(GLFWwindow *window, double x, double y);
+    static void scrollCallback(GLFWwindow *window, double x, double y);
+
+    void applyButton(ActionId action, int glfw_action) noexcept;
+
+    struct ActionState
+    {
+        /* Number of bound keys currently held */
+        std::uint8_t held_count;
+        bool pressed, released;
+    };
+
+    static constexpr std::size_t KEY_COUNT{GLFW_KEY_LAST + 1};
+    static constexpr std::size_t MOUSE_BUTTON_COUNT{GLFW_MOUSE_BUTTON_LAST + 1};
+
+    EventRing<Event, QUEUE_CAPACITY> queue{};
+    std::atomic<std::uint64_t> dropped_events{0};
+
+    std::array<ActionId, KEY_COUNT> key_bindings = [] {
+        std::array<ActionId, KEY_COUNT> bindings{};
+        bindings.fill(NO_ACTION);
+        return bindings;
+    }();
+    std::array<ActionId, MOUSE_BUTTON_COUNT> mouse_bindings = [] {
+        std::array<ActionId, MOUSE_BUTTON_COUNT> bindings{};
+        bindings.fill(NO_ACTION);
+        return bindings;
+    }();
+    std::array<ActionState, MAX_ACTIONS> actions{};
+    /* Actions whose edge flags were raised last update, so only those need clearing */
+    std::vector<ActionId> edged_actions{};
+    std::vector<Event> frame_events{};
+
+    double cursor_x = 0.0, cursor_y = 0.0, scroll_offset = 0.0;
+    LatencyStats latency{0.0, 0.0, 0.0, 0};
+};
+
+/*
+ * Input log: a header, then for every frame its time, the number of events and the events themselves.
+ * Keys and buttons take 4 bytes, cursor and scroll events 17, values are stored in native byte order.
+ */
+class InputRecorder
+{
+  public:
+    explicit InputRecorder(const std::filesystem::path &file_path);
+
+    bool isOpen(void) const noexcept;
+    /* Append the time of a frame and the events consumed by its update() */
+    void recordFrame(double time, const std::vector<Event> &events);
+
+  private:
+    std::ofstream stream{};
+};
+
+/* Plays an input log back, the whole log is read up front so replaying never touches the disk */
+class InputReplay
+{
+  public:
+    explicit InputReplay(const std::filesystem::path &file_path);
+
+    bool isOpen(void) const noexcept;
+    std::size_t getFrameCount(void) const noexcept;
+
+    /* Queue the events of the next frame into the input system and return its time, false once the log is over */
+    bool nextFrame(InputSystem &input, double &time) noexcept;
+
+  private:
+    struct Frame
+    {
+        double time;
+        std::size_t first_event, event_count;
+    };
+
+    std::vector<Frame> frames{};
+    std::vector<Event> events{};
+    std::size_t next_frame = 0;
+    bool is_open = false;
+};
+
+}; // namespace Input
+#endif
@@ -0,0 +1,119 @@
+#include "Loader.hpp"
+
+#include <fmt/core.h>
+
+namespace Loader
+{
+
+BackgroundLoader::BackgroundLoader(GLFWwindow *shared_window, bool synchronous)
+{
+    if (synchronous || nullptr == shared_window) {
+        return;
+    }
+
+    /* The hints of the main window are still set, only its visibility has to change */
+    glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+    context_window = glfwCreateWindow(1, 1, "Loader", nullptr, shared_window);
+    if (nullptr == context_window) {
+        fmt::print(stderr, "BackgroundLoader: {}\n", "Failed to create a shared context, loading on the main thread.");
+        return;
+    }
+    worker = std::jthread{[this](std::stop_token stop_token) { workerLoop(stop_token); }};
+}
+
+BackgroundLoader::~BackgroundLoader() noexcept
+{
+    if (worker.joinable()) {
+        worker.request_stop();
+        worker.join();
+    }
+    if (nullptr != context_window) {
+        glfwDestroyWindow(context_window);
+    }
+}
+
+bool
+BackgroundLoader::isBackground(void) const noexcept
+{
+    return nullptr != context_window;
+}
+
+std::size_t
+BackgroundLoader::getQueuedCount(void) const
+{
+    std::lock_guard lock{mutex};
+    return jobs.size();
+}
+
+void
+BackgroundLoader::enqueue(std::function<void(void)> job)
+{
+    if (!isBackground()) {
+        job();
+        return;
+    }
+    {
+        std::lock_guard lock{mutex};
+        jobs.push_back(std::move(job));
+    }
+    jobs_available.notify_one();
+}
+
+void
+BackgroundLoader::workerLoop(std::stop_token stop_token)
+{
+    glfwMakeContextCurrent(context_window);
+    while (true) {
+        std::function<void(void)> job{};
+        {
+            std::unique_lock lock{mutex};
+            jobs_available.wait(lock, stop_token, [this] { return !jobs.empty(); });
+            if (jobs.empty()) {
+                break;
+            }
+            job = std::move(jobs.front());
+            jobs.pop_front();
+        }
+        job();
+    }
+    glfwMakeContextCurrent(nullptr);
+}
+
+Pending<Resource::Texture>
+loadTexture(BackgroundLoader &loader, const std::filesystem::path &image_path, const TextureUpload::Options &options)
+{
+    return loader.submit([image_path, options] {
+        const std::shared_ptr<const Utils::Image> image = Utils::FileCache::getInstance().getImage(image_path);
+        /* Made evictable once collected, the render thread could delete it under the upload otherwise */
+        Resource::Texture texture = Resource::Texture::create();
+        TextureUpload::upload(texture, image->getImageData(), options);
+        return texture;
+    });
+}
+
+bool
+collect(Pending<Resource::Texture> &pending, Resource::Texture &target)
+{
+    if (!pending.isReady()) {
+        return false;
+    }
+    target = pending.take();
+    target.setEvictable(true);
+    return true;
+}
+
+bool
+refreshTexture(BackgroundLoader &loader, Pending<Resource::Texture> &pending, Resource::Texture &texture, const std::filesystem::path &image_path)
+{
+    collect(pending, texture);
+    if (texture.isResident()) {
+        texture.touch();
+        return true;
+    }
+    if (!pending.isValid()) {
+        pending = loadTexture(loader, image_path);
+    }
+    return false;
+}
+
+}; // namespace Loader
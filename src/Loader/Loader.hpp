@@ -0,0 +1,224 @@
+#ifndef LOADER_HPP
+#define LOADER_HPP
+
+#include <glad/glad.h>
+
+#include "Resource.hpp"
+#include "TextureUpload.hpp"
+#include "Utils.hpp"
+
+#include <GLFW/glfw3.h>
+
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <filesystem>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <stop_token>
+#include <thread>
+#include <type_traits>
+#include <utility>
+
+namespace Loader
+{
+
+template <class T>
+struct PendingState
+{
+    std::optional<T> value{};
+    GLsync fence = nullptr;
+    /* Set by the job once it has run or by Pending::reset giving up first, the second of them releases the result */
+    std::atomic<bool> is_done{false};
+};
+
+/* Delete the fence and the result with a context current, on whichever thread is last to hold them */
+template <class T>
+void
+releasePendingState(PendingState<T> &state) noexcept
+{
+    if (nullptr != state.fence) {
+        glDeleteSync(state.fence);
+        state.fence = nullptr;
+    }
+    state.value.reset();
+}
+
+/*
+ * Result of a background job, owned by the render thread.
+ * It becomes ready once the job has run and the GL commands it issued have completed,
+ * so the objects it created can be used straight away from the main context.
+ * Like resource handles, it must be reset or destroyed while the context is still current.
+ */
+template <class T>
+class Pending
+{
+  public:
+    Pending(void) noexcept = default;
+    explicit Pending(std::shared_ptr<PendingState<T>> pending_state) noexcept : state{std::move(pending_state)}
+    {
+    }
+
+    ~Pending() noexcept
+    {
+        reset();
+    }
+
+    Pending(Pending &&pending) noexcept : state{std::move(pending.state)}
+    {
+    }
+
+    Pending &
+    operator=(Pending &&pending) noexcept
+    {
+        if (this != &pending) {
+            reset();
+            state = std::move(pending.state);
+        }
+        return *this;
+    }
+
+    Pending(const Pending &) = delete;
+    Pending &operator=(const Pending &) = delete;
+
+    bool
+    isValid(void) const noexcept
+    {
+        return nullptr != state;
+    }
+
+    /* Never blocks, the fence is only polled */
+    bool
+    isReady(void) noexcept
+    {
+        if (nullptr == state || !state->is_done.load(std::memory_order_acquire)) {
+            return false;
+        }
+        if (nullptr != state->fence) {
+            const GLenum status = glClientWaitSync(state->fence, 0, 0);
+            if (GL_TIMEOUT_EXPIRED == status) {
+                return false;
+            }
+            glDeleteSync(state->fence);
+            state->fence = nullptr;
+        }
+        return true;
+    }
+
+    /* Only once ready, leaves the pending result invalid */
+    T
+    take(void)
+    {
+        T value = std::move(*state->value);
+        state.reset();
+        return value;
+    }
+
+    /* Give up on the result, it is released here when the job has already run and by the job otherwise */
+    void
+    reset(void) noexcept
+    {
+        if (nullptr == state) {
+            return;
+        }
+        if (state->is_done.exchange(true, std::memory_order_acq_rel)) {
+            releasePendingState(*state);
+        }
+        state.reset();
+    }
+
+  private:
+    std::shared_ptr<PendingState<T>> state = nullptr;
+};
+
+/*
+ * Runs uploads and shader compiles on a worker thread owning a hidden context shared with the main window.
+ * Buffers, textures, shaders and programs are shared between the contexts, vertex arrays and framebuffers are not
+ * and must still be created on the render thread.
+ * Without a shared context, when it cannot be created or with synchronous set, jobs run as soon as they are submitted.
+ */
+class BackgroundLoader
+{
+  public:
+    /* Must be called from the main thread, which GLFW requires to create windows */
+    explicit BackgroundLoader(GLFWwindow *shared_window, bool synchronous = false);
+    ~BackgroundLoader() noexcept;
+
+    BackgroundLoader(const BackgroundLoader &) = delete;
+    BackgroundLoader(BackgroundLoader &&) = delete;
+    BackgroundLoader &operator=(const BackgroundLoader &) = delete;
+    BackgroundLoader &operator=(BackgroundLoader &&) = delete;
+
+    template <class Function>
+    Pending<std::invoke_result_t<Function>>
+    submit(Function &&function)
+    {
+        using Result = std::invoke_result_t<Function>;
+        auto state = std::make_shared<PendingState<Result>>();
+        enqueue([state, job = std::forward<Function>(function)]() mutable {
+            state->value.emplace(job());
+            state->fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+            /* The fence has to reach the GPU for the other context to ever see it signal */
+            glFlush();
+            if (state->is_done.exchange(true, std::memory_order_acq_rel)) {
+                /* Nobody is waiting for the result anymore */
+                releasePendingState(*state);
+            }
+        });
+        return Pending<Result>{std::move(state)};
+    }
+
+    bool isBackground(void) const noexcept;
+    /* Jobs submitted and not yet run */
+    std::size_t getQueuedCount(void) const;
+
+  private:
+    void enqueue(std::function<void(void)> job);
+    void workerLoop(std::stop_token stop_token);
+
+    GLFWwindow *context_window = nullptr;
+
+    mutable std::mutex mutex{};
+    std::condition_variable_any jobs_available{};
+    std::deque<std::function<void(void)>> jobs{};
+    std::jthread worker{};
+};
+
+/* Decode and upload an image on the loader thread */
+Pending<Resource::Texture> loadTexture(BackgroundLoader &loader, const std::filesystem::path &image_path, const TextureUpload::Options &options = {});
+
+/*
+ * To be called every frame the texture is bound: collects it once loaded and marks it as used, or loads it again
+ * once the resource tracker evicted it. Returns whether it is resident, the owner keeps polling until then.
+ */
+bool refreshTexture(BackgroundLoader &loader, Pending<Resource::Texture> &pending, Resource::Texture &texture, const std::filesystem::path &image_path);
+
+/* Move the result into target once ready, to be polled every frame */
+template <class T>
+bool
+collect(Pending<T> &pending, T &target)
+{
+    if (!pending.isReady()) {
+        return false;
+    }
+    target = pending.take();
+    return true;
+}
+
+/* Textures can be loaded again, they become evictable once collected since nothing uses them on the loader anymore */
+bool collect(Pending<Resource::Texture> &pending, Resource::Texture &target);
+
+template <class T, std::size_t N>
+inline void
+resetAll(std::array<Pending<T>, N> &pendings) noexcept
+{
+    for (Pending<T> &pending : pendings) {
+        pending.reset();
+    }
+}
+
+}; // namespace Loader
+#endif
@@ -0,0 +1,464 @@
+#include "NullGl.hpp"
+#include "GlEntryPoints.hpp"
+#include "GlTrace.hpp"
+
+#include <fmt/core.h>
+
+#include <algorithm>
+#include <bit>
+#include <fstream>
+#include <string>
+#include <type_traits>
+
+namespace NullGl
+{
+
+static GLuint APIENTRY createObject(void);
+static GLuint APIENTRY createShader(GLenum type);
+static void APIENTRY genNames(GLsizei count, GLuint *names);
+static void APIENTRY getObjectParameter(GLuint object, GLenum name, GLint *parameters);
+static void APIENTRY getInfoLog(GLuint object, GLsizei size, GLsizei *length, GLchar *info_log);
+static GLint APIENTRY getLocation(GLuint program, const GLchar *name);
+static GLenum APIENTRY checkFramebufferStatus(GLenum target);
+static GLsync APIENTRY fenceSync(GLenum condition, GLbitfield flags);
+static GLenum APIENTRY clientWaitSync(GLsync sync, GLbitfield flags, GLuint64 timeout);
+static void APIENTRY getSync(GLsync sync, GLenum name, GLsizei count, GLsizei *length, GLint *values);
+static void *APIENTRY mapBufferRange(GLenum target, GLintptr offset, GLsizeiptr length, GLbitfield access);
+static GLboolean APIENTRY unmapBuffer(GLenum target);
+template <class Value> static void APIENTRY getQueryObject(GLuint query, GLenum name, Value *parameters);
+template <class Value> static void APIENTRY getState(GLenum name, Value *data);
+static const GLubyte *APIENTRY getString(GLenum name);
+static const GLubyte *APIENTRY getStringIndexed(GLenum name, GLuint index);
+
+std::optional<Mode>
+parseMode(std::string_view name) noexcept
+{
+    if ("null" == name) {
+        return Mode::DISCARD;
+    }
+    if ("record" == name) {
+        return Mode::RECORD;
+    }
+    return std::nullopt;
+}
+
+template <class Argument>
+static std::uint32_t
+encodeArgument(Argument argument) noexcept
+{
+    if constexpr (std::is_pointer_v<Argument>) {
+        const auto address = reinterpret_cast<std::uintptr_t>(argument);
+        return address < Call::UNKNOWN_POINTER ? static_cast<std::uint32_t>(address) : Call::UNKNOWN_POINTER;
+    } else if constexpr (std::is_same_v<Argument, GLfloat>) {
+        return std::bit_cast<std::uint32_t>(argument);
+    } else if constexpr (std::is_same_v<Argument, GLdouble>) {
+        return std::bit_cast<std::uint32_t>(static_cast<GLfloat>(argument));
+    } else {
+        return static_cast<std::uint32_t>(argument);
+    }
+}
+
+template <class... Arguments>
+static Call
+makeCall(std::size_t entry_point, Arguments... arguments) noexcept
+{
+    Call call{static_cast<std::uint16_t>(entry_point), static_cast<std::uint16_t>(std::min(sizeof...(Arguments), Call::MAX_ARGUMENTS)), {}};
+    std::size_t argument = 0;
+    ((argument < Call::MAX_ARGUMENTS ? void(call.arguments[argument++] = encodeArgument(arguments)) : void()), ...);
+    return call;
+}
+
+template <std::size_t Index, class Function>
+struct NullFunction;
+
+template <std::size_t Index, class Result, class... Arguments>
+struct NullFunction<Index, Result(APIENTRYP)(Arguments...)>
+{
+    /* Fills the outputs and picks the result, a default constructed result is returned without it */
+    static inline Result(APIENTRYP implementation)(Arguments...) = nullptr;
+
+    static Result APIENTRY
+    call(Arguments... arguments)
+    {
+        Backend &backend = Backend::getInstance();
+        if (Mode::RECORD == backend.getMode()) {
+            backend.record(makeCall(Index, arguments...));
+        }
+        if (nullptr != implementation) {
+            return implementation(arguments...);
+        }
+        return Result();
+    }
+};
+
+template <std::size_t Index, class Function>
+static void
+installNull(Function &pointer) noexcept
+{
+    pointer = &NullFunction<Index, Function>::call;
+}
+
+template <std::size_t Index, class Function>
+static void
+implement(const Function &, std::type_identity_t<Function> implementation) noexcept
+{
+    NullFunction<Index, Function>::implementation = implementation;
+}
+
+Backend &
+Backend::getInstance(void)
+{
+    static Backend backend{};
+    return backend;
+}
+
+void
+Backend::install(Mode backend_mode) noexcept
+{
+    if (is_installed) {
+        return;
+    }
+    mode = backend_mode;
+
+#define NULLGL_INSTALL(name) installNull<GlTrace::name##_INDEX>(glad_##name);
+    GLTRACE_ENTRY_POINTS(NULLGL_INSTALL)
+#undef NULLGL_INSTALL
+
+#define NULLGL_IMPLEMENT(name, function) implement<GlTrace::name##_INDEX>(glad_##name, function);
+    NULLGL_IMPLEMENT(glCreateProgram, createObject)
+    NULLGL_IMPLEMENT(glCreateShader, createShader)
+    NULLGL_IMPLEMENT(glGenBuffers, genNames)
+    NULLGL_IMPLEMENT(glGenFramebuffers, genNames)
+    NULLGL_IMPLEMENT(glGenQueries, genNames)
+    NULLGL_IMPLEMENT(glGenRenderbuffers, genNames)
+    NULLGL_IMPLEMENT(glGenSamplers, genNames)
+    NULLGL_IMPLEMENT(glGenTextures, genNames)
+    NULLGL_IMPLEMENT(glGenVertexArrays, genNames)
+    NULLGL_IMPLEMENT(glGetShaderiv, getObjectParameter)
+    NULLGL_IMPLEMENT(glGetProgramiv, getObjectParameter)
+    NULLGL_IMPLEMENT(glGetShaderInfoLog, getInfoLog)
+    NULLGL_IMPLEMENT(glGetProgramInfoLog, getInfoLog)
+    NULLGL_IMPLEMENT(glGetUniformLocation, getLocation)
+    NULLGL_IMPLEMENT(glGetAttribLocation, getLocation)
+    NULLGL_IMPLEMENT(glCheckFramebufferStatus, checkFramebufferStatus)
+    NULLGL_IMPLEMENT(glFenceSync, fenceSync)
+    NULLGL_IMPLEMENT(glClientWaitSync, clientWaitSync)
+    NULLGL_IMPLEMENT(glGetSynciv, getSync)
+    NULLGL_IMPLEMENT(glMapBufferRange, mapBufferRange)
+    NULLGL_IMPLEMENT(glUnmapBuffer, unmapBuffer)
+    NULLGL_IMPLEMENT(glGetQueryObjectiv, getQueryObject<GLint>)
+    NULLGL_IMPLEMENT(glGetQueryObjectuiv, getQueryObject<GLuint>)
+    NULLGL_IMPLEMENT(glGetQueryObjecti64v, getQueryObject<GLint64>)
+    NULLGL_IMPLEMENT(glGetQueryObjectui64v, getQueryObject<GLuint64>)
+    NULLGL_IMPLEMENT(glGetBooleanv, getState<GLboolean>)
+    NULLGL_IMPLEMENT(glGetDoublev, getState<GLdouble>)
+    NULLGL_IMPLEMENT(glGetFloatv, getState<GLfloat>)
+    NULLGL_IMPLEMENT(glGetIntegerv, getState<GLint>)
+    NULLGL_IMPLEMENT(glGetInteger64v, getState<GLint64>)
+    NULLGL_IMPLEMENT(glGetString, getString)
+    NULLGL_IMPLEMENT(glGetStringi, getStringIndexed)
+#undef NULLGL_IMPLEMENT
+
+    /* What glGetString(GL_VERSION) reports, without extensions */
+    GLVersion.major = 3;
+    GLVersion.minor = 3;
+    GLAD_GL_ARB_texture_storage = 0;
+    is_installed = true;
+}
+
+bool
+Backend::isInstalled(void) const noexcept
+{
+    return is_installed;
+}
+
+Mode
+Backend::getMode(void) const noexcept
+{
+    return mode;
+}
+
+void
+Backend::endFrame(void)
+{
+    if (is_installed) {
+        frame_starts.push_back(calls.size());
+    }
+}
+
+std::span<const Call>
+Backend::getCalls(void) const noexcept
+{
+    return calls;
+}
+
+std::span<const Call>
+Backend::getFrameCalls(std::size_t frame) const noexcept
+{
+    if (frame >= getFrameCount()) {
+        return {};
+    }
+    return std::span<const Call>{calls}.subspan(frame_starts[frame], frame_starts[frame + 1] - frame_starts[frame]);
+}
+
+std::size_t
+Backend::getFrameCount(void) const noexcept
+{
+    return frame_starts.size() - 1;
+}
+
+void
+Backend::writeLog(const std::filesystem::path &file_path) const
+{
+    const bool is_text = ".txt" == file_path.extension();
+    std::ofstream stream{file_path, is_text ? std::ios::out | std::ios::trunc : std::ios::out | std::ios::trunc | std::ios::binary};
+    if (!stream.is_open()) {
+        fmt::print(stderr, "writeLog: Failed to open file {}.\n", file_path.string());
+        return;
+    }
+
+    /* Calls made before the first frame, during setup(), are part of the first one */
+    if (!is_text) {
+        for (std::size_t frame = 0; frame < getFrameCount(); ++frame) {
+            const std::span<const Call> frame_calls = getFrameCalls(frame);
+            const auto count = static_cast<std::uint32_t>(frame_calls.size());
+            stream.write(reinterpret_cast<const char *>(&count), sizeof(count));
+            stream.write(reinterpret_cast<const char *>(frame_calls.data()), static_cast<std::streamsize>(frame_calls.size_bytes()));
+        }
+        return;
+    }
+
+    for (std::size_t frame = 0; frame < getFrameCount(); ++frame) {
+        stream << fmt::format("frame {}\n", frame);
+        for (const Call &call : getFrameCalls(frame)) {
+            std::string line = fmt::format("  {}(", GlTrace::getEntryPointName(call.entry_point));
+            for (std::size_t argument = 0; argument < call.argument_count; ++argument) {
+                line += fmt::format("{}{:#x}", 0 == argument ? "" : ", ", call.arguments[argument]);
+            }
+            stream << line << ")\n";
+        }
+    }
+}
+
+void
+Backend::printSummary(void) const
+{
+    if (!is_installed) {
+        return;
+    }
+    const std::size_t frames = getFrameCount();
+    fmt::print("Null GL backend: {} objects named, {} MiB of scratch for mapped ranges", next_name, scratch.size() / (1024 * 1024));
+    if (Mode::RECORD == mode && 0 < frames) {
+        fmt::print(", {} calls recorded over {} frames, {:.1f} per frame", calls.size(), frames,
+                   static_cast<double>(calls.size()) / static_cast<double>(frames));
+    }
+    fmt::print("\n");
+}
+
+void
+Backend::record(const Call &call)
+{
+    calls.push_back(call);
+}
+
+GLuint
+Backend::nextName(void) noexcept
+{
+    return ++next_name;
+}
+
+GLint
+Backend::findLocation(GLuint program, std::string_view name)
+{
+    const auto [location, is_new] = locations.try_emplace({program, std::string{name}}, next_location);
+    if (is_new) {
+        ++next_location;
+    }
+    return location->second;
+}
+
+void *
+Backend::mapScratch(std::size_t size)
+{
+    /* Every mapping shares one allocation, what is written to it is never read back */
+    if (scratch.size() < size) {
+        scratch.resize(size);
+    }
+    return scratch.data();
+}
+
+static GLuint APIENTRY
+createObject(void)
+{
+    return Backend::getInstance().nextName();
+}
+
+static GLuint APIENTRY
+createShader(GLenum)
+{
+    return Backend::getInstance().nextName();
+}
+
+static void APIENTRY
+genNames(GLsizei count, GLuint *names)
+{
+    for (GLsizei i = 0; i < count; ++i) {
+        names[i] = Backend::getInstance().nextName();
+    }
+}
+
+static void APIENTRY
+getObjectParameter(GLuint, GLenum name, GLint *parameters)
+{
+    switch (name) {
+    case GL_COMPILE_STATUS:
+    case GL_LINK_STATUS:
+    case GL_VALIDATE_STATUS:
+        *parameters = GL_TRUE;
+        break;
+    default:
+        *parameters = 0;
+        break;
+    }
+}
+
+static void APIENTRY
+getInfoLog(GLuint, GLsizei size, GLsizei *length, GLchar *info_log)
+{
+    if (nullptr != length) {
+        *length = 0;
+    }
+    if (0 < size) {
+        info_log[0] = '\0';
+    }
+}
+
+static GLint APIENTRY
+getLocation(GLuint program, const GLchar *name)
+{
+    return Backend::getInstance().findLocation(program, name);
+}
+
+static GLenum APIENTRY
+checkFramebufferStatus(GLenum)
+{
+    return GL_FRAMEBUFFER_COMPLETE;
+}
+
+static GLsync APIENTRY
+fenceSync(GLenum, GLbitfield)
+{
+    return reinterpret_cast<GLsync>(static_cast<std::uintptr_t>(Backend::getInstance().nextName()));
+}
+
+static GLenum APIENTRY
+clientWaitSync(GLsync, GLbitfield, GLuint64)
+{
+    return GL_ALREADY_SIGNALED;
+}
+
+static void APIENTRY
+getSync(GLsync, GLenum name, GLsizei count, GLsizei *length, GLint *values)
+{
+    if (nullptr != length) {
+        *length = 0 < count ? 1 : 0;
+    }
+    if (0 < count) {
+        values[0] = GL_SYNC_STATUS == name ? GL_SIGNALED : 0;
+    }
+}
+
+static void *APIENTRY
+mapBufferRange(GLenum, GLintptr, GLsizeiptr length, GLbitfield)
+{
+    return 0 < length ? Backend::getInstance().mapScratch(static_cast<std::size_t>(length)) : nullptr;
+}
+
+static GLboolean APIENTRY
+unmapBuffer(GLenum)
+{
+    return GL_TRUE;
+}
+
+/* Results are always available, timer queries measure nothing */
+template <class Value>
+static void APIENTRY
+getQueryObject(GLuint, GLenum name, Value *parameters)
+{
+    *parameters = GL_QUERY_RESULT_AVAILABLE == name ? Value{1} : Value{0};
+}
+
+template <class Value>
+static void APIENTRY
+getState(GLenum name, Value *data)
+{
+    GLint value = 0;
+    std::size_t count = 1;
+    switch (name) {
+    case GL_VIEWPORT:
+    case GL_SCISSOR_BOX:
+    case GL_COLOR_CLEAR_VALUE:
+    case GL_BLEND_COLOR:
+    case GL_COLOR_WRITEMASK:
+        count = 4;
+        break;
+    case GL_DEPTH_RANGE:
+    case GL_MAX_VIEWPORT_DIMS:
+        count = 2;
+        value = GL_MAX_VIEWPORT_DIMS == name ? 16384 : 0;
+        break;
+    case GL_PACK_ALIGNMENT:
+    case GL_UNPACK_ALIGNMENT:
+        value = 4;
+        break;
+    case GL_MAX_TEXTURE_SIZE:
+    case GL_MAX_RENDERBUFFER_SIZE:
+        value = 16384;
+        break;
+    case GL_MAX_TEXTURE_IMAGE_UNITS:
+    case GL_MAX_VERTEX_ATTRIBS:
+    case GL_MAX_COLOR_ATTACHMENTS:
+    case GL_MAX_DRAW_BUFFERS:
+        value = 16;
+        break;
+    case GL_MAJOR_VERSION:
+    case GL_MINOR_VERSION:
+        value = 3;
+        break;
+    default:
+        break;
+    }
+    std::fill_n(data, count, static_cast<Value>(value));
+}
+
+static const GLubyte *APIENTRY
+getString(GLenum name)
+{
+    const char *string = "";
+    switch (name) {
+    case GL_VENDOR:
+        string = "NullGl";
+        break;
+    case GL_RENDERER:
+        string = "Null backend";
+        break;
+    case GL_VERSION:
+        string = "3.3.0 NullGl";
+        break;
+    case GL_SHADING_LANGUAGE_VERSION:
+        string = "3.30";
+        break;
+    default:
+        break;
+    }
+    return reinterpret_cast<const GLubyte *>(string);
+}
+
+/* No extensions, GL_NUM_EXTENSIONS is 0 */
+static const GLubyte *APIENTRY
+getStringIndexed(GLenum, GLuint)
+{
+    return nullptr;
+}
+
+}; // namespace NullGl
@@ -0,0 +1,103 @@
+#ifndef NULLGL_HPP
+#define NULLGL_HPP
+
+#include <glad/glad.h>
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <map>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace NullGl
+{
+
+enum class Mode
+{
+    /* Every call returns right away */
+    DISCARD,
+    /* Every call is also appended to the call log */
+    RECORD
+};
+
+std::optional<Mode> parseMode(std::string_view name) noexcept;
+
+/*
+ * One call of the log. Integer and enum arguments are kept as they are, floats by their bits, pointers as offsets when
+ * they fit in 32 bits and as UNKNOWN_POINTER otherwise since addresses change from one run to the next.
+ */
+struct Call
+{
+    static constexpr std::size_t MAX_ARGUMENTS{6};
+    static constexpr std::uint32_t UNKNOWN_POINTER{0xFFFFFFFF};
+
+    std::uint16_t entry_point;
+    std::uint16_t argument_count;
+    std::array<std::uint32_t, MAX_ARGUMENTS> arguments;
+};
+
+/*
+ * Replaces glad's function pointers with functions that never reach a driver, so that the render code can run without a
+ * context to measure its CPU cost or to compare the call sequences of two builds. Objects get names counting up from 1
+ * in creation order, shaders compile, framebuffers are complete, fences are signalled and mapped ranges point to scratch
+ * memory, everything else does nothing. Calls can be recorded to a log, split by frame.
+ */
+class Backend
+{
+  public:
+    static Backend &getInstance(void);
+
+    /* Replace every entry point, instead of loading them with glad */
+    void install(Mode backend_mode) noexcept;
+    bool isInstalled(void) const noexcept;
+    Mode getMode(void) const noexcept;
+
+    /* Close the current frame of the log */
+    void endFrame(void);
+
+    std::span<const Call> getCalls(void) const noexcept;
+    std::span<const Call> getFrameCalls(std::size_t frame) const noexcept;
+    std::size_t getFrameCount(void) const noexcept;
+
+    /* Readable listing when the extension is .txt, otherwise the call count of every frame followed by its raw records */
+    void writeLog(const std::filesystem::path &file_path) const;
+    void printSummary(void) const;
+
+    /* Used by the replacement functions */
+    void record(const Call &call);
+    GLuint nextName(void) noexcept;
+    /* The same program and name always get the same location, so that identical frames record identical calls */
+    GLint findLocation(GLuint program, std::string_view name);
+    void *mapScratch(std::size_t size);
+
+    Backend(const Backend &) = delete;
+    Backend(Backend &&) = delete;
+    Backend &operator=(const Backend &) = delete;
+    Backend &operator=(Backend &&) = delete;
+
+  private:
+    Backend(void) = default;
+    ~Backend() = default;
+
+    bool is_installed = false;
+    Mode mode = Mode::DISCARD;
+
+    GLuint next_name = 0;
+    GLint next_location = 0;
+    std::map<std::pair<GLuint, std::string>, GLint, std::less<>> locations{};
+    std::vector<std::byte> scratch{};
+
+    std::vector<Call> calls{};
+    /* Index of the first call of every frame */
+    std::vector<std::size_t> frame_starts{0};
+};
+
+}; // namespace NullGl
+#endif
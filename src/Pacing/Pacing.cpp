@@ -0,0 +1,193 @@
+#include "Pacing.hpp"
+
+#include <GLFW/glfw3.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <thread>
+
+namespace Pacing
+{
+
+/* Slack left between the predicted end of a frame and its deadline */
+static constexpr double SAFETY_MARGIN{0.002};
+static constexpr double COST_SMOOTHING{0.1};
+static constexpr GLuint64 WAIT_TIMEOUT_NS{100'000'000};
+
+std::optional<Mode>
+parseMode(std::string_view name) noexcept
+{
+    if ("throughput" == name) {
+        return Mode::THROUGHPUT;
+    }
+    if ("latency" == name) {
+        return Mode::LATENCY;
+    }
+    return std::nullopt;
+}
+
+Options
+getDefaultOptions(Mode mode, double refresh_rate) noexcept
+{
+    if (Mode::LATENCY == mode) {
+        return {mode, 1, true, refresh_rate};
+    }
+    return {mode, 2, false, refresh_rate};
+}
+
+FramePacer::FramePacer(const Options &pacing_options) noexcept : options{pacing_options}
+{
+    options.frames_in_flight = std::max<std::size_t>(options.frames_in_flight, 1);
+    if (options.refresh_rate <= 0.0) {
+        options.refresh_rate = 60.0;
+    }
+}
+
+FramePacer::~FramePacer() noexcept
+{
+    for (const FrameInFlight &frame : frames) {
+        glDeleteSync(frame.fence);
+    }
+}
+
+void
+FramePacer::retire(Input::InputSystem &input, std::size_t keep)
+{
+    while (!frames.empty()) {
+        FrameInFlight &frame = frames.front();
+        const bool must_wait = frames.size() > keep;
+        GLenum status = glClientWaitSync(frame.fence, GL_SYNC_FLUSH_COMMANDS_BIT, must_wait ? WAIT_TIMEOUT_NS : 0);
+        while (must_wait && GL_TIMEOUT_EXPIRED == status) {
+            status = glClientWaitSync(frame.fence, GL_SYNC_FLUSH_COMMANDS_BIT, WAIT_TIMEOUT_NS);
+        }
+        if (GL_TIMEOUT_EXPIRED == status) {
+            return;
+        }
+        last_completion = glfwGetTime();
+        if (frame.oldest_event) {
+            input.recordLatency(*frame.oldest_event, last_completion);
+        }
+        glDeleteSync(frame.fence);
+        frames.pop_front();
+    }
+}
+
+void
+FramePacer::waitForFrameStart(Input::InputSystem &input)
+{
+    retire(input, options.frames_in_flight - 1);
+
+    if (options.late_sampling && last_completion > 0.0) {
+        /* The next refresh after the last presented frame, minus the time the frame is expected to take */
+        const double period = 1.0 / options.refresh_rate;
+        const double now = glfwGetTime();
+        const double refreshes = std::ceil((now - last_completion) / period);
+        const double deadline = last_completion + std::max(refreshes, 1.0) * period;
+        const double wake_up = deadline - predicted_cost - SAFETY_MARGIN;
+        if (wake_up > now) {
+            std::this_thread::sleep_for(std::chrono::duration<double>(wake_up - now));
+        }
+    }
+    frame_start = glfwGetTime();
+}
+
+void
+FramePacer::endFrame(std::optional<double> oldest_event, double cost)
+{
+    predicted_cost = 0.0 == predicted_cost ? cost : predicted_cost + COST_SMOOTHING * (cost - predicted_cost);
+    frames.push_back({glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0), oldest_event});
+}
+
+void
+FramePacer::finish(Input::InputSystem &input)
+{
+    retire(input, 0);
+}
+
+double
+FramePacer::getPredictedFrameCost(void) const noexcept
+{
+    return predicted_cost;
+}
+
+double
+FramePacer::getFrameStart(void) const noexcept
+{
+    return frame_start;
+}
+
+void
+DamageTracker::markDirty(void) noexcept
+{
+    dirty = true;
+}
+
+AnimationId
+DamageTracker::addAnimation(double rate)
+{
+    animations.push_back({0.0 < rate ? 1.0 / rate : 0.0, 0.0, true});
+    return animations.size() - 1;
+}
+
+void
+DamageTracker::setAnimationActive(AnimationId animation, bool active) noexcept
+{
+    if (active && !animations[animation].active) {
+        /* Show the first change right away */
+        animations[animation].next_due = 0.0;
+    }
+    animations[animation].active = active;
+}
+
+bool
+DamageTracker::needsRedraw(double now) const noexcept
+{
+    if (dirty) {
+        return true;
+    }
+    for (const Animation &animation : animations) {
+        if (animation.active && animation.next_due <= now) {
+            return true;
+        }
+    }
+    return false;
+}
+
+std::optional<double>
+DamageTracker::getWaitTimeout(double now) const noexcept
+{
+    std::optional<double> timeout{};
+    for (const Animation &animation : animations) {
+        if (animation.active) {
+            const double remaining = std::max(animation.next_due - now, 0.0);
+            timeout = timeout ? std::min(*timeout, remaining) : remaining;
+        }
+    }
+    return timeout;
+}
+
+void
+DamageTracker::frameRendered(double now) noexcept
+{
+    /* Every animation is brought up to date by a redraw, whichever one asked for it */
+    dirty = false;
+    for (Animation &animation : animations) {
+        animation.next_due = now + animation.interval;
+    }
+    ++stats.rendered_frames;
+}
+
+void
+DamageTracker::frameSkipped(void) noexcept
+{
+    ++stats.skipped_frames;
+}
+
+const DamageStats &
+DamageTracker::getStats(void) const noexcept
+{
+    return stats;
+}
+
+}; // namespace Pacing
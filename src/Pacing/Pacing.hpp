@@ -0,0 +1,128 @@
+#ifndef PACING_HPP
+#define PACING_HPP
+
+#include <glad/glad.h>
+
+#include "Input.hpp"
+
+#include <cstddef>
+#include <deque>
+#include <optional>
+#include <string_view>
+#include <vector>
+
+namespace Pacing
+{
+
+enum class Mode
+{
+    /* Keep the GPU fed, a few frames may be queued */
+    THROUGHPUT,
+    /* One frame in flight, input sampled as late as the predicted frame cost allows */
+    LATENCY
+};
+
+std::optional<Mode> parseMode(std::string_view name) noexcept;
+
+struct Options
+{
+    Mode mode;
+    std::size_t frames_in_flight;
+    /* Sleep until just before the next refresh deadline before sampling input */
+    bool late_sampling;
+    double refresh_rate;
+};
+
+/* Default frames in flight and late sampling of a mode */
+Options getDefaultOptions(Mode mode, double refresh_rate) noexcept;
+
+/*
+ * Bounds the frames queued on the GPU with a fence after every swap.
+ * A frame counts as presented once its fence has signalled, which is when its input latency is recorded.
+ */
+class FramePacer
+{
+  public:
+    explicit FramePacer(const Options &pacing_options) noexcept;
+    ~FramePacer() noexcept;
+
+    FramePacer(const FramePacer &) = delete;
+    FramePacer(FramePacer &&) = delete;
+    FramePacer &operator=(const FramePacer &) = delete;
+    FramePacer &operator=(FramePacer &&) = delete;
+
+    /* Wait for a free frame slot and, with late sampling, for the wake up time; call before polling events */
+    void waitForFrameStart(Input::InputSystem &input);
+    /* Fence the frame just swapped, cost being the CPU time from the frame start to just before the swap */
+    void endFrame(std::optional<double> oldest_event, double cost);
+    /* Wait for every frame in flight, the context must still be current */
+    void finish(Input::InputSystem &input);
+
+    double getPredictedFrameCost(void) const noexcept;
+    double getFrameStart(void) const noexcept;
+
+  private:
+    struct FrameInFlight
+    {
+        GLsync fence;
+        std::optional<double> oldest_event;
+    };
+
+    /* Retire the frames whose fence signalled, waiting for the oldest ones while more than keep are in flight */
+    void retire(Input::InputSystem &input, std::size_t keep);
+
+    Options options;
+    std::deque<FrameInFlight> frames{};
+    /* Moving average of the CPU time from frame start to the swap */
+    double predicted_cost = 0.0;
+    double last_completion = 0.0;
+    double frame_start = 0.0;
+};
+
+using AnimationId = std::size_t;
+
+struct DamageStats
+{
+    std::size_t rendered_frames;
+    /* Loop iterations woken up by events that did not change anything */
+    std::size_t skipped_frames;
+};
+
+/*
+ * Tracks whether anything on screen changed since the last rendered frame, so that the loop can block on events instead.
+ * Changes are either marked explicitly or come from animations, which declare how many redraws per second they need.
+ */
+class DamageTracker
+{
+  public:
+    /* The next iteration redraws */
+    void markDirty(void) noexcept;
+
+    /* A source changing the picture rate times per second while active, 0 redraws every iteration */
+    AnimationId addAnimation(double rate);
+    void setAnimationActive(AnimationId animation, bool active) noexcept;
+
+    bool needsRedraw(double now) const noexcept;
+    /* Seconds until the next animation is due, nothing when only events can change the picture */
+    std::optional<double> getWaitTimeout(double now) const noexcept;
+
+    void frameRendered(double now) noexcept;
+    void frameSkipped(void) noexcept;
+    const DamageStats &getStats(void) const noexcept;
+
+  private:
+    struct Animation
+    {
+        double interval;
+        double next_due;
+        bool active;
+    };
+
+    /* The first frame always renders */
+    bool dirty = true;
+    std::vector<Animation> animations{};
+    DamageStats stats{0, 0};
+};
+
+}; // namespace Pacing
+#endif
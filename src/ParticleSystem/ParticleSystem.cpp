@@ -0,0 +1,371 @@
+#include "ParticleSystem.hpp"
+#include "JobSystem.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define PARTICLESYSTEM_USE_SSE
+#endif
+
+namespace ParticleSystem
+{
+
+/* Bottom of the screen in clip space */
+static constexpr float FLOOR{-1.0f};
+/* Particles integrated by one job, enough to amortise scheduling */
+static constexpr std::size_t MIN_GRAIN{4096};
+/* Dead particles uploaded per glBufferSubData call when resizing the GPU buffers */
+static constexpr std::uint32_t DEAD_CHUNK{4096};
+
+static float random(std::uint32_t index, std::uint32_t seed, std::uint32_t salt) noexcept;
+
+std::optional<Path>
+parsePath(std::string_view name) noexcept
+{
+    if ("gpu" == name) {
+        return Path::GPU;
+    }
+    if ("cpu" == name) {
+        return Path::CPU;
+    }
+    return std::nullopt;
+}
+
+const char *
+getPathName(Path path) noexcept
+{
+    return Path::GPU == path ? "GPU" : "CPU";
+}
+
+Emitter
+getDefaultEmitter(void) noexcept
+{
+    return {glm::vec2(0.0f, -0.9f), glm::vec2(0.0f, -1.5f), 0.6f, 2.0f, 2.5f, 0.5f};
+}
+
+Spawn
+EmissionClock::advance(float delta, float rate, std::uint32_t capacity) noexcept
+{
+    if (0 == capacity) {
+        return {0, 0, frame++};
+    }
+    pending += std::max(delta * rate, 0.0f);
+    const auto count = static_cast<std::uint32_t>(std::min(pending, static_cast<float>(capacity)));
+    pending = std::min(pending - static_cast<float>(count), 1.0f);
+    const Spawn spawn{cursor % capacity, count, frame++};
+    cursor = (spawn.begin + count) % capacity;
+    return spawn;
+}
+
+void
+EmissionClock::reset(void) noexcept
+{
+    pending = 0.0f;
+    cursor = 0;
+}
+
+/* lowbias32, good enough to scatter neighbouring slots */
+std::uint32_t
+hash(std::uint32_t value) noexcept
+{
+    value ^= value >> 16;
+    value *= 0x7FEB352Du;
+    value ^= value >> 15;
+    value *= 0x846CA68Bu;
+    value ^= value >> 16;
+    return value;
+}
+
+Simulation::Simulation(const std::filesystem::path &update_shader_path, const std::filesystem::path &vertex_shader_path,
+                       const std::filesystem::path &fragment_shader_path)
+    : update_shader{update_shader_path, {"Position", "Velocity", "Age", "Lifetime"}},
+      render_shader{vertex_shader_path, fragment_shader_path}
+{
+    static constexpr std::array<GLfloat, 8> CORNERS{-1.0f, -1.0f, 1.0f, -1.0f, -1.0f, 1.0f, 1.0f, 1.0f};
+    quad_buffer = Resource::Buffer::create();
+    glBindBuffer(GL_ARRAY_BUFFER, quad_buffer.get());
+    glBufferData(GL_ARRAY_BUFFER, sizeof(CORNERS), CORNERS.data(), GL_STATIC_DRAW);
+    quad_buffer.setSize(sizeof(CORNERS));
+
+    Resource::createAll(particle_buffers);
+    Resource::createAll(update_vertex_arrays);
+    Resource::createAll(render_vertex_arrays);
+    for (std::size_t i = 0; i < particle_buffers.size(); ++i) {
+        glBindVertexArray(update_vertex_arrays[i].get());
+        glBindBuffer(GL_ARRAY_BUFFER, particle_buffers[i].get());
+        glEnableVertexAttribArray(0);
+        glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, sizeof(Particle), reinterpret_cast<void *>(offsetof(Particle, position)));
+        glEnableVertexAttribArray(1);
+        glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, sizeof(Particle), reinterpret_cast<void *>(offsetof(Particle, velocity)));
+        glEnableVertexAttribArray(2);
+        glVertexAttribPointer(2, 1, GL_FLOAT, GL_FALSE, sizeof(Particle), reinterpret_cast<void *>(offsetof(Particle, age)));
+        glEnableVertexAttribArray(3);
+        glVertexAttribPointer(3, 1, GL_FLOAT, GL_FALSE, sizeof(Particle), reinterpret_cast<void *>(offsetof(Particle, lifetime)));
+
+        /* The quad corners per vertex, the particle per instance */
+        glBindVertexArray(render_vertex_arrays[i].get());
+        glBindBuffer(GL_ARRAY_BUFFER, quad_buffer.get());
+        glEnableVertexAttribArray(0);
+        glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(GLfloat), nullptr);
+        glBindBuffer(GL_ARRAY_BUFFER, particle_buffers[i].get());
+        glEnableVertexAttribArray(1);
+        glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, sizeof(Particle), reinterpret_cast<void *>(offsetof(Particle, position)));
+        glVertexAttribDivisor(1, 1);
+        glEnableVertexAttribArray(2);
+        glVertexAttribPointer(2, 1, GL_FLOAT, GL_FALSE, sizeof(Particle), reinterpret_cast<void *>(offsetof(Particle, age)));
+        glVertexAttribDivisor(2, 1);
+        glEnableVertexAttribArray(3);
+        glVertexAttribPointer(3, 1, GL_FLOAT, GL_FALSE, sizeof(Particle), reinterpret_cast<void *>(offsetof(Particle, lifetime)));
+        glVertexAttribDivisor(3, 1);
+    }
+    glBindVertexArray(0);
+
+    cpu_buffer = Resource::Buffer::create();
+    cpu_vertex_array = Resource::VertexArray::create();
+}
+
+void
+Simulation::resize(std::uint32_t particle_capacity)
+{
+    capacity = particle_capacity;
+    current = 0;
+    const auto gpu_bytes = static_cast<GLsizeiptr>(std::size_t{capacity} * sizeof(Particle));
+    const auto cpu_bytes = static_cast<GLsizeiptr>(std::size_t{capacity} * 4 * sizeof(float));
+
+    /* Only the path in use keeps its memory, zero ages and lifetimes are dead particles */
+    if (Path::GPU == path) {
+        const std::vector<Particle> dead(std::min(capacity, DEAD_CHUNK), Particle{glm::vec2(0.0f), glm::vec2(0.0f), 0.0f, 0.0f});
+        glBindBuffer(GL_ARRAY_BUFFER, particle_buffers[0].get());
+        glBufferData(GL_ARRAY_BUFFER, gpu_bytes, nullptr, GL_DYNAMIC_COPY);
+        for (std::uint32_t first = 0; first < capacity; first += DEAD_CHUNK) {
+            const std::uint32_t count = std::min(capacity - first, DEAD_CHUNK);
+            glBufferSubData(GL_ARRAY_BUFFER, static_cast<GLintptr>(std::size_t{first} * sizeof(Particle)),
+                            static_cast<GLsizeiptr>(std::size_t{count} * sizeof(Particle)), dead.data());
+        }
+        /* Entirely written by the first update before being read */
+        glBindBuffer(GL_ARRAY_BUFFER, particle_buffers[1].get());
+        glBufferData(GL_ARRAY_BUFFER, gpu_bytes, nullptr, GL_DYNAMIC_COPY);
+        for (Resource::Buffer &buffer : particle_buffers) {
+            buffer.setSize(static_cast<std::size_t>(gpu_bytes));
+        }
+        positions = velocities = ages = lifetimes = std::vector<float>{};
+        glBindBuffer(GL_ARRAY_BUFFER, cpu_buffer.get());
+        glBufferData(GL_ARRAY_BUFFER, 0, nullptr, GL_STREAM_DRAW);
+        cpu_buffer.setSize(0);
+    } else {
+        positions.assign(std::size_t{capacity} * 2, 0.0f);
+        velocities.assign(std::size_t{capacity} * 2, 0.0f);
+        ages.assign(capacity, 0.0f);
+        lifetimes.assign(capacity, 0.0f);
+        glBindBuffer(GL_ARRAY_BUFFER, cpu_buffer.get());
+        glBufferData(GL_ARRAY_BUFFER, cpu_bytes, nullptr, GL_STREAM_DRAW);
+        cpu_buffer.setSize(static_cast<std::size_t>(cpu_bytes));
+        for (Resource::Buffer &buffer : particle_buffers) {
+            glBindBuffer(GL_ARRAY_BUFFER, buffer.get());
+            glBufferData(GL_ARRAY_BUFFER, 0, nullptr, GL_DYNAMIC_COPY);
+            buffer.setSize(0);
+        }
+        createCpuVertexArray();
+    }
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+void
+Simulation::setPath(Path simulation_path)
+{
+    path = simulation_path;
+    resize(capacity);
+}
+
+Path
+Simulation::getPath(void) const noexcept
+{
+    return path;
+}
+
+std::uint32_t
+Simulation::getCapacity(void) const noexcept
+{
+    return capacity;
+}
+
+void
+Simulation::simulate(const Emitter &emitter, float delta, const Spawn &spawn)
+{
+    if (0 == capacity) {
+        return;
+    }
+    if (Path::GPU == path) {
+        simulateGpu(emitter, delta, spawn);
+    } else {
+        simulateCpu(emitter, delta, spawn);
+    }
+}
+
+void
+Simulation::draw(float size, GLuint texture)
+{
+    if (0 == capacity) {
+        return;
+    }
+    render_shader.useProgram();
+    render_shader.setUniform("size", size);
+    render_shader.setUniform("sprite", 0);
+    render_shader.setUniform("textured", static_cast<GLint>(0 != texture));
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, texture);
+    glEnable(GL_BLEND);
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE);
+    glBindVertexArray(Path::GPU == path ? render_vertex_arrays[current].get() : cpu_vertex_array.get());
+    glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, static_cast<GLsizei>(capacity));
+    glBindVertexArray(0);
+    glDisable(GL_BLEND);
+}
+
+/* One point per particle through the vertex stage, its outputs land in the other buffer */
+void
+Simulation::simulateGpu(const Emitter &emitter, float delta, const Spawn &spawn)
+{
+    update_shader.useProgram();
+    update_shader.setUniform("delta", delta);
+    update_shader.setUniform("origin", emitter.origin);
+    update_shader.setUniform("gravity", emitter.gravity);
+    update_shader.setUniform("spread", emitter.spread);
+    update_shader.setUniform("speed", emitter.speed);
+    update_shader.setUniform("lifetime", emitter.lifetime);
+    update_shader.setUniform("bounce", emitter.bounce);
+    update_shader.setUniform("capacity", static_cast<GLint>(capacity));
+    update_shader.setUniform("spawn_begin", static_cast<GLint>(spawn.begin));
+    update_shader.setUniform("spawn_count", static_cast<GLint>(spawn.count));
+    update_shader.setUniform("seed", static_cast<GLint>(spawn.seed));
+
+    const std::size_t next = 1 - current;
+    glEnable(GL_RASTERIZER_DISCARD);
+    glBindVertexArray(update_vertex_arrays[current].get());
+    glBindBufferBase(GL_TRANSFORM_FEEDBACK_BUFFER, 0, particle_buffers[next].get());
+    glBeginTransformFeedback(GL_POINTS);
+    glDrawArrays(GL_POINTS, 0, static_cast<GLsizei>(capacity));
+    glEndTransformFeedback();
+    glBindBufferBase(GL_TRANSFORM_FEEDBACK_BUFFER, 0, 0);
+    glBindVertexArray(0);
+    glDisable(GL_RASTERIZER_DISCARD);
+    current = next;
+}
+
+void
+Simulation::simulateCpu(const Emitter &emitter, float delta, const Spawn &spawn)
+{
+    Utils::JobSystem::getInstance().parallelFor(
+        capacity, [this, &emitter, delta](std::size_t begin, std::size_t end) { integrateCpu(emitter, delta, begin, end); }, MIN_GRAIN);
+    for (std::uint32_t i = 0; i < spawn.count; ++i) {
+        spawnCpu(emitter, (spawn.begin + i) % capacity, spawn.seed);
+    }
+
+    /* Orphaned so that the upload never waits for the previous draw */
+    const std::size_t count = capacity;
+    glBindBuffer(GL_ARRAY_BUFFER, cpu_buffer.get());
+    glBufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(count * 4 * sizeof(float)), nullptr, GL_STREAM_DRAW);
+    glBufferSubData(GL_ARRAY_BUFFER, 0, static_cast<GLsizeiptr>(count * 2 * sizeof(float)), positions.data());
+    glBufferSubData(GL_ARRAY_BUFFER, static_cast<GLintptr>(count * 2 * sizeof(float)), static_cast<GLsizeiptr>(count * sizeof(float)), ages.data());
+    glBufferSubData(GL_ARRAY_BUFFER, static_cast<GLintptr>(count * 3 * sizeof(float)), static_cast<GLsizeiptr>(count * sizeof(float)), lifetimes.data());
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+#ifdef PARTICLESYSTEM_USE_SSE
+static inline __m128
+select(__m128 mask, __m128 if_true, __m128 if_false) noexcept
+{
+    return _mm_or_ps(_mm_and_ps(mask, if_true), _mm_andnot_ps(mask, if_false));
+}
+#endif
+
+/* Same steps as the update shader: gravity, motion, then the bounce on the floor */
+void
+Simulation::integrateCpu(const Emitter &emitter, float delta, std::size_t begin, std::size_t end) noexcept
+{
+    const glm::vec2 gravity_step = emitter.gravity * delta;
+    std::size_t i = begin;
+#ifdef PARTICLESYSTEM_USE_SSE
+    const __m128 step = _mm_set1_ps(delta);
+    const __m128 gravity = _mm_setr_ps(gravity_step.x, gravity_step.y, gravity_step.x, gravity_step.y);
+    const __m128 floor = _mm_set1_ps(FLOOR);
+    const __m128 bounce = _mm_set1_ps(emitter.bounce);
+    /* Positions and velocities hold xy pairs, only the y lanes bounce */
+    const __m128 y_lanes = _mm_castsi128_ps(_mm_setr_epi32(0, -1, 0, -1));
+    const __m128 absolute = _mm_castsi128_ps(_mm_set1_epi32(0x7FFFFFFF));
+    for (; i + 4 <= end; i += 4) {
+        for (std::size_t pair = 0; pair < 2; ++pair) {
+            float *position = &positions[2 * i + 4 * pair];
+            float *velocity = &velocities[2 * i + 4 * pair];
+            __m128 moved_velocity = _mm_add_ps(_mm_loadu_ps(velocity), gravity);
+            __m128 moved_position = _mm_add_ps(_mm_loadu_ps(position), _mm_mul_ps(moved_velocity, step));
+            const __m128 below = _mm_and_ps(_mm_cmplt_ps(moved_position, floor), y_lanes);
+            moved_position = select(below, floor, moved_position);
+            moved_velocity = select(below, _mm_mul_ps(_mm_and_ps(moved_velocity, absolute), bounce), moved_velocity);
+            _mm_storeu_ps(position, moved_position);
+            _mm_storeu_ps(velocity, moved_velocity);
+        }
+        _mm_storeu_ps(&ages[i], _mm_add_ps(_mm_loadu_ps(&ages[i]), step));
+    }
+#endif
+    for (; i < end; ++i) {
+        glm::vec2 velocity = glm::vec2(velocities[2 * i], velocities[2 * i + 1]) + gravity_step;
+        glm::vec2 position = glm::vec2(positions[2 * i], positions[2 * i + 1]) + velocity * delta;
+        if (position.y < FLOOR) {
+            position.y = FLOOR;
+            velocity.y = std::abs(velocity.y) * emitter.bounce;
+        }
+        positions[2 * i] = position.x;
+        positions[2 * i + 1] = position.y;
+        velocities[2 * i] = velocity.x;
+        velocities[2 * i + 1] = velocity.y;
+        ages[i] += delta;
+    }
+}
+
+void
+Simulation::spawnCpu(const Emitter &emitter, std::uint32_t index, std::uint32_t seed) noexcept
+{
+    const float angle = 1.5707964f + (random(index, seed, 0) - 0.5f) * emitter.spread;
+    const float speed = emitter.speed * (0.5f + 0.5f * random(index, seed, 1));
+    positions[2 * index] = emitter.origin.x;
+    positions[2 * index + 1] = emitter.origin.y;
+    velocities[2 * index] = speed * std::cos(angle);
+    velocities[2 * index + 1] = speed * std::sin(angle);
+    ages[index] = 0.0f;
+    lifetimes[index] = emitter.lifetime * (0.5f + 0.5f * random(index, seed, 2));
+}
+
+/* Positions, then ages, then lifetimes, so their offsets follow the capacity */
+void
+Simulation::createCpuVertexArray(void)
+{
+    const std::size_t count = capacity;
+    glBindVertexArray(cpu_vertex_array.get());
+    glBindBuffer(GL_ARRAY_BUFFER, quad_buffer.get());
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(GLfloat), nullptr);
+    glBindBuffer(GL_ARRAY_BUFFER, cpu_buffer.get());
+    glEnableVertexAttribArray(1);
+    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(GLfloat), nullptr);
+    glVertexAttribDivisor(1, 1);
+    glEnableVertexAttribArray(2);
+    glVertexAttribPointer(2, 1, GL_FLOAT, GL_FALSE, sizeof(GLfloat), reinterpret_cast<void *>(count * 2 * sizeof(GLfloat)));
+    glVertexAttribDivisor(2, 1);
+    glEnableVertexAttribArray(3);
+    glVertexAttribPointer(3, 1, GL_FLOAT, GL_FALSE, sizeof(GLfloat), reinterpret_cast<void *>(count * 3 * sizeof(GLfloat)));
+    glVertexAttribDivisor(3, 1);
+    glBindVertexArray(0);
+}
+
+/* In [0, 1), from the top 24 bits so that the float holds them exactly */
+static float
+random(std::uint32_t index, std::uint32_t seed, std::uint32_t salt) noexcept
+{
+    return static_cast<float>(hash(index * 3u + salt + seed * 0x9E3779B9u) >> 8) * (1.0f / 16777216.0f);
+}
+
+}; // namespace ParticleSystem
@@ -0,0 +1,135 @@
+#ifndef PARTICLESYSTEM_HPP
+#define PARTICLESYSTEM_HPP
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include "Resource.hpp"
+#include "Shader.hpp"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <string_view>
+#include <vector>
+
+namespace ParticleSystem
+{
+
+enum class Path
+{
+    /* Transform feedback between two buffers, the particles never leave the GPU */
+    GPU,
+    /* SIMD over the job system, the state is uploaded every frame */
+    CPU
+};
+
+std::optional<Path> parsePath(std::string_view name) noexcept;
+const char *getPathName(Path path) noexcept;
+
+/* Particles leave the origin upwards within the spread, fall and bounce on the bottom of the screen */
+struct Emitter
+{
+    glm::vec2 origin;
+    glm::vec2 gravity;
+    /* Radians around the vertical */
+    float spread;
+    /* Every particle gets between half and all of these */
+    float speed, lifetime;
+    /* Fraction of the vertical speed kept when bouncing */
+    float bounce;
+};
+
+Emitter getDefaultEmitter(void) noexcept;
+
+/* Slots respawned this frame, from begin onwards and wrapping around */
+struct Spawn
+{
+    std::uint32_t begin, count;
+    /* Changes every frame so that respawned slots get new directions */
+    std::uint32_t seed;
+};
+
+/*
+ * Turns an emission rate into the slots to respawn every frame. Slots are handed out in a ring so that the oldest
+ * particle is the one replaced when the rate outruns the capacity.
+ */
+class EmissionClock
+{
+  public:
+    Spawn advance(float delta, float rate, std::uint32_t capacity) noexcept;
+    void reset(void) noexcept;
+
+  private:
+    float pending = 0.0f;
+    std::uint32_t cursor = 0;
+    std::uint32_t frame = 0;
+};
+
+/* Integer hash shared by both paths, the GLSL update shader has the same one */
+std::uint32_t hash(std::uint32_t value) noexcept;
+
+/*
+ * Simulates particles with either path and draws them as instanced quads. Both paths follow the same rules
+ * from the same spawns, particles whose age went past their lifetime are collapsed by the vertex shader.
+ */
+class Simulation
+{
+  public:
+    Simulation(const std::filesystem::path &update_shader_path, const std::filesystem::path &vertex_shader_path,
+               const std::filesystem::path &fragment_shader_path);
+
+    Simulation(const Simulation &) = delete;
+    Simulation(Simulation &&) = delete;
+    Simulation &operator=(const Simulation &) = delete;
+    Simulation &operator=(Simulation &&) = delete;
+
+    /* Every particle is dead afterwards */
+    void resize(std::uint32_t capacity);
+    void setPath(Path simulation_path);
+    Path getPath(void) const noexcept;
+    std::uint32_t getCapacity(void) const noexcept;
+
+    void simulate(const Emitter &emitter, float delta, const Spawn &spawn);
+    /* Additive blending, size is the half extent of a particle in clip space, texture 0 draws plain sprites */
+    void draw(float size, GLuint texture);
+
+  private:
+    /* Interleaved layout written by transform feedback */
+    struct Particle
+    {
+        glm::vec2 position;
+        glm::vec2 velocity;
+        GLfloat age;
+        GLfloat lifetime;
+    };
+
+    void simulateGpu(const Emitter &emitter, float delta, const Spawn &spawn);
+    void simulateCpu(const Emitter &emitter, float delta, const Spawn &spawn);
+    void integrateCpu(const Emitter &emitter, float delta, std::size_t begin, std::size_t end) noexcept;
+    void spawnCpu(const Emitter &emitter, std::uint32_t index, std::uint32_t seed) noexcept;
+    void createCpuVertexArray(void);
+
+    Path path = Path::GPU;
+    std::uint32_t capacity = 0;
+
+    Shader update_shader;
+    Shader render_shader;
+    Resource::Buffer quad_buffer{};
+
+    /* GPU path: ping-pong buffers, the one holding the latest state is read */
+    std::array<Resource::Buffer, 2> particle_buffers{};
+    std::array<Resource::VertexArray, 2> update_vertex_arrays{};
+    std::array<Resource::VertexArray, 2> render_vertex_arrays{};
+    std::size_t current = 0;
+
+    /* CPU path: positions and velocities as xy pairs, ages and lifetimes; all but the velocities are uploaded */
+    std::vector<float> positions{}, velocities{}, ages{}, lifetimes{};
+    Resource::Buffer cpu_buffer{};
+    Resource::VertexArray cpu_vertex_array{};
+};
+
+}; // namespace ParticleSystem
+#endif
@@ -0,0 +1,504 @@
+#include "RenderGraph.hpp"
+
+#include <fmt/core.h>
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <queue>
+#include <utility>
+
+namespace RenderGraph
+{
+
+static bool isDepthFormat(GLenum internal_format) noexcept;
+static void allocateStorage(GLuint name, GLenum internal_format, GLsizei width, GLsizei height) noexcept;
+
+PassBuilder::PassBuilder(Graph &owner, std::size_t pass_index) noexcept : graph{owner}, pass{pass_index}
+{
+}
+
+ResourceId
+PassBuilder::create(const std::string &name, const TextureDesc &desc)
+{
+    graph.textures.push_back({name, desc, false, 0, 0, 0, 0, 0, false});
+    const ResourceId id = graph.addVersion(graph.textures.size() - 1, pass);
+    graph.passes[pass].overwritten.push_back(Graph::NO_RESOURCE);
+    graph.passes[pass].writes.push_back(id);
+    return id;
+}
+
+void
+PassBuilder::read(ResourceId id)
+{
+    if (id >= graph.versions.size()) {
+        fmt::print(stderr, "PassBuilder::read: Pass {} reads an unknown resource.\n", graph.passes[pass].name);
+        return;
+    }
+    graph.versions[id].readers.push_back(pass);
+    graph.passes[pass].reads.push_back(id);
+}
+
+ResourceId
+PassBuilder::write(ResourceId id)
+{
+    if (id >= graph.versions.size()) {
+        fmt::print(stderr, "PassBuilder::write: Pass {} writes an unknown resource.\n", graph.passes[pass].name);
+        return Graph::NO_RESOURCE;
+    }
+    const ResourceId written = graph.addVersion(graph.versions[id].texture, pass);
+    graph.passes[pass].overwritten.push_back(id);
+    graph.passes[pass].writes.push_back(written);
+    return written;
+}
+
+void
+PassBuilder::setSideEffect(void) noexcept
+{
+    graph.passes[pass].has_side_effect = true;
+}
+
+PassContext::PassContext(const Graph &owner, GLsizei target_width, GLsizei target_height) noexcept : graph{owner}, width{target_width}, height{target_height}
+{
+}
+
+GLuint
+PassContext::getTexture(ResourceId id) const noexcept
+{
+    return graph.getPhysicalTexture(id);
+}
+
+void
+PassContext::bindTexture(ResourceId id, GLuint unit) const noexcept
+{
+    glActiveTexture(GL_TEXTURE0 + unit);
+    glBindTexture(GL_TEXTURE_2D, graph.getPhysicalTexture(id));
+}
+
+GLsizei
+PassContext::getWidth(void) const noexcept
+{
+    return width;
+}
+
+GLsizei
+PassContext::getHeight(void) const noexcept
+{
+    return height;
+}
+
+Graph::Graph(void)
+{
+    textures.push_back({"backbuffer", {GL_RGBA8, 1.0f}, true, 0, 0, 0, 0, 0, false});
+    backbuffer = addVersion(0, NO_PASS);
+}
+
+ResourceId
+Graph::getBackbuffer(void) const noexcept
+{
+    return backbuffer;
+}
+
+void
+Graph::addPass(const std::string &name, const SetupFunction &setup, ExecuteFunction execute)
+{
+    passes.push_back({name, std::move(execute), {}, {}, {}, false, false, false, {}, 0, 0});
+    PassBuilder builder{*this, passes.size() - 1};
+    setup(builder);
+}
+
+bool
+Graph::compile(GLsizei width, GLsizei height, bool alias)
+{
+    order.clear();
+    physical_textures.clear();
+    for (Pass &pass : passes) {
+        pass.framebuffer.reset();
+    }
+    output_width = width;
+    output_height = height;
+
+    cullPasses();
+    if (!orderPasses()) {
+        order.clear();
+        return false;
+    }
+    computeLifetimes(width, height);
+    allocateTextures(alias);
+    if (!createFramebuffers()) {
+        order.clear();
+        return false;
+    }
+    return true;
+}
+
+void
+Graph::execute(GLuint backbuffer_framebuffer) const
+{
+    for (std::size_t index : order) {
+        const Pass &pass = passes[index];
+        glBindFramebuffer(GL_FRAMEBUFFER, pass.writes_backbuffer ? backbuffer_framebuffer : pass.framebuffer.get());
+        glViewport(0, 0, pass.width, pass.height);
+        pass.execute(PassContext{*this, pass.width, pass.height});
+    }
+    glBindFramebuffer(GL_FRAMEBUFFER, backbuffer_framebuffer);
+    glViewport(0, 0, output_width, output_height);
+}
+
+const MemoryStats &
+Graph::getMemoryStats(void) const noexcept
+{
+    return stats;
+}
+
+std::vector<std::string>
+Graph::getExecutionOrder(void) const
+{
+    std::vector<std::string> names{};
+    names.reserve(order.size());
+    for (std::size_t index : order) {
+        names.push_back(passes[index].name);
+    }
+    return names;
+}
+
+void
+Graph::printSummary(void) const
+{
+    static constexpr double MEBIBYTE{1024.0 * 1024.0};
+    fmt::print("Render graph: {} passes, {} culled\n", stats.passes, stats.culled_passes);
+    fmt::print("  order:");
+    for (const std::string &name : getExecutionOrder()) {
+        fmt::print(" {}", name);
+    }
+    fmt::print("\n");
+    if (0 != stats.culled_passes) {
+        fmt::print("  culled:");
+        for (const Pass &pass : passes) {
+            if (!pass.is_live) {
+                fmt::print(" {}", pass.name);
+            }
+        }
+        fmt::print("\n");
+    }
+    for (const Texture &texture : textures) {
+        if (texture.is_imported || !texture.is_used) {
+            continue;
+        }
+        fmt::print("  {:<14} {:>5}x{:<5} passes {}-{} texture {}\n", texture.name, texture.width, texture.height, texture.first_use, texture.last_use,
+                   texture.physical);
+    }
+    fmt::print("  {} transients in {} textures: {:.2f} MiB without aliasing, {:.2f} MiB allocated, {:.2f} MiB peak live\n", stats.virtual_textures,
+               stats.physical_textures, static_cast<double>(stats.unaliased_bytes) / MEBIBYTE, static_cast<double>(stats.aliased_bytes) / MEBIBYTE,
+               static_cast<double>(stats.peak_live_bytes) / MEBIBYTE);
+}
+
+ResourceId
+Graph::addVersion(std::size_t texture, std::size_t producer)
+{
+    versions.push_back({texture, producer, {}});
+    return static_cast<ResourceId>(versions.size() - 1);
+}
+
+/* A pass is live if it writes the backbuffer, has a side effect or produces something a live pass consumes */
+void
+Graph::cullPasses(void)
+{
+    std::vector<std::size_t> pending{};
+    for (std::size_t i = 0; i < passes.size(); ++i) {
+        Pass &pass = passes[i];
+        pass.is_live = pass.has_side_effect || std::any_of(pass.writes.begin(), pass.writes.end(), [this](ResourceId id) {
+                           return textures[versions[id].texture].is_imported;
+                       });
+        if (pass.is_live) {
+            pending.push_back(i);
+        }
+    }
+
+    auto keep_producer = [this, &pending](ResourceId id) {
+        if (NO_RESOURCE == id) {
+            return;
+        }
+        const std::size_t producer = versions[id].producer;
+        if (NO_PASS != producer && !passes[producer].is_live) {
+            passes[producer].is_live = true;
+            pending.push_back(producer);
+        }
+    };
+    while (!pending.empty()) {
+        const Pass &pass = passes[pending.back()];
+        pending.pop_back();
+        std::for_each(pass.reads.begin(), pass.reads.end(), keep_producer);
+        /* Writes load the previous contents */
+        std::for_each(pass.overwritten.begin(), pass.overwritten.end(), keep_producer);
+    }
+
+    const auto live = static_cast<std::size_t>(std::count_if(passes.begin(), passes.end(), [](const Pass &pass) { return pass.is_live; }));
+    stats.passes = live;
+    stats.culled_passes = passes.size() - live;
+}
+
+/*
+ * Topological sort of the live passes, ties broken by declaration order. Readers come after the producer of what
+ * they read, writers after the producer of the version they overwrite and after every pass still reading it.
+ */
+bool
+Graph::orderPasses(void)
+{
+    std::vector<std::vector<std::size_t>> successors(passes.size());
+    std::vector<std::size_t> predecessor_count(passes.size(), 0);
+    auto add_edge = [this, &successors, &predecessor_count](std::size_t from, std::size_t to) {
+        if (NO_PASS == from || from == to || !passes[from].is_live) {
+            return;
+        }
+        successors[from].push_back(to);
+        ++predecessor_count[to];
+    };
+
+    for (std::size_t i = 0; i < passes.size(); ++i) {
+        const Pass &pass = passes[i];
+        if (!pass.is_live) {
+            continue;
+        }
+        for (ResourceId id : pass.reads) {
+            add_edge(versions[id].producer, i);
+            /* Sampling a texture while rendering to it is a feedback loop */
+            const bool is_written = std::any_of(pass.writes.begin(), pass.writes.end(), [this, id](ResourceId written) {
+                return versions[written].texture == versions[id].texture;
+            });
+            if (is_written) {
+                fmt::print(stderr, "Graph::orderPasses: Pass {} reads and writes {}.\n", pass.name, textures[versions[id].texture].name);
+                return false;
+            }
+        }
+        for (ResourceId id : pass.overwritten) {
+            if (NO_RESOURCE == id) {
+                continue;
+            }
+            add_edge(versions[id].producer, i);
+            for (std::size_t reader : versions[id].readers) {
+                add_edge(reader, i);
+            }
+        }
+    }
+
+    std::priority_queue<std::size_t, std::vector<std::size_t>, std::greater<>> ready{};
+    for (std::size_t i = 0; i < passes.size(); ++i) {
+        if (passes[i].is_live && 0 == predecessor_count[i]) {
+            ready.push(i);
+        }
+    }
+    while (!ready.empty()) {
+        const std::size_t index = ready.top();
+        ready.pop();
+        order.push_back(index);
+        for (std::size_t successor : successors[index]) {
+            if (0 == --predecessor_count[successor]) {
+                ready.push(successor);
+            }
+        }
+    }
+    if (order.size() != stats.passes) {
+        fmt::print(stderr, "Graph::orderPasses: {}\n", "The passes depend on each other in a cycle.");
+        return false;
+    }
+    return true;
+}
+
+/* First and last position in the execution order where each texture is used */
+void
+Graph::computeLifetimes(GLsizei width, GLsizei height)
+{
+    for (Texture &texture : textures) {
+        texture.is_used = false;
+        texture.width = std::max(static_cast<GLsizei>(std::lround(static_cast<float>(width) * texture.desc.scale)), 1);
+        texture.height = std::max(static_cast<GLsizei>(std::lround(static_cast<float>(height) * texture.desc.scale)), 1);
+    }
+    auto use = [this](ResourceId id, std::size_t position) {
+        Texture &texture = textures[versions[id].texture];
+        if (!texture.is_used) {
+            texture.is_used = true;
+            texture.first_use = position;
+        }
+        texture.last_use = position;
+    };
+    for (std::size_t position = 0; position < order.size(); ++position) {
+        const Pass &pass = passes[order[position]];
+        for (ResourceId id : pass.reads) {
+            use(id, position);
+        }
+        for (ResourceId id : pass.writes) {
+            use(id, position);
+        }
+    }
+}
+
+/*
+ * Greedy interval assignment in order of first use: a transient takes the first texture of the same format and
+ * size that is free by then, GL orders the passes sharing it so aliasing needs no extra synchronisation.
+ */
+void
+Graph::allocateTextures(bool alias)
+{
+    std::vector<std::size_t> transients{};
+    for (std::size_t i = 0; i < textures.size(); ++i) {
+        if (textures[i].is_used && !textures[i].is_imported) {
+            transients.push_back(i);
+        }
+    }
+    std::stable_sort(transients.begin(), transients.end(), [this](std::size_t lhs, std::size_t rhs) {
+        return textures[lhs].first_use < textures[rhs].first_use;
+    });
+
+    stats.virtual_textures = transients.size();
+    stats.unaliased_bytes = 0;
+    stats.aliased_bytes = 0;
+    for (std::size_t index : transients) {
+        Texture &texture = textures[index];
+        const std::size_t bytes = Resource::estimateTextureSize(texture.width, texture.height, static_cast<GLint>(texture.desc.internal_format), false);
+        stats.unaliased_bytes += bytes;
+
+        auto free_texture = physical_textures.end();
+        if (alias) {
+            free_texture = std::find_if(physical_textures.begin(), physical_textures.end(), [&texture](const PhysicalTexture &physical) {
+                return physical.internal_format == texture.desc.internal_format && physical.width == texture.width && physical.height == texture.height &&
+                       physical.last_use < texture.first_use;
+            });
+        }
+        if (physical_textures.end() == free_texture) {
+            Resource::Texture handle = Resource::Texture::create();
+            allocateStorage(handle.get(), texture.desc.internal_format, texture.width, texture.height);
+            handle.setSize(bytes);
+            physical_textures.push_back({std::move(handle), texture.desc.internal_format, texture.width, texture.height, 0, bytes});
+            stats.aliased_bytes += bytes;
+            free_texture = physical_textures.end() - 1;
+        }
+        free_texture->last_use = texture.last_use;
+        texture.physical = static_cast<std::size_t>(free_texture - physical_textures.begin());
+    }
+    stats.physical_textures = physical_textures.size();
+
+    stats.peak_live_bytes = 0;
+    for (std::size_t position = 0; position < order.size(); ++position) {
+        std::size_t live_bytes = 0;
+        for (std::size_t index : transients) {
+            const Texture &texture = textures[index];
+            if (texture.first_use <= position && position <= texture.last_use) {
+                live_bytes += physical_textures[texture.physical].bytes;
+            }
+        }
+        stats.peak_live_bytes = std::max(stats.peak_live_bytes, live_bytes);
+    }
+}
+
+/* Passes writing the backbuffer render to the one given to execute(), the others to a framebuffer made of what they write */
+bool
+Graph::createFramebuffers(void)
+{
+    for (std::size_t index : order) {
+        Pass &pass = passes[index];
+        pass.width = output_width;
+        pass.height = output_height;
+        pass.writes_backbuffer = std::any_of(pass.writes.begin(), pass.writes.end(), [this](ResourceId id) {
+            return textures[versions[id].texture].is_imported;
+        });
+        if (pass.writes_backbuffer) {
+            if (1 != pass.writes.size()) {
+                fmt::print(stderr, "Graph::createFramebuffers: Pass {} writes the backbuffer along with other textures.\n", pass.name);
+                return false;
+            }
+            continue;
+        }
+        if (pass.writes.empty()) {
+            continue;
+        }
+
+        pass.framebuffer = Resource::Framebuffer::create();
+        glBindFramebuffer(GL_FRAMEBUFFER, pass.framebuffer.get());
+        std::vector<GLenum> draw_buffers{};
+        for (ResourceId id : pass.writes) {
+            const Texture &texture = textures[versions[id].texture];
+            if (texture.width != textures[versions[pass.writes.front()].texture].width ||
+                texture.height != textures[versions[pass.writes.front()].texture].height) {
+                fmt::print(stderr, "Graph::createFramebuffers: Pass {} writes textures of different sizes.\n", pass.name);
+                glBindFramebuffer(GL_FRAMEBUFFER, 0);
+                return false;
+            }
+            pass.width = texture.width;
+            pass.height = texture.height;
+            GLenum attachment = GL_COLOR_ATTACHMENT0 + static_cast<GLenum>(draw_buffers.size());
+            if (GL_DEPTH24_STENCIL8 == texture.desc.internal_format) {
+                attachment = GL_DEPTH_STENCIL_ATTACHMENT;
+            } else if (isDepthFormat(texture.desc.internal_format)) {
+                attachment = GL_DEPTH_ATTACHMENT;
+            } else {
+                draw_buffers.push_back(attachment);
+            }
+            glFramebufferTexture2D(GL_FRAMEBUFFER, attachment, GL_TEXTURE_2D, physical_textures[texture.physical].texture.get(), 0);
+        }
+        if (draw_buffers.empty()) {
+            glDrawBuffer(GL_NONE);
+        } else {
+            glDrawBuffers(static_cast<GLsizei>(draw_buffers.size()), draw_buffers.data());
+        }
+        const GLenum status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        if (GL_FRAMEBUFFER_COMPLETE != status) {
+            fmt::print(stderr, "Graph::createFramebuffers: Framebuffer of pass {} is incomplete, status 0x{:X}.\n", pass.name, status);
+            return false;
+        }
+    }
+    return true;
+}
+
+GLuint
+Graph::getPhysicalTexture(ResourceId id) const noexcept
+{
+    if (id >= versions.size()) {
+        return 0;
+    }
+    const Texture &texture = textures[versions[id].texture];
+    if (texture.is_imported || !texture.is_used) {
+        return 0;
+    }
+    return physical_textures[texture.physical].texture.get();
+}
+
+static bool
+isDepthFormat(GLenum internal_format) noexcept
+{
+    switch (internal_format) {
+    case GL_DEPTH_COMPONENT16:
+    case GL_DEPTH_COMPONENT24:
+    case GL_DEPTH_COMPONENT32F:
+    case GL_DEPTH24_STENCIL8:
+        return true;
+    default:
+        return false;
+    }
+}
+
+/* No data is uploaded, the format and type only have to be compatible with the internal format */
+static void
+allocateStorage(GLuint name, GLenum internal_format, GLsizei width, GLsizei height) noexcept
+{
+    GLenum format = GL_RGBA;
+    GLenum type = GL_UNSIGNED_BYTE;
+    if (GL_DEPTH24_STENCIL8 == internal_format) {
+        format = GL_DEPTH_STENCIL;
+        type = GL_UNSIGNED_INT_24_8;
+    } else if (isDepthFormat(internal_format)) {
+        format = GL_DEPTH_COMPONENT;
+        type = GL_FLOAT;
+    }
+    const GLint filter = isDepthFormat(internal_format) ? GL_NEAREST : GL_LINEAR;
+    glBindTexture(GL_TEXTURE_2D, name);
+    glTexImage2D(GL_TEXTURE_2D, 0, static_cast<GLint>(internal_format), width, height, 0, format, type, nullptr);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, filter);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, filter);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glBindTexture(GL_TEXTURE_2D, 0);
+}
+
+}; // namespace RenderGraph
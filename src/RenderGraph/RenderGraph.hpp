@@ -0,0 +1,194 @@
+#ifndef RENDERGRAPH_HPP
+#define RENDERGRAPH_HPP
+
+#include <glad/glad.h>
+
+#include "Resource.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace RenderGraph
+{
+
+/* One version of a texture, every write returns a new one so that each version has a single producer */
+using ResourceId = std::uint32_t;
+
+struct TextureDesc
+{
+    GLenum internal_format;
+    /* Size relative to the output */
+    float scale = 1.0f;
+};
+
+struct MemoryStats
+{
+    std::size_t passes;
+    std::size_t culled_passes;
+    /* Transient textures declared by the passes that survived culling */
+    std::size_t virtual_textures;
+    /* GL textures backing them */
+    std::size_t physical_textures;
+    /* Render target memory if every transient had its own texture */
+    std::size_t unaliased_bytes;
+    /* Render target memory actually allocated */
+    std::size_t aliased_bytes;
+    /* Largest sum of the transients alive at the same point, the best aliasing could do */
+    std::size_t peak_live_bytes;
+};
+
+class Graph;
+
+/* Declares what a pass reads and writes while it is being added */
+class PassBuilder
+{
+  public:
+    /* A transient texture written by this pass, its contents are undefined until then */
+    ResourceId create(const std::string &name, const TextureDesc &desc);
+    /* Sampled by the pass */
+    void read(ResourceId id);
+    /* Rendered to by the pass on top of the previous contents */
+    ResourceId write(ResourceId id);
+    /* Never culled even if nothing reads what it writes, for queries or readbacks */
+    void setSideEffect(void) noexcept;
+
+  private:
+    friend class Graph;
+
+    PassBuilder(Graph &owner, std::size_t pass_index) noexcept;
+
+    Graph &graph;
+    std::size_t pass;
+};
+
+/* What a pass may use while it executes, its render target is already bound */
+class PassContext
+{
+  public:
+    GLuint getTexture(ResourceId id) const noexcept;
+    void bindTexture(ResourceId id, GLuint unit) const noexcept;
+    GLsizei getWidth(void) const noexcept;
+    GLsizei getHeight(void) const noexcept;
+
+  private:
+    friend class Graph;
+
+    PassContext(const Graph &owner, GLsizei target_width, GLsizei target_height) noexcept;
+
+    const Graph &graph;
+    GLsizei width, height;
+};
+
+/*
+ * Frame described as passes declaring the textures they read and write.
+ * compile() culls the passes whose results never reach the backbuffer or a side effect, orders the others so that
+ * every read sees its producer and no write clobbers a version still to be read, then backs the transient textures
+ * with GL textures. Transients with the same format and size whose lifetimes do not overlap share a texture.
+ */
+class Graph
+{
+  public:
+    using SetupFunction = std::function<void(PassBuilder &)>;
+    using ExecuteFunction = std::function<void(const PassContext &)>;
+
+    Graph(void);
+    ~Graph() noexcept = default;
+
+    Graph(const Graph &) = delete;
+    Graph(Graph &&) = delete;
+    Graph &operator=(const Graph &) = delete;
+    Graph &operator=(Graph &&) = delete;
+
+    /* The default framebuffer, imported so that writing it keeps a pass alive */
+    ResourceId getBackbuffer(void) const noexcept;
+
+    void addPass(const std::string &name, const SetupFunction &setup, ExecuteFunction execute);
+
+    /* Order the passes and allocate the transients for an output of width by height, false if the graph is invalid */
+    bool compile(GLsizei width, GLsizei height, bool alias = true);
+    /* Run the compiled passes in order, the backbuffer being the given framebuffer, which is bound again afterwards */
+    void execute(GLuint backbuffer_framebuffer = 0) const;
+
+    const MemoryStats &getMemoryStats(void) const noexcept;
+    /* Names of the compiled passes in execution order */
+    std::vector<std::string> getExecutionOrder(void) const;
+    void printSummary(void) const;
+
+  private:
+    friend class PassBuilder;
+    friend class PassContext;
+
+    struct Texture
+    {
+        std::string name;
+        TextureDesc desc;
+        bool is_imported;
+        /* Compiled state */
+        GLsizei width, height;
+        std::size_t first_use, last_use;
+        std::size_t physical;
+        bool is_used;
+    };
+
+    struct Version
+    {
+        std::size_t texture;
+        /* Index of the pass that wrote it, NO_PASS for the first version */
+        std::size_t producer;
+        std::vector<std::size_t> readers;
+    };
+
+    struct Pass
+    {
+        std::string name;
+        ExecuteFunction execute;
+        std::vector<ResourceId> reads;
+        /* Version each write replaced, NO_RESOURCE for created textures, and the one it produced */
+        std::vector<ResourceId> overwritten;
+        std::vector<ResourceId> writes;
+        bool has_side_effect;
+        /* Compiled state */
+        bool is_live;
+        bool writes_backbuffer;
+        Resource::Framebuffer framebuffer;
+        GLsizei width, height;
+    };
+
+    struct PhysicalTexture
+    {
+        Resource::Texture texture;
+        GLenum internal_format;
+        GLsizei width, height;
+        std::size_t last_use;
+        std::size_t bytes;
+    };
+
+    static constexpr std::size_t NO_PASS{static_cast<std::size_t>(-1)};
+    static constexpr ResourceId NO_RESOURCE{static_cast<ResourceId>(-1)};
+
+    ResourceId addVersion(std::size_t texture, std::size_t producer);
+    void cullPasses(void);
+    bool orderPasses(void);
+    void computeLifetimes(GLsizei width, GLsizei height);
+    void allocateTextures(bool alias);
+    bool createFramebuffers(void);
+    GLuint getPhysicalTexture(ResourceId id) const noexcept;
+
+    std::vector<Texture> textures{};
+    std::vector<Version> versions{};
+    std::vector<Pass> passes{};
+    ResourceId backbuffer;
+
+    std::vector<std::size_t> order{};
+    std::vector<PhysicalTexture> physical_textures{};
+    MemoryStats stats{};
+    GLsizei output_width = 0;
+    GLsizei output_height = 0;
+};
+
+}; // namespace RenderGraph
+
+#endif
@@ -0,0 +1,254 @@
+#include "Resource.hpp"
+
+#include <algorithm>
+#include <fmt/core.h>
+
+namespace Resource
+{
+
+const char *
+getCategoryName(Category category) noexcept
+{
+    switch (category) {
+    case Category::BUFFER:
+        return "buffers";
+    case Category::TEXTURE:
+        return "textures";
+    case Category::VERTEX_ARRAY:
+        return "vertex arrays";
+    case Category::PROGRAM:
+        return "programs";
+    case Category::FRAMEBUFFER:
+        return "framebuffers";
+    default:
+        return "unknown";
+    }
+}
+
+std::size_t
+estimateTextureSize(GLsizei width, GLsizei height, GLint internal_format, bool has_mipmaps) noexcept
+{
+    std::size_t bytes_per_texel = 4;
+    switch (internal_format) {
+    case GL_R8:
+        bytes_per_texel = 1;
+        break;
+    case GL_RG8:
+    case GL_R16F:
+        bytes_per_texel = 2;
+        break;
+    case GL_RGB:
+    case GL_RGB8:
+    case GL_SRGB8:
+        /* Drivers pad three channel textures to four */
+        bytes_per_texel = 4;
+        break;
+    case GL_RGBA16F:
+        bytes_per_texel = 8;
+        break;
+    case GL_RGBA32F:
+        bytes_per_texel = 16;
+        break;
+    default:
+        break;
+    }
+    const std::size_t base_level = static_cast<std::size_t>(width) * static_cast<std::size_t>(height) * bytes_per_texel;
+    return has_mipmaps ? base_level + base_level / 3 : base_level;
+}
+
+ResourceTracker &
+ResourceTracker::getInstance(void)
+{
+    static ResourceTracker tracker{};
+    return tracker;
+}
+
+Record *
+ResourceTracker::add(Category category, GLuint name, bool is_evictable)
+{
+    auto record = std::make_unique<Record>(Record{name, category, 0, is_evictable, 0});
+    Record *pointer = record.get();
+
+    std::lock_guard lock{mutex};
+    pointer->last_used_frame = frame;
+    records.emplace(pointer, std::move(record));
+    ++usage[static_cast<std::size_t>(category)].objects;
+    return pointer;
+}
+
+void
+ResourceTracker::remove(Record *record) noexcept
+{
+    std::lock_guard lock{mutex};
+    CategoryUsage &category_usage = usage[static_cast<std::size_t>(record->category)];
+    category_usage.bytes -= record->bytes;
+    --category_usage.objects;
+    total_bytes -= record->bytes;
+    records.erase(record);
+}
+
+void
+ResourceTracker::resize(Record *record, std::size_t bytes) noexcept
+{
+    std::lock_guard lock{mutex};
+    /* An evicted object holds no memory until it is created again */
+    if (0 == record->name) {
+        return;
+    }
+    CategoryUsage &category_usage = usage[static_cast<std::size_t>(record->category)];
+    category_usage.bytes = category_usage.bytes - record->bytes + bytes;
+    total_bytes = total_bytes - record->bytes + bytes;
+    record->bytes = bytes;
+    record->last_used_frame = frame;
+}
+
+void
+ResourceTracker::touch(Record *record) noexcept
+{
+    /* Loader threads add and resize records while the render thread evicts */
+    std::lock_guard lock{mutex};
+    record->last_used_frame = frame;
+}
+
+void
+ResourceTracker::setEvictable(Record *record, bool is_evictable) noexcept
+{
+    std::lock_guard lock{mutex};
+    record->is_evictable = is_evictable;
+    record->last_used_frame = frame;
+}
+
+void
+ResourceTracker::setBudget(std::size_t bytes) noexcept
+{
+    std::lock_guard lock{mutex};
+    budget_bytes = bytes;
+}
+
+void
+ResourceTracker::beginFrame(void) noexcept
+{
+    std::lock_guard lock{mutex};
+    if (0 == budget_bytes || total_bytes <= budget_bytes) {
+        ++frame;
+        return;
+    }
+
+    /* Only what was not used during the frame that just ended may go */
+    std::vector<Record *> candidates{};
+    for (auto &[pointer, record] : records) {
+        if (record->is_evictable && 0 != record->name && 0 != record->bytes && record->last_used_frame < frame) {
+            candidates.push_back(pointer);
+        }
+    }
+    std::sort(candidates.begin(), candidates.end(), [](const Record *lhs, const Record *rhs) {
+        return lhs->last_used_frame < rhs->last_used_frame;
+    });
+
+    for (Record *record : candidates) {
+        if (total_bytes <= budget_bytes) {
+            break;
+        }
+        TextureTraits::destroy(record->name);
+        record->name = 0;
+        CategoryUsage &category_usage = usage[static_cast<std::size_t>(record->category)];
+        category_usage.bytes -= record->bytes;
+        total_bytes -= record->bytes;
+        record->bytes = 0;
+        ++evictions;
+    }
+    ++frame;
+}
+
+Report
+ResourceTracker::getReport(void) const noexcept
+{
+    std::lock_guard lock{mutex};
+    return {usage, total_bytes, budget_bytes, evictions};
+}
+
+void
+ResourceTracker::printReport(void) const
+{
+    static constexpr double MEBIBYTE{1024.0 * 1024.0};
+    const Report report = getReport();
+    fmt::print("GPU resources: {:.2f} MiB", static_cast<double>(report.total_bytes) / MEBIBYTE);
+    if (0 != report.budget_bytes) {
+        fmt::print(" of {:.2f} MiB budget, {} evictions", static_cast<double>(report.budget_bytes) / MEBIBYTE, report.evictions);
+    }
+    fmt::print("\n");
+    for (std::size_t i = 0; i < report.categories.size(); ++i) {
+        fmt::print("  {:<14} {:>6} objects {:>10.2f} MiB\n", getCategoryName(static_cast<Category>(i)), report.categories[i].objects,
+                   static_cast<double>(report.categories[i].bytes) / MEBIBYTE);
+    }
+}
+
+GLuint
+BufferTraits::create(void) noexcept
+{
+    GLuint name = 0;
+    glGenBuffers(1, &name);
+    return name;
+}
+
+void
+BufferTraits::destroy(GLuint name) noexcept
+{
+    glDeleteBuffers(1, &name);
+}
+
+GLuint
+TextureTraits::create(void) noexcept
+{
+    GLuint name = 0;
+    glGenTextures(1, &name);
+    return name;
+}
+
+void
+TextureTraits::destroy(GLuint name) noexcept
+{
+    glDeleteTextures(1, &name);
+}
+
+GLuint
+VertexArrayTraits::create(void) noexcept
+{
+    GLuint name = 0;
+    glGenVertexArrays(1, &name);
+    return name;
+}
+
+void
+VertexArrayTraits::destroy(GLuint name) noexcept
+{
+    glDeleteVertexArrays(1, &name);
+}
+
+GLuint
+ProgramTraits::create(void) noexcept
+{
+    return glCreateProgram();
+}
+
+void
+ProgramTraits::destroy(GLuint name) noexcept
+{
+    glDeleteProgram(name);
+}
+
+GLuint
+FramebufferTraits::create(void) noexcept
+{
+    GLuint name = 0;
+    glGenFramebuffers(1, &name);
+    return name;
+}
+
+void
+FramebufferTraits::destroy(GLuint name) noexcept
+{
+    glDeleteFramebuffers(1, &name);
+}
+
+}; // namespace Resource
@@ -0,0 +1,265 @@
+#ifndef RESOURCE_HPP
+#define RESOURCE_HPP
+
+#include <glad/glad.h>
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace Resource
+{
+
+enum class Category : std::size_t
+{
+    BUFFER,
+    TEXTURE,
+    VERTEX_ARRAY,
+    PROGRAM,
+    FRAMEBUFFER,
+    COUNT
+};
+
+const char *getCategoryName(Category category) noexcept;
+
+struct CategoryUsage
+{
+    std::size_t bytes, objects;
+};
+
+struct Report
+{
+    std::array<CategoryUsage, static_cast<std::size_t>(Category::COUNT)> categories;
+    std::size_t total_bytes, budget_bytes;
+    std::uint64_t evictions;
+};
+
+/* Estimated footprint of a texture, mipmaps add a third */
+std::size_t estimateTextureSize(GLsizei width, GLsizei height, GLint internal_format, bool has_mipmaps) noexcept;
+
+/* Bookkeeping entry shared between a handle and the tracker */
+struct Record
+{
+    GLuint name;
+    Category category;
+    std::size_t bytes;
+    bool is_evictable;
+    std::uint64_t last_used_frame;
+};
+
+/*
+ * Accounts for every GL object owned by a handle and the estimated GPU memory it uses.
+ * Once over budget, the least recently used evictable textures are deleted at the start of a frame,
+ * their handles then report they are no longer resident so the owner can reload them.
+ */
+class ResourceTracker
+{
+  public:
+    static ResourceTracker &getInstance(void);
+
+    Record *add(Category category, GLuint name, bool is_evictable);
+    void remove(Record *record) noexcept;
+    void resize(Record *record, std::size_t bytes) noexcept;
+    void touch(Record *record) noexcept;
+    void setEvictable(Record *record, bool is_evictable) noexcept;
+
+    /* 0 disables the budget */
+    void setBudget(std::size_t bytes) noexcept;
+
+    /* Advance the LRU clock and evict textures until the budget is met */
+    void beginFrame(void) noexcept;
+
+    Report getReport(void) const noexcept;
+    void printReport(void) const;
+
+    ResourceTracker(const ResourceTracker &) = delete;
+    ResourceTracker(ResourceTracker &&) = delete;
+    ResourceTracker &operator=(const ResourceTracker &) = delete;
+    ResourceTracker &operator=(ResourceTracker &&) = delete;
+
+  private:
+    ResourceTracker() = default;
+    ~ResourceTracker() = default;
+
+    mutable std::mutex mutex{};
+    std::unordered_map<Record *, std::unique_ptr<Record>> records{};
+    std::array<CategoryUsage, static_cast<std::size_t>(Category::COUNT)> usage{};
+    std::size_t total_bytes = 0;
+    std::size_t budget_bytes = 0;
+    std::uint64_t frame = 0;
+    std::uint64_t evictions = 0;
+};
+
+struct BufferTraits
+{
+    static constexpr Category CATEGORY{Category::BUFFER};
+    static GLuint create(void) noexcept;
+    static void destroy(GLuint name) noexcept;
+};
+
+struct TextureTraits
+{
+    static constexpr Category CATEGORY{Category::TEXTURE};
+    static GLuint create(void) noexcept;
+    static void destroy(GLuint name) noexcept;
+};
+
+struct VertexArrayTraits
+{
+    static constexpr Category CATEGORY{Category::VERTEX_ARRAY};
+    static GLuint create(void) noexcept;
+    static void destroy(GLuint name) noexcept;
+};
+
+struct ProgramTraits
+{
+    static constexpr Category CATEGORY{Category::PROGRAM};
+    static GLuint create(void) noexcept;
+    static void destroy(GLuint name) noexcept;
+};
+
+struct FramebufferTraits
+{
+    static constexpr Category CATEGORY{Category::FRAMEBUFFER};
+    static GLuint create(void) noexcept;
+    static void destroy(GLuint name) noexcept;
+};
+
+/* Deletes the GL object it owns, must be reset while the context is still current */
+template <class Traits>
+class Handle
+{
+  public:
+    Handle(void) noexcept = default;
+
+    static Handle
+    create(bool is_evictable = false)
+    {
+        return Handle{Traits::create(), is_evictable};
+    }
+
+    /* Take ownership of an object created elsewhere, glCreateProgram for instance */
+    static Handle
+    adopt(GLuint name, bool is_evictable = false)
+    {
+        return Handle{name, is_evictable};
+    }
+
+    ~Handle() noexcept
+    {
+        reset();
+    }
+
+    Handle(Handle &&handle) noexcept : record{handle.record}
+    {
+        handle.record = nullptr;
+    }
+
+    Handle &
+    operator=(Handle &&handle) noexcept
+    {
+        if (this != &handle) {
+            reset();
+            record = handle.record;
+            handle.record = nullptr;
+        }
+        return *this;
+    }
+
+    Handle(const Handle &) = delete;
+    Handle &operator=(const Handle &) = delete;
+
+    /* 0 once reset or evicted */
+    GLuint
+    get(void) const noexcept
+    {
+        return nullptr == record ? 0 : record->name;
+    }
+
+    bool
+    isResident(void) const noexcept
+    {
+        return 0 != get();
+    }
+
+    /* Update the estimated memory footprint, after a glBufferData or glTexImage2D for instance */
+    void
+    setSize(std::size_t bytes) noexcept
+    {
+        if (nullptr != record) {
+            ResourceTracker::getInstance().resize(record, bytes);
+        }
+    }
+
+    /*
+     * Only from the render thread, once nothing else uses the object anymore: an evictable object may be deleted
+     * at the start of any frame
+     */
+    void
+    setEvictable(bool is_evictable) noexcept
+    {
+        if (nullptr != record) {
+            ResourceTracker::getInstance().setEvictable(record, is_evictable);
+        }
+    }
+
+    /* Mark as used this frame so it is the last to be evicted */
+    void
+    touch(void) const noexcept
+    {
+        if (nullptr != record) {
+            ResourceTracker::getInstance().touch(record);
+        }
+    }
+
+    void
+    reset(void) noexcept
+    {
+        if (nullptr == record) {
+            return;
+        }
+        if (0 != record->name) {
+            Traits::destroy(record->name);
+        }
+        ResourceTracker::getInstance().remove(record);
+        record = nullptr;
+    }
+
+  private:
+    Handle(GLuint name, bool is_evictable) : record{ResourceTracker::getInstance().add(Traits::CATEGORY, name, is_evictable)}
+    {
+    }
+
+    Record *record = nullptr;
+};
+
+using Buffer = Handle<BufferTraits>;
+using Texture = Handle<TextureTraits>;
+using VertexArray = Handle<VertexArrayTraits>;
+using Program = Handle<ProgramTraits>;
+using Framebuffer = Handle<FramebufferTraits>;
+
+template <class Traits, std::size_t N>
+inline void
+createAll(std::array<Handle<Traits>, N> &handles, bool is_evictable = false)
+{
+    for (Handle<Traits> &handle : handles) {
+        handle = Handle<Traits>::create(is_evictable);
+    }
+}
+
+template <class Traits, std::size_t N>
+inline void
+resetAll(std::array<Handle<Traits>, N> &handles) noexcept
+{
+    for (Handle<Traits> &handle : handles) {
+        handle.reset();
+    }
+}
+
+}; // namespace Resource
+#endif
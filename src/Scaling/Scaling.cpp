@@ -0,0 +1,233 @@
+#include "Scaling.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <fmt/core.h>
+
+namespace Scaling
+{
+
+/* Weight of the newest frame in the smoothed frame time */
+static constexpr double SMOOTHING{0.25};
+
+static GLsizei getScaledSize(GLsizei size, float scale) noexcept;
+
+ResolutionGovernor::ResolutionGovernor(const GovernorOptions &governor_options) noexcept : options{governor_options}, scale{governor_options.max_scale}
+{
+}
+
+bool
+ResolutionGovernor::update(double frame_ms)
+{
+    ++frame;
+    if (frame_ms > options.budget_ms) {
+        ++frames_over_budget;
+    }
+    smoothed_ms = smoothed_ms ? *smoothed_ms + SMOOTHING * (frame_ms - *smoothed_ms) : frame_ms;
+    if (0 < cooldown) {
+        --cooldown;
+        return false;
+    }
+
+    if (*smoothed_ms > options.budget_ms) {
+        ++frames_over;
+        frames_under = 0;
+    } else if (*smoothed_ms < options.budget_ms * options.upscale_threshold) {
+        ++frames_under;
+        frames_over = 0;
+    } else {
+        frames_over = 0;
+        frames_under = 0;
+    }
+
+    /* Aim at the middle of the dead band */
+    const double target_ms = options.budget_ms * (1.0 + options.upscale_threshold) * 0.5;
+    const float ideal = scale * static_cast<float>(std::sqrt(target_ms / std::max(*smoothed_ms, 1e-3)));
+    if (frames_over >= options.downscale_frames && scale > options.min_scale) {
+        setScale(std::min(quantize(ideal), scale - options.step));
+        return true;
+    }
+    if (frames_under >= options.upscale_frames && scale < options.max_scale && quantize(ideal) > scale) {
+        setScale(scale + options.step);
+        return true;
+    }
+    return false;
+}
+
+float
+ResolutionGovernor::getScale(void) const noexcept
+{
+    return scale;
+}
+
+const GovernorOptions &
+ResolutionGovernor::getOptions(void) const noexcept
+{
+    return options;
+}
+
+const std::vector<ScaleChange> &
+ResolutionGovernor::getTrajectory(void) const noexcept
+{
+    return trajectory;
+}
+
+std::uint64_t
+ResolutionGovernor::getFrameCount(void) const noexcept
+{
+    return frame;
+}
+
+std::uint64_t
+ResolutionGovernor::getFramesOverBudget(void) const noexcept
+{
+    return frames_over_budget;
+}
+
+float
+ResolutionGovernor::quantize(float value) const noexcept
+{
+    const float steps = std::floor(value / options.step + 1e-3f);
+    return std::clamp(steps * options.step, options.min_scale, options.max_scale);
+}
+
+void
+ResolutionGovernor::setScale(float value)
+{
+    scale = std::clamp(value, options.min_scale, options.max_scale);
+    trajectory.push_back({frame, scale, smoothed_ms.value_or(0.0)});
+    smoothed_ms.reset();
+    frames_over = 0;
+    frames_under = 0;
+    cooldown = options.cooldown_frames;
+}
+
+DynamicResolution::DynamicResolution(const GovernorOptions &governor_options) : governor{governor_options}
+{
+    glGenQueries(static_cast<GLsizei>(queries.size()), queries.data());
+}
+
+DynamicResolution::~DynamicResolution() noexcept
+{
+    glDeleteQueries(static_cast<GLsizei>(queries.size()), queries.data());
+}
+
+void
+DynamicResolution::beginFrame(GLsizei width, GLsizei height)
+{
+    window_width = width;
+    window_height = height;
+    const GLsizei scaled_width = getScaledSize(width, governor.getScale());
+    const GLsizei scaled_height = getScaledSize(height, governor.getScale());
+    if (scaled_width != target_width || scaled_height != target_height) {
+        resize(scaled_width, scaled_height);
+    }
+    glBindFramebuffer(GL_FRAMEBUFFER, framebuffer.get());
+    glViewport(0, 0, target_width, target_height);
+    glQueryCounter(queries[query_index * 2], GL_TIMESTAMP);
+    ++frames_started;
+}
+
+void
+DynamicResolution::endFrame(double cpu_ms)
+{
+    glQueryCounter(queries[query_index * 2 + 1], GL_TIMESTAMP);
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, framebuffer.get());
+    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
+    glBlitFramebuffer(0, 0, target_width, target_height, 0, 0, window_width, window_height, GL_COLOR_BUFFER_BIT, GL_LINEAR);
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    glViewport(0, 0, window_width, window_height);
+
+    query_index = (query_index + 1) % QUERY_COUNT;
+    const std::optional<double> gpu_ms = readGpuTime();
+    governor.update(std::max(cpu_ms, gpu_ms.value_or(0.0)));
+}
+
+RenderTarget
+DynamicResolution::getRenderTarget(void) const noexcept
+{
+    return {framebuffer.get(), target_width, target_height};
+}
+
+const ResolutionGovernor &
+DynamicResolution::getGovernor(void) const noexcept
+{
+    return governor;
+}
+
+void
+DynamicResolution::printTrajectory(void) const
+{
+    const GovernorOptions &options = governor.getOptions();
+    const std::uint64_t frames = governor.getFrameCount();
+    if (0 == frames) {
+        return;
+    }
+    fmt::print("Dynamic resolution: budget {:.2f} ms, {} of {} frames over budget ({:.1f}%), final scale {:.2f}\n", options.budget_ms,
+               governor.getFramesOverBudget(), frames, 100.0 * static_cast<double>(governor.getFramesOverBudget()) / static_cast<double>(frames),
+               governor.getScale());
+    fmt::print("  frame {:>6}: scale {:.2f} ({}x{})\n", 0, options.max_scale, getScaledSize(window_width, options.max_scale),
+               getScaledSize(window_height, options.max_scale));
+    for (const ScaleChange &change : governor.getTrajectory()) {
+        fmt::print("  frame {:>6}: scale {:.2f} ({}x{}) after {:.2f} ms\n", change.frame, change.scale, getScaledSize(window_width, change.scale),
+                   getScaledSize(window_height, change.scale), change.frame_ms);
+    }
+}
+
+void
+DynamicResolution::resize(GLsizei width, GLsizei height)
+{
+    if (!framebuffer.isResident()) {
+        framebuffer = Resource::Framebuffer::create();
+        colour = Resource::Texture::create();
+        depth = Resource::Texture::create();
+    }
+    target_width = width;
+    target_height = height;
+
+    glBindTexture(GL_TEXTURE_2D, colour.get());
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    colour.setSize(Resource::estimateTextureSize(width, height, GL_RGBA8, false));
+    glBindTexture(GL_TEXTURE_2D, depth.get());
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_DEPTH24_STENCIL8, width, height, 0, GL_DEPTH_STENCIL, GL_UNSIGNED_INT_24_8, nullptr);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    depth.setSize(Resource::estimateTextureSize(width, height, GL_DEPTH24_STENCIL8, false));
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    glBindFramebuffer(GL_FRAMEBUFFER, framebuffer.get());
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, colour.get(), 0);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_TEXTURE_2D, depth.get(), 0);
+    if (GL_FRAMEBUFFER_COMPLETE != glCheckFramebufferStatus(GL_FRAMEBUFFER)) {
+        fmt::print(stderr, "DynamicResolution::resize: Framebuffer of {}x{} is incomplete.\n", width, height);
+    }
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+}
+
+/* Timestamps of the oldest frame in the ring, written QUERY_COUNT - 1 frames ago so that reading them does not stall */
+std::optional<double>
+DynamicResolution::readGpuTime(void)
+{
+    if (frames_started < QUERY_COUNT) {
+        return std::nullopt;
+    }
+    GLint available = GL_FALSE;
+    glGetQueryObjectiv(queries[query_index * 2 + 1], GL_QUERY_RESULT_AVAILABLE, &available);
+    if (GL_TRUE != available) {
+        return std::nullopt;
+    }
+    GLuint64 start = 0, end = 0;
+    glGetQueryObjectui64v(queries[query_index * 2], GL_QUERY_RESULT, &start);
+    glGetQueryObjectui64v(queries[query_index * 2 + 1], GL_QUERY_RESULT, &end);
+    return static_cast<double>(end - start) * 1e-6;
+}
+
+static GLsizei
+getScaledSize(GLsizei size, float scale) noexcept
+{
+    return std::max(static_cast<GLsizei>(std::lround(static_cast<float>(size) * scale)), 1);
+}
+
+}; // namespace Scaling
@@ -0,0 +1,131 @@
+#ifndef SCALING_HPP
+#define SCALING_HPP
+
+#include <glad/glad.h>
+
+#include "Resource.hpp"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+namespace Scaling
+{
+
+/* Where the frame is rendered, the default framebuffer when the resolution is not scaled */
+struct RenderTarget
+{
+    GLuint framebuffer;
+    GLsizei width, height;
+};
+
+struct GovernorOptions
+{
+    /* Frame time to stay under */
+    double budget_ms;
+    float min_scale = 0.25f;
+    float max_scale = 1.0f;
+    /* Scales are multiples of the step so that small variations do not reallocate the target */
+    float step = 0.05f;
+    /* Scaling up only starts once the frame time is under this fraction of the budget */
+    double upscale_threshold = 0.75;
+    /* Consecutive frames over the budget before scaling down, and under the threshold before scaling up */
+    std::size_t downscale_frames = 3;
+    std::size_t upscale_frames = 30;
+    /* Frames ignored after a change, the timer queries are read a few frames late */
+    std::size_t cooldown_frames = 8;
+};
+
+struct ScaleChange
+{
+    std::uint64_t frame;
+    float scale;
+    /* Smoothed frame time that triggered the change */
+    double frame_ms;
+};
+
+/*
+ * Picks the render scale from the measured frame time. Pixel cost grows with the square of the scale, so a change
+ * aims at the budget with some margin through the square root of the ratio. Scaling down is fast and scaling up is
+ * slow and done one step at a time, with a dead band between the two thresholds so that the scale does not oscillate.
+ */
+class ResolutionGovernor
+{
+  public:
+    explicit ResolutionGovernor(const GovernorOptions &governor_options) noexcept;
+
+    /* Feed the cost of a frame, true if the scale changed */
+    bool update(double frame_ms);
+
+    float getScale(void) const noexcept;
+    const GovernorOptions &getOptions(void) const noexcept;
+    const std::vector<ScaleChange> &getTrajectory(void) const noexcept;
+    /* Frames fed and how many of them were over the budget */
+    std::uint64_t getFrameCount(void) const noexcept;
+    std::uint64_t getFramesOverBudget(void) const noexcept;
+
+  private:
+    float quantize(float value) const noexcept;
+    void setScale(float value);
+
+    GovernorOptions options;
+    float scale;
+    std::optional<double> smoothed_ms{};
+    std::size_t frames_over = 0;
+    std::size_t frames_under = 0;
+    std::size_t cooldown = 0;
+    std::uint64_t frame = 0;
+    std::uint64_t frames_over_budget = 0;
+    std::vector<ScaleChange> trajectory{};
+};
+
+/*
+ * Renders the frame offscreen at the governor's scale of the window and upscales it with a linear blit.
+ * GPU time comes from timestamp queries around the frame, so that applications can still use their own
+ * GL_TIME_ELAPSED queries.
+ */
+class DynamicResolution
+{
+  public:
+    explicit DynamicResolution(const GovernorOptions &governor_options);
+    ~DynamicResolution() noexcept;
+
+    DynamicResolution(const DynamicResolution &) = delete;
+    DynamicResolution(DynamicResolution &&) = delete;
+    DynamicResolution &operator=(const DynamicResolution &) = delete;
+    DynamicResolution &operator=(DynamicResolution &&) = delete;
+
+    /* Bind the scaled target sized for a window of width by height */
+    void beginFrame(GLsizei width, GLsizei height);
+    /* Blit to the default framebuffer and feed the governor, cpu_ms being the CPU time spent rendering */
+    void endFrame(double cpu_ms);
+
+    RenderTarget getRenderTarget(void) const noexcept;
+    const ResolutionGovernor &getGovernor(void) const noexcept;
+    void printTrajectory(void) const;
+
+  private:
+    static constexpr std::size_t QUERY_COUNT{4};
+
+    void resize(GLsizei width, GLsizei height);
+    std::optional<double> readGpuTime(void);
+
+    ResolutionGovernor governor;
+    Resource::Framebuffer framebuffer{};
+    Resource::Texture colour{};
+    Resource::Texture depth{};
+    GLsizei target_width = 0;
+    GLsizei target_height = 0;
+    GLsizei window_width = 0;
+    GLsizei window_height = 0;
+
+    /* Start and end timestamps of the last QUERY_COUNT frames */
+    std::array<GLuint, QUERY_COUNT * 2> queries{};
+    std::size_t query_index = 0;
+    std::uint64_t frames_started = 0;
+};
+
+}; // namespace Scaling
+#endif
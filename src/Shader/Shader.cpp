@@ -1,4 +1,6 @@
 #include "Shader.hpp"
+#include "HotReload.hpp"
+#include "Utils.hpp"
 
 #include <fmt/core.h>
 #include <fstream>
@@ -12,9 +14,10 @@ enum class ShaderLogType
 };
 
 static std::string readFile(const std::filesystem::path &file_path) noexcept;
+static GLuint buildProgram(const std::string &vertex_content, const std::string &fragment_content, const std::vector<std::string> &varyings) noexcept;
 static GLuint compileShader(const GLchar *shader_content, GLenum type) noexcept;
 static void checkAndLogShaderError(GLuint shader, ShaderLogType type) noexcept;
-static GLuint linkShadersIntoProgram(const std::vector<GLuint> &shaders) noexcept;
+static GLuint linkShadersIntoProgram(const std::vector<GLuint> &shaders, const std::vector<std::string> &varyings) noexcept;
 static void freeShaders(const std::vector<GLuint> &shaders) noexcept;
 
 static void
@@ -68,42 +71,85 @@ getInfoLogFuncFromType(ShaderLogType type)
 }
 
 Shader::Shader(const std::filesystem::path &vertex_path, const std::filesystem::path &fragment_path) noexcept
+    : vertex_file{vertex_path}, fragment_file{fragment_path}
 {
-    const std::string vertex_content = readFile(vertex_path);
-    const std::string fragment_content = readFile(fragment_path);
-
-    GLuint vertex_shader = compileShader(vertex_content.c_str(), GL_VERTEX_SHADER);
-    GLuint fragment_shader = compileShader(fragment_content.c_str(), GL_FRAGMENT_SHADER);
-
-    shader_program = linkShadersIntoProgram({vertex_shader, fragment_shader});
+    build();
+}
 
-    freeShaders({vertex_shader, fragment_shader});
+Shader::Shader(const std::filesystem::path &vertex_path, std::vector<std::string> varyings) noexcept
+    : vertex_file{vertex_path}, feedback_varyings{std::move(varyings)}
+{
+    build();
 }
 
-Shader::~Shader() noexcept
+void
+Shader::build(void) noexcept
 {
-    glDeleteProgram(shader_program);
+    /* Scenes hosted together share the sources, edits seen by the reloader are read again */
+    Utils::FileCache &cache = Utils::FileCache::getInstance();
+    const std::string fragment_content = fragment_file.empty() ? std::string{} : *cache.getText(fragment_file);
+    shader_program = Resource::Program::adopt(buildProgram(*cache.getText(vertex_file), fragment_content, feedback_varyings));
+
+    HotReload::Reloader &reloader = HotReload::Reloader::getInstance();
+    reloader.watch(vertex_file);
+    if (!fragment_file.empty()) {
+        reloader.watch(fragment_file);
+    }
+    seen_generation = reloader.getGeneration();
+    source_version = reloader.getVersion(vertex_file) + reloader.getVersion(fragment_file);
 }
 
-Shader::Shader(Shader &&shader) noexcept : shader_program{shader.shader_program}
+Shader::~Shader() noexcept
 {
-    /* 0 is defined to be silently ignored in the GL specification */
-    shader.shader_program = 0;
+    if (pending_program.isValid()) {
+        HotReload::Reloader::getInstance().reloadFinished();
+    }
 }
 
 Shader &
 Shader::operator=(Shader &&shader) noexcept
 {
-    shader_program = shader.shader_program;
-    /* 0 is defined to be silently ignored in the GL specification */
-    shader.shader_program = 0;
+    if (this == &shader) {
+        return *this;
+    }
+    /* The reloader would otherwise count the dropped reload as in flight forever */
+    if (pending_program.isValid()) {
+        HotReload::Reloader::getInstance().reloadFinished();
+    }
+    shader_program = std::move(shader.shader_program);
+    vertex_file = std::move(shader.vertex_file);
+    fragment_file = std::move(shader.fragment_file);
+    feedback_varyings = std::move(shader.feedback_varyings);
+    seen_generation = shader.seen_generation;
+    source_version = shader.source_version;
+    pending_program = std::move(shader.pending_program);
+    uniforms = std::move(shader.uniforms);
     return *this;
 }
 
+/* The program even if it failed to link, the errors are logged */
+static GLuint
+buildProgram(const std::string &vertex_content, const std::string &fragment_content, const std::vector<std::string> &varyings) noexcept
+{
+    std::vector<GLuint> shaders{compileShader(vertex_content.c_str(), GL_VERTEX_SHADER)};
+    /* Transform feedback programs may stop at the vertex stage */
+    if (!fragment_content.empty()) {
+        shaders.push_back(compileShader(fragment_content.c_str(), GL_FRAGMENT_SHADER));
+    }
+
+    GLuint program = linkShadersIntoProgram(shaders, varyings);
+
+    freeShaders(shaders);
+    return program;
+}
+
 static std::string
 readFile(const std::filesystem::path &file_path) noexcept
 {
     static constexpr char DELIMITER{EOF};
+    if (file_path.empty()) {
+        return {};
+    }
     std::ifstream file_stream{file_path, std::ios::in};
     std::string file_content{};
 
@@ -145,12 +191,19 @@ checkAndLogShaderError(GLuint shader, ShaderLogType type) noexcept
 }
 
 static GLuint
-linkShadersIntoProgram(const std::vector<GLuint> &shaders) noexcept
+linkShadersIntoProgram(const std::vector<GLuint> &shaders, const std::vector<std::string> &varyings) noexcept
 {
     GLuint program = glCreateProgram();
     for (GLuint shader : shaders) {
         glAttachShader(program, shader);
     }
+    if (!varyings.empty()) {
+        std::vector<const GLchar *> names{};
+        for (const std::string &varying : varyings) {
+            names.push_back(varying.c_str());
+        }
+        glTransformFeedbackVaryings(program, static_cast<GLsizei>(names.size()), names.data(), GL_INTERLEAVED_ATTRIBS);
+    }
     glLinkProgram(program);
     checkAndLogShaderError(program, ShaderLogType::PROGRAM);
     return program;
@@ -167,61 +220,125 @@ freeShaders(const std::vector<GLuint> &shaders) noexcept
 void
 Shader::useProgram(void) const noexcept
 {
-    glUseProgram(shader_program);
+    if (pending_program.isValid() || seen_generation != HotReload::Reloader::getInstance().getGeneration()) {
+        reload();
+    }
+    glUseProgram(shader_program.get());
+}
+
+/* Compiles on the loader thread, the frame loop only ever polls the result */
+void
+Shader::reload(void) const noexcept
+{
+    if (pending_program.isValid()) {
+        if (!pending_program.isReady()) {
+            return;
+        }
+        Resource::Program program = pending_program.take();
+        HotReload::Reloader::getInstance().reloadFinished();
+        if (!program.isResident()) {
+            fmt::print(stderr, "Shader::reload: {} and {} failed to build, keeping the previous program.\n", vertex_file.string(), fragment_file.string());
+            return;
+        }
+        shader_program = std::move(program);
+        glUseProgram(shader_program.get());
+        for (const auto &[name, value] : uniforms) {
+            std::visit([this, &name](const auto &uniform) { setUniform(name, uniform); }, value);
+        }
+        fmt::print("Shader::reload: Reloaded {} and {}.\n", vertex_file.string(), fragment_file.string());
+        return;
+    }
+
+    HotReload::Reloader &reloader = HotReload::Reloader::getInstance();
+    seen_generation = reloader.getGeneration();
+    const std::uint64_t version = reloader.getVersion(vertex_file) + reloader.getVersion(fragment_file);
+    if (version == source_version || nullptr == reloader.getLoader()) {
+        return;
+    }
+    source_version = version;
+    reloader.reloadStarted();
+    pending_program = reloader.getLoader()->submit([vertex_path = vertex_file, fragment_path = fragment_file, varyings = feedback_varyings]() -> Resource::Program {
+        const GLuint program = buildProgram(readFile(vertex_path), readFile(fragment_path), varyings);
+        GLint is_linked = GL_FALSE;
+        glGetProgramiv(program, GL_LINK_STATUS, &is_linked);
+        if (GL_TRUE != is_linked) {
+            glDeleteProgram(program);
+            return {};
+        }
+        return Resource::Program::adopt(program);
+    });
+}
+
+/* Replaying the uniforms on a reloaded program only needs their last value */
+template <class T>
+void
+Shader::rememberUniform(const std::string &name, const T &value) const
+{
+    if (HotReload::Reloader::getInstance().isEnabled()) {
+        uniforms.insert_or_assign(name, value);
+    }
 }
 
 void
 Shader::setUniform(const std::string &name, GLint value) const noexcept
 {
-    GLint location = glGetUniformLocation(shader_program, name.c_str());
+    rememberUniform(name, value);
+    GLint location = glGetUniformLocation(shader_program.get(), name.c_str());
     glUniform1i(location, value);
 }
 
 void
 Shader::setUniform(const std::string &name, GLfloat value) const noexcept
 {
-    GLint location = glGetUniformLocation(shader_program, name.c_str());
+    rememberUniform(name, value);
+    GLint location = glGetUniformLocation(shader_program.get(), name.c_str());
     glUniform1f(location, value);
 }
 
 void
 Shader::setUniform(const std::string &name, const glm::vec2 &value) const noexcept
 {
-    GLint location = glGetUniformLocation(shader_program, name.c_str());
+    rememberUniform(name, value);
+    GLint location = glGetUniformLocation(shader_program.get(), name.c_str());
     glUniform2fv(location, 1, glm::value_ptr(value));
 }
 
 void
 Shader::setUniform(const std::string &name, const glm::vec3 &value) const noexcept
 {
-    GLint location = glGetUniformLocation(shader_program, name.c_str());
+    rememberUniform(name, value);
+    GLint location = glGetUniformLocation(shader_program.get(), name.c_str());
     glUniform3fv(location, 1, glm::value_ptr(value));
 }
 
 void
 Shader::setUniform(const std::string &name, const glm::vec4 &value) const noexcept
 {
-    GLint location = glGetUniformLocation(shader_program, name.c_str());
+    rememberUniform(name, value);
+    GLint location = glGetUniformLocation(shader_program.get(), name.c_str());
     glUniform4fv(location, 1, glm::value_ptr(value));
 }
 
 void
 Shader::setUniform(const std::string &name, const glm::mat2 &value) const noexcept
 {
-    GLint location = glGetUniformLocation(shader_program, name.c_str());
+    rememberUniform(name, value);
+    GLint location = glGetUniformLocation(shader_program.get(), name.c_str());
     glUniformMatrix2fv(location, 1, GL_FALSE, glm::value_ptr(value));
 }
 
 void
 Shader::setUniform(const std::string &name, const glm::mat3 &value) const noexcept
 {
-    GLint location = glGetUniformLocation(shader_program, name.c_str());
+    rememberUniform(name, value);
+    GLint location = glGetUniformLocation(shader_program.get(), name.c_str());
     glUniformMatrix3fv(location, 1, GL_FALSE, glm::value_ptr(value));
 }
 
 void
 Shader::setUniform(const std::string &name, const glm::mat4 &value) const noexcept
 {
-    GLint location = glGetUniformLocation(shader_program, name.c_str());
+    rememberUniform(name, value);
+    GLint location = glGetUniformLocation(shader_program.get(), name.c_str());
     glUniformMatrix4fv(location, 1, GL_FALSE, glm::value_ptr(value));
 }
@@ -4,23 +4,35 @@
 #include <glad/glad.h>
 #include <glm/glm.hpp>
 
+#include "Loader.hpp"
+#include "Resource.hpp"
+
 #include <string>
 #include <filesystem>
+#include <unordered_map>
+#include <variant>
+#include <vector>
 
 class Shader
 {
   public:
     Shader(const std::filesystem::path &vertex_path, const std::filesystem::path &fragment_path) noexcept;
+    /* Vertex stage only, its outputs named in varyings are captured interleaved in that order with transform feedback */
+    Shader(const std::filesystem::path &vertex_path, std::vector<std::string> varyings) noexcept;
     ~Shader() noexcept;
 
-    Shader(Shader&& shader) noexcept;
+    /* The program handle deletes the program being overwritten, a reload still pending for it is given up */
+    Shader(Shader&& shader) noexcept = default;
     Shader& operator=(Shader&& shader) noexcept;
 
     /* Copying a shader program does not make sense. */
     Shader(const Shader&) = delete;
     Shader& operator=(const Shader&) = delete;
 
-    /* Put the shader program in use */
+    /*
+     * Put the shader program in use. With hot reload enabled, a program recompiled after its files changed replaces
+     * the current one here once it linked, with the uniforms set so far applied to it.
+     */
     void useProgram(void) const noexcept;
 
     /* Set a uniform in this shader program */
@@ -34,7 +46,24 @@ class Shader
     void setUniform(const std::string &name, const glm::mat4 &value) const noexcept;
 
   private:
-    GLuint shader_program;
+    using UniformValue = std::variant<GLint, GLfloat, glm::vec2, glm::vec3, glm::vec4, glm::mat2, glm::mat3, glm::mat4>;
+
+    template <class T> void rememberUniform(const std::string &name, const T &value) const;
+    void build(void) noexcept;
+    void reload(void) const noexcept;
+
+    /* Reloading is invisible to the users of the shader, hence mutable */
+    mutable Resource::Program shader_program;
+    std::filesystem::path vertex_file;
+    /* Empty for transform feedback programs */
+    std::filesystem::path fragment_file;
+    std::vector<std::string> feedback_varyings;
+    /* Generation of the reloader last checked and file versions the program was built from */
+    mutable std::uint64_t seen_generation = 0;
+    mutable std::uint64_t source_version = 0;
+    mutable Loader::Pending<Resource::Program> pending_program{};
+    /* Only kept with hot reload enabled */
+    mutable std::unordered_map<std::string, UniformValue> uniforms{};
 };
 
 #endif /* SHADER_H */
@@ -0,0 +1,221 @@
+#include "SpriteBatch.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+static constexpr std::uint64_t SPRITE_INDEX_MASK{0xFFFFFFFFu};
+static constexpr std::uint64_t MAX_STATES{0xFFFF};
+
+static std::uint32_t
+packColour(const glm::vec4 &colour) noexcept
+{
+    auto channel = [](float value) {
+        return static_cast<std::uint32_t>(std::clamp(value, 0.0f, 1.0f) * 255.0f + 0.5f);
+    };
+    return channel(colour.x) | channel(colour.y) << 8 | channel(colour.z) << 16 | channel(colour.w) << 24;
+}
+
+SpriteBatch::SpriteBatch(std::size_t sprite_capacity) : capacity{sprite_capacity}
+{
+    /* Every sprite uses the same two triangles, offset by the base vertex when drawing */
+    std::vector<GLuint> indices(capacity * INDICES_PER_SPRITE);
+    for (std::size_t sprite = 0; sprite < capacity; ++sprite) {
+        const auto first = static_cast<GLuint>(sprite * VERTICES_PER_SPRITE);
+        const std::size_t offset = sprite * INDICES_PER_SPRITE;
+        indices[offset + 0] = first;
+        indices[offset + 1] = first + 1;
+        indices[offset + 2] = first + 2;
+        indices[offset + 3] = first + 2;
+        indices[offset + 4] = first + 3;
+        indices[offset + 5] = first;
+    }
+
+    vao = Resource::VertexArray::create();
+    vertex_buffer = Resource::Buffer::create();
+    index_buffer = Resource::Buffer::create();
+
+    glBindVertexArray(vao.get());
+
+    const auto vertex_bytes = static_cast<GLsizeiptr>(capacity * VERTICES_PER_SPRITE * sizeof(Vertex));
+    glBindBuffer(GL_ARRAY_BUFFER, vertex_buffer.get());
+    glBufferData(GL_ARRAY_BUFFER, vertex_bytes, nullptr, GL_STREAM_DRAW);
+    vertex_buffer.setSize(static_cast<std::size_t>(vertex_bytes));
+
+    const auto index_bytes = static_cast<GLsizeiptr>(indices.size() * sizeof(GLuint));
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, index_buffer.get());
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, index_bytes, indices.data(), GL_STATIC_DRAW);
+    index_buffer.setSize(static_cast<std::size_t>(index_bytes));
+
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), reinterpret_cast<void *>(offsetof(Vertex, x)));
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), reinterpret_cast<void *>(offsetof(Vertex, u)));
+    glEnableVertexAttribArray(1);
+    glVertexAttribPointer(2, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(Vertex), reinterpret_cast<void *>(offsetof(Vertex, tint)));
+    glEnableVertexAttribArray(2);
+
+    glBindVertexArray(0);
+}
+
+void
+SpriteBatch::begin(SortMode mode)
+{
+    sort_mode = mode;
+    stats = {0, 0, 0};
+    clear();
+}
+
+void
+SpriteBatch::clear(void) noexcept
+{
+    vertices.clear();
+    sort_keys.clear();
+    shaders.clear();
+    textures.clear();
+    shader_indices.clear();
+    texture_indices.clear();
+    last_sprite = {nullptr, 0};
+    bound_state_key = UINT64_MAX;
+}
+
+std::uint64_t
+SpriteBatch::getStateKey(const Sprite &sprite)
+{
+    if (sprite.shader == last_sprite.shader && sprite.texture == last_sprite.texture && !sort_keys.empty()) {
+        return last_state_key;
+    }
+
+    auto [shader, shader_added] = shader_indices.try_emplace(sprite.shader, shaders.size());
+    if (shader_added) {
+        shaders.push_back(sprite.shader);
+    }
+    auto [texture, texture_added] = texture_indices.try_emplace(sprite.texture, textures.size());
+    if (texture_added) {
+        textures.push_back(sprite.texture);
+    }
+    last_sprite = sprite;
+    last_state_key = shader->second << 48 | texture->second << 32;
+    return last_state_key;
+}
+
+void
+SpriteBatch::draw(const Sprite &sprite, const glm::mat4 &transformation, const UvRect &uv, const glm::vec4 &tint)
+{
+    /* The keys only have room for this many distinct shaders and textures, or sprites, per batch */
+    if (shaders.size() == MAX_STATES || textures.size() == MAX_STATES || sort_keys.size() == SPRITE_INDEX_MASK) {
+        flush();
+        clear();
+    }
+
+    const std::uint64_t state_key = getStateKey(sprite);
+    sort_keys.push_back(state_key | sort_keys.size());
+
+    /* Corners of the unit quad only need the translation and the two halved basis vectors */
+    const glm::vec4 centre = transformation[3];
+    const glm::vec4 x_axis = transformation[0] * 0.5f;
+    const glm::vec4 y_axis = transformation[1] * 0.5f;
+    const glm::vec4 bottom_left = centre - x_axis - y_axis;
+    const glm::vec4 bottom_right = centre + x_axis - y_axis;
+    const glm::vec4 top_right = centre + x_axis + y_axis;
+    const glm::vec4 top_left = centre - x_axis + y_axis;
+    const std::uint32_t colour = packColour(tint);
+
+    vertices.push_back({bottom_left.x, bottom_left.y, bottom_left.z, uv.min.x, uv.min.y, colour});
+    vertices.push_back({bottom_right.x, bottom_right.y, bottom_right.z, uv.max.x, uv.min.y, colour});
+    vertices.push_back({top_right.x, top_right.y, top_right.z, uv.max.x, uv.max.y, colour});
+    vertices.push_back({top_left.x, top_left.y, top_left.z, uv.min.x, uv.max.y, colour});
+}
+
+void
+SpriteBatch::end(void)
+{
+    flush();
+}
+
+/* Statistics add up so that the flushes forced by a full batch are accounted for */
+void
+SpriteBatch::flush(void)
+{
+    const std::size_t sprite_count = sort_keys.size();
+    stats.sprites += sprite_count;
+    if (0 == sprite_count) {
+        return;
+    }
+
+    /* Sprites submitted grouped by state are already in order, which is worth checking first */
+    if (SortMode::STATE == sort_mode && !std::is_sorted(sort_keys.begin(), sort_keys.end())) {
+        std::sort(sort_keys.begin(), sort_keys.end());
+    }
+
+    glBindVertexArray(vao.get());
+    glBindBuffer(GL_ARRAY_BUFFER, vertex_buffer.get());
+    glActiveTexture(GL_TEXTURE0);
+
+    const std::size_t sprite_bytes = VERTICES_PER_SPRITE * sizeof(Vertex);
+    std::size_t position = 0;
+    while (position < sprite_count) {
+        /* Orphan the buffer once the ring is full, the driver hands out fresh storage while the GPU reads the old one */
+        if (ring_offset == capacity) {
+            glBufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(capacity * sprite_bytes), nullptr, GL_STREAM_DRAW);
+            ring_offset = 0;
+        }
+        const std::size_t chunk = std::min(sprite_count - position, capacity - ring_offset);
+
+        /* This part of the ring has not been used since it was orphaned, so no synchronisation is needed */
+        void *mapped = glMapBufferRange(GL_ARRAY_BUFFER, static_cast<GLintptr>(ring_offset * sprite_bytes), static_cast<GLsizeiptr>(chunk * sprite_bytes),
+                                        GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT);
+        if (nullptr == mapped) {
+            break;
+        }
+        auto *destination = static_cast<Vertex *>(mapped);
+        for (std::size_t i = 0; i < chunk; ++i) {
+            const std::size_t sprite = sort_keys[position + i] & SPRITE_INDEX_MASK;
+            std::memcpy(destination + i * VERTICES_PER_SPRITE, vertices.data() + sprite * VERTICES_PER_SPRITE, sprite_bytes);
+        }
+        glUnmapBuffer(GL_ARRAY_BUFFER);
+        ++stats.flushes;
+
+        /* One draw per run of sprites sharing a state */
+        std::size_t run_start = position;
+        for (std::size_t i = position + 1; i <= position + chunk; ++i) {
+            if (i == position + chunk || (sort_keys[i] & ~SPRITE_INDEX_MASK) != (sort_keys[run_start] & ~SPRITE_INDEX_MASK)) {
+                bindState(sort_keys[run_start] & ~SPRITE_INDEX_MASK);
+                drawRun(ring_offset + run_start - position, i - run_start);
+                run_start = i;
+            }
+        }
+
+        ring_offset += chunk;
+        position += chunk;
+    }
+
+    glBindVertexArray(0);
+}
+
+void
+SpriteBatch::bindState(std::uint64_t key)
+{
+    if (key == bound_state_key) {
+        return;
+    }
+    const std::uint64_t shader_index = key >> 48;
+    const std::uint64_t texture_index = (key >> 32) & MAX_STATES;
+    if (UINT64_MAX == bound_state_key || shader_index != bound_state_key >> 48) {
+        shaders[shader_index]->useProgram();
+    }
+    glBindTexture(GL_TEXTURE_2D, textures[texture_index]);
+    bound_state_key = key;
+}
+
+void
+SpriteBatch::drawRun(std::size_t first_sprite, std::size_t count) noexcept
+{
+    glDrawElementsBaseVertex(GL_TRIANGLES, static_cast<GLsizei>(count * INDICES_PER_SPRITE), GL_UNSIGNED_INT, nullptr,
+                             static_cast<GLint>(first_sprite * VERTICES_PER_SPRITE));
+    ++stats.batches;
+}
+
+const SpriteBatchStats &
+SpriteBatch::getStats(void) const noexcept
+{
+    return stats;
+}
@@ -0,0 +1,108 @@
+#ifndef SPRITEBATCH_HPP
+#define SPRITEBATCH_HPP
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include "Resource.hpp"
+#include "Shader.hpp"
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+/* Render state shared by the sprites that can go in the same draw */
+struct Sprite
+{
+    const Shader *shader;
+    GLuint texture;
+};
+
+struct UvRect
+{
+    glm::vec2 min, max;
+};
+
+struct SpriteBatchStats
+{
+    std::size_t sprites;
+    /* Draw calls issued */
+    std::size_t batches;
+    /* Uploads to the streamed vertex buffer */
+    std::size_t flushes;
+};
+
+/*
+ * Collects textured quads between begin() and end() and renders them with one draw per state change.
+ * The quad of a sprite is the unit square centred on the origin, moved to clip space by its transformation.
+ * Vertices are streamed into a ring buffer sharing one static index buffer, the shader samples unit 0.
+ */
+class SpriteBatch
+{
+  public:
+    enum class SortMode
+    {
+        /* Group by shader then texture, sprites with different states may be reordered */
+        STATE,
+        /* Keep the submission order, only consecutive sprites sharing a state are merged */
+        SUBMISSION
+    };
+
+    explicit SpriteBatch(std::size_t sprite_capacity = 65536);
+    ~SpriteBatch() noexcept = default;
+
+    SpriteBatch(const SpriteBatch &) = delete;
+    SpriteBatch(SpriteBatch &&) = delete;
+    SpriteBatch &operator=(const SpriteBatch &) = delete;
+    SpriteBatch &operator=(SpriteBatch &&) = delete;
+
+    void begin(SortMode mode = SortMode::STATE);
+    void draw(const Sprite &sprite, const glm::mat4 &transformation, const UvRect &uv = {{0.0f, 0.0f}, {1.0f, 1.0f}}, const glm::vec4 &tint = glm::vec4(1.0f));
+    void end(void);
+
+    /* Statistics since the last begin(), including the batches flushed early because it was full */
+    const SpriteBatchStats &getStats(void) const noexcept;
+
+  private:
+    struct Vertex
+    {
+        GLfloat x, y, z;
+        GLfloat u, v;
+        /* Normalised RGBA */
+        std::uint32_t tint;
+    };
+
+    void clear(void) noexcept;
+    void flush(void);
+    std::uint64_t getStateKey(const Sprite &sprite);
+    void bindState(std::uint64_t key);
+    void drawRun(std::size_t first_sprite, std::size_t count) noexcept;
+
+    static constexpr std::size_t VERTICES_PER_SPRITE{4};
+    static constexpr std::size_t INDICES_PER_SPRITE{6};
+
+    std::size_t capacity;
+    /* Sprites already written in the ring since it was last orphaned */
+    std::size_t ring_offset = 0;
+    SortMode sort_mode = SortMode::STATE;
+
+    Resource::VertexArray vao{};
+    Resource::Buffer vertex_buffer{}, index_buffer{};
+
+    /* CPU staging, one group of four vertices per sprite in submission order */
+    std::vector<Vertex> vertices{};
+    /* Shader index, texture index, then sprite index from the most significant bits down */
+    std::vector<std::uint64_t> sort_keys{};
+    std::vector<const Shader *> shaders{};
+    std::vector<GLuint> textures{};
+    std::unordered_map<const Shader *, std::uint64_t> shader_indices{};
+    std::unordered_map<GLuint, std::uint64_t> texture_indices{};
+    /* Consecutive sprites usually share their state, this skips the lookups */
+    Sprite last_sprite{nullptr, 0};
+    std::uint64_t last_state_key = 0;
+    std::uint64_t bound_state_key = UINT64_MAX;
+
+    SpriteBatchStats stats{0, 0, 0};
+};
+
+#endif
@@ -0,0 +1,263 @@
+#include "Telemetry.hpp"
+
+#include <fmt/core.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <new>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define TELEMETRY_HAS_SHM
+#endif
+
+namespace Telemetry
+{
+
+static std::size_t getMappingSize(std::uint32_t capacity) noexcept;
+static bool readSlot(const RingSlot &slot, std::uint64_t index, FrameRecord &record) noexcept;
+#ifdef TELEMETRY_HAS_SHM
+static bool isProcessAlive(std::int64_t pid) noexcept;
+static bool isStaleRing(const std::string &shared_name) noexcept;
+#endif
+
+Publisher::Publisher(std::string_view name) : shared_name{getSharedName(name)}
+{
+#ifdef TELEMETRY_HAS_SHM
+    /* An existing ring is only replaced once its publisher is known to be dead, never taken over from a running one */
+    int descriptor = shm_open(shared_name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0644);
+    if (0 > descriptor && EEXIST == errno && isStaleRing(shared_name)) {
+        fmt::print(stderr, "Publisher: Replacing shared memory {}, left behind by a publisher that died.\n", shared_name);
+        shm_unlink(shared_name.c_str());
+        descriptor = shm_open(shared_name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0644);
+    }
+    if (0 > descriptor && EEXIST == errno) {
+        fmt::print(stderr, "Publisher: Shared memory {} is in use by another publisher, pick another name.\n", shared_name);
+        return;
+    }
+    if (0 > descriptor) {
+        fmt::print(stderr, "Publisher: Failed to create shared memory {}.\n", shared_name);
+        return;
+    }
+    const std::size_t size = getMappingSize(CAPACITY);
+    void *address = MAP_FAILED;
+    if (0 == ftruncate(descriptor, static_cast<off_t>(size))) {
+        address = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, descriptor, 0);
+    }
+    close(descriptor);
+    if (MAP_FAILED == address) {
+        fmt::print(stderr, "Publisher: Failed to map shared memory {}.\n", shared_name);
+        shm_unlink(shared_name.c_str());
+        return;
+    }
+    mapping = address;
+    mapping_size = size;
+
+    /* The new object is zero filled, the atomics only need their values */
+    header = new (mapping) RingHeader{};
+    header->version = RingHeader::VERSION;
+    header->capacity = CAPACITY;
+    header->record_size = sizeof(RingSlot);
+    header->published.store(0, std::memory_order_relaxed);
+    header->is_open.store(1, std::memory_order_relaxed);
+    header->owner_pid.store(static_cast<std::int64_t>(getpid()), std::memory_order_relaxed);
+    slots = reinterpret_cast<RingSlot *>(static_cast<std::byte *>(mapping) + sizeof(RingHeader));
+    for (std::uint32_t i = 0; i < CAPACITY; ++i) {
+        new (&slots[i]) RingSlot{};
+    }
+    header->magic.store(RingHeader::MAGIC, std::memory_order_release);
+    fmt::print("Publisher: Publishing frame telemetry to {}.\n", shared_name);
+#else
+    fmt::print(stderr, "Publisher: {}\n", "Telemetry needs POSIX shared memory.");
+#endif
+}
+
+Publisher::~Publisher() noexcept
+{
+#ifdef TELEMETRY_HAS_SHM
+    if (nullptr == mapping) {
+        return;
+    }
+    header->is_open.store(0, std::memory_order_release);
+    munmap(mapping, mapping_size);
+    /* Subscribers already attached keep their mapping until they let go */
+    shm_unlink(shared_name.c_str());
+#endif
+}
+
+bool
+Publisher::isOpen(void) const noexcept
+{
+    return nullptr != header;
+}
+
+void
+Publisher::publish(const FrameRecord &record) noexcept
+{
+    if (nullptr == header) {
+        return;
+    }
+    RingSlot &slot = slots[next % CAPACITY];
+    slot.sequence.store(2 * next + 1, std::memory_order_relaxed);
+    /* Keeps the record from being written before readers can see the slot is busy */
+    std::atomic_thread_fence(std::memory_order_release);
+    std::memcpy(&slot.record, &record, sizeof(FrameRecord));
+    slot.sequence.store(2 * next + 2, std::memory_order_release);
+    header->published.store(++next, std::memory_order_release);
+}
+
+Subscriber::Subscriber(std::string_view name)
+{
+#ifdef TELEMETRY_HAS_SHM
+    const std::string shared_name = getSharedName(name);
+    const int descriptor = shm_open(shared_name.c_str(), O_RDONLY, 0);
+    if (0 > descriptor) {
+        return;
+    }
+    struct stat status{};
+    void *address = MAP_FAILED;
+    if (0 == fstat(descriptor, &status) && static_cast<std::size_t>(status.st_size) >= sizeof(RingHeader)) {
+        address = mmap(nullptr, static_cast<std::size_t>(status.st_size), PROT_READ, MAP_SHARED, descriptor, 0);
+    }
+    close(descriptor);
+    if (MAP_FAILED == address) {
+        return;
+    }
+    mapping = address;
+    mapping_size = static_cast<std::size_t>(status.st_size);
+
+    const auto *ring = static_cast<const RingHeader *>(mapping);
+    if (RingHeader::MAGIC != ring->magic.load(std::memory_order_acquire) || RingHeader::VERSION != ring->version ||
+        sizeof(RingSlot) != ring->record_size || mapping_size < getMappingSize(ring->capacity)) {
+        fmt::print(stderr, "Subscriber: {} is not a telemetry ring of this version.\n", shared_name);
+        return;
+    }
+    header = ring;
+    slots = reinterpret_cast<const RingSlot *>(static_cast<const std::byte *>(mapping) + sizeof(RingHeader));
+    /* Start with what is still in the ring */
+    const std::uint64_t published = header->published.load(std::memory_order_acquire);
+    next = published - std::min<std::uint64_t>(published, header->capacity);
+#endif
+}
+
+Subscriber::~Subscriber() noexcept
+{
+#ifdef TELEMETRY_HAS_SHM
+    if (nullptr != mapping) {
+        munmap(mapping, mapping_size);
+    }
+#endif
+}
+
+bool
+Subscriber::isOpen(void) const noexcept
+{
+    return nullptr != header;
+}
+
+bool
+Subscriber::isPublisherOpen(void) const noexcept
+{
+    if (nullptr == header || 0 == header->is_open.load(std::memory_order_acquire)) {
+        return false;
+    }
+#ifdef TELEMETRY_HAS_SHM
+    return isProcessAlive(header->owner_pid.load(std::memory_order_relaxed));
+#else
+    return true;
+#endif
+}
+
+std::uint64_t
+Subscriber::read(std::vector<FrameRecord> &frames)
+{
+    if (nullptr == header) {
+        return 0;
+    }
+    const std::uint64_t capacity = header->capacity;
+    const std::uint64_t published = header->published.load(std::memory_order_acquire);
+    std::uint64_t lost = 0;
+    if (published - next > capacity) {
+        lost = published - capacity - next;
+        next = published - capacity;
+    }
+    for (; next < published; ++next) {
+        /* The publisher may have lapped us since published was read, the slot then holds a later record */
+        FrameRecord record{};
+        if (readSlot(slots[next % capacity], next, record)) {
+            frames.push_back(record);
+        } else {
+            ++lost;
+        }
+    }
+    return lost;
+}
+
+std::string
+getSharedName(std::string_view name)
+{
+    if (name.empty()) {
+        return std::string{DEFAULT_NAME};
+    }
+    return '/' == name.front() ? std::string{name} : fmt::format("/{}", name);
+}
+
+static std::size_t
+getMappingSize(std::uint32_t capacity) noexcept
+{
+    return sizeof(RingHeader) + std::size_t{capacity} * sizeof(RingSlot);
+}
+
+/* Copy record index out of its slot, false when it is being or has been overwritten */
+static bool
+readSlot(const RingSlot &slot, std::uint64_t index, FrameRecord &record) noexcept
+{
+    const std::uint64_t written = 2 * index + 2;
+    if (written != slot.sequence.load(std::memory_order_acquire)) {
+        return false;
+    }
+    std::memcpy(&record, &slot.record, sizeof(FrameRecord));
+    /* Keeps the copy from being read after the sequence is checked again */
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return written == slot.sequence.load(std::memory_order_relaxed);
+}
+
+#ifdef TELEMETRY_HAS_SHM
+/* Only a process known to be gone counts as dead, one owned by another user still exists */
+static bool
+isProcessAlive(std::int64_t pid) noexcept
+{
+    return 0 >= pid || 0 == kill(static_cast<pid_t>(pid), 0) || ESRCH != errno;
+}
+
+/* Whether the ring behind the name is of this version and its publisher died without unlinking it */
+static bool
+isStaleRing(const std::string &shared_name) noexcept
+{
+    const int descriptor = shm_open(shared_name.c_str(), O_RDONLY, 0);
+    if (0 > descriptor) {
+        return false;
+    }
+    struct stat status{};
+    void *address = MAP_FAILED;
+    if (0 == fstat(descriptor, &status) && static_cast<std::size_t>(status.st_size) >= sizeof(RingHeader)) {
+        address = mmap(nullptr, sizeof(RingHeader), PROT_READ, MAP_SHARED, descriptor, 0);
+    }
+    close(descriptor);
+    if (MAP_FAILED == address) {
+        return false;
+    }
+    const auto *ring = static_cast<const RingHeader *>(address);
+    const bool is_stale = RingHeader::MAGIC == ring->magic.load(std::memory_order_acquire) && RingHeader::VERSION == ring->version &&
+                          !isProcessAlive(ring->owner_pid.load(std::memory_order_relaxed));
+    munmap(address, sizeof(RingHeader));
+    return is_stale;
+}
+#endif
+
+}; // namespace Telemetry
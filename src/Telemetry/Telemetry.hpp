@@ -0,0 +1,126 @@
+#ifndef TELEMETRY_HPP
+#define TELEMETRY_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+namespace Telemetry
+{
+
+/* Shared memory object used when no name is given */
+inline constexpr std::string_view DEFAULT_NAME{"/learnopengl-telemetry"};
+
+/* One frame as seen by the render loop, plain data so that it can be copied in and out of shared memory */
+struct FrameRecord
+{
+    std::uint64_t frame;
+    /* Seconds since GLFW was initialised when the frame started */
+    double time;
+    /* Whole iteration, then its phases: events and processInputs(), render() and the swap */
+    float frame_ms, input_ms, render_ms, present_ms;
+    /* Counted by the GL tracer, 0 without it */
+    std::uint32_t draws, gl_calls;
+    /* Estimated by the resource tracker */
+    std::uint64_t gpu_memory_bytes;
+};
+static_assert(std::is_trivially_copyable_v<FrameRecord>);
+
+/* Lives at the start of the shared memory, followed by the slots */
+struct RingHeader
+{
+    static constexpr std::uint32_t MAGIC{0x544C474C};
+    static constexpr std::uint32_t VERSION{3};
+
+    /* Written last by the publisher, the rest of the header is valid once it reads MAGIC */
+    std::atomic<std::uint32_t> magic;
+    std::uint32_t version;
+    std::uint32_t capacity;
+    std::uint32_t record_size;
+    /* Records published so far, record i lives in slot i % capacity */
+    std::atomic<std::uint64_t> published;
+    /* Cleared when the publisher goes away */
+    std::atomic<std::uint32_t> is_open;
+    /* Process id of the publisher, a ring whose publisher died without clearing is_open counts as closed */
+    std::atomic<std::int64_t> owner_pid;
+};
+static_assert(std::atomic<std::uint64_t>::is_always_lock_free, "The ring header has to work across processes.");
+
+/*
+ * Seqlock around one record: the sequence is odd while record i is being written to the slot and 2 * (i + 1) once it
+ * has been, so a reader that sees the same even value before and after copying got record i whole.
+ */
+struct RingSlot
+{
+    std::atomic<std::uint64_t> sequence;
+    FrameRecord record;
+};
+
+/*
+ * Single producer ring of frame records in POSIX shared memory, so that an external process can follow a running
+ * application. Publishing copies one record and bumps a counter, it never blocks nor waits for readers; readers that
+ * fall more than a ring behind lose the oldest records.
+ * A ring is never taken over from a running publisher, the publisher then stays closed. Only a ring left behind by
+ * a publisher that died is replaced.
+ */
+class Publisher
+{
+  public:
+    static constexpr std::uint32_t CAPACITY{1024};
+
+    explicit Publisher(std::string_view name);
+    ~Publisher() noexcept;
+
+    Publisher(const Publisher &) = delete;
+    Publisher(Publisher &&) = delete;
+    Publisher &operator=(const Publisher &) = delete;
+    Publisher &operator=(Publisher &&) = delete;
+
+    bool isOpen(void) const noexcept;
+    void publish(const FrameRecord &record) noexcept;
+
+  private:
+    std::string shared_name{};
+    void *mapping = nullptr;
+    std::size_t mapping_size = 0;
+    RingHeader *header = nullptr;
+    RingSlot *slots = nullptr;
+    std::uint64_t next = 0;
+};
+
+/* Reading side of a publisher's ring, from another process */
+class Subscriber
+{
+  public:
+    explicit Subscriber(std::string_view name);
+    ~Subscriber() noexcept;
+
+    Subscriber(const Subscriber &) = delete;
+    Subscriber(Subscriber &&) = delete;
+    Subscriber &operator=(const Subscriber &) = delete;
+    Subscriber &operator=(Subscriber &&) = delete;
+
+    /* False until a publisher created the ring, try again later */
+    bool isOpen(void) const noexcept;
+    bool isPublisherOpen(void) const noexcept;
+
+    /* Append the records published since the last call, returns how many were overwritten before they could be read */
+    std::uint64_t read(std::vector<FrameRecord> &frames);
+
+  private:
+    void *mapping = nullptr;
+    std::size_t mapping_size = 0;
+    const RingHeader *header = nullptr;
+    const RingSlot *slots = nullptr;
+    std::uint64_t next = 0;
+};
+
+/* Adds the leading slash POSIX expects */
+std::string getSharedName(std::string_view name);
+
+}; // namespace Telemetry
+#endif
@@ -0,0 +1,170 @@
+#include "TextureUpload.hpp"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <tmmintrin.h>
+#define TEXTUREUPLOAD_USE_SSSE3
+/* Compiled for SSSE3 regardless of the target flags, only called once the CPU is known to support it */
+#define TEXTUREUPLOAD_SSSE3_TARGET __attribute__((target("ssse3")))
+#elif defined(__SSSE3__) || defined(__AVX__)
+#include <tmmintrin.h>
+#define TEXTUREUPLOAD_USE_SSSE3
+#define TEXTUREUPLOAD_SSSE3_TARGET
+#endif
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <vector>
+
+namespace TextureUpload
+{
+
+Format
+chooseFormat(int channels, const Options &options) noexcept
+{
+    switch (channels) {
+    case 1:
+        return {GL_R8, GL_RED, 1};
+    case 2:
+        return {GL_RG8, GL_RG, 2};
+    case 3:
+        if (options.expand_rgb) {
+            return {static_cast<GLenum>(options.srgb ? GL_SRGB8_ALPHA8 : GL_RGBA8), GL_RGBA, 4};
+        }
+        return {static_cast<GLenum>(options.srgb ? GL_SRGB8 : GL_RGB8), GL_RGB, 3};
+    default:
+        return {static_cast<GLenum>(options.srgb ? GL_SRGB8_ALPHA8 : GL_RGBA8), GL_RGBA, 4};
+    }
+}
+
+GLint
+getUnpackAlignment(std::size_t row_bytes) noexcept
+{
+    for (GLint alignment : {8, 4, 2}) {
+        if (0 == row_bytes % static_cast<std::size_t>(alignment)) {
+            return alignment;
+        }
+    }
+    return 1;
+}
+
+static void
+expandRgbToRgbaScalar(const std::uint8_t *rgb, std::uint8_t *rgba, std::size_t pixel_count) noexcept
+{
+    for (std::size_t i = 0; i < pixel_count; ++i, rgb += 3, rgba += 4) {
+        rgba[0] = rgb[0];
+        rgba[1] = rgb[1];
+        rgba[2] = rgb[2];
+        rgba[3] = 0xFF;
+    }
+}
+
+#ifdef TEXTUREUPLOAD_USE_SSSE3
+/* 16 pixels per iteration, three loads are realigned into four groups of four pixels */
+TEXTUREUPLOAD_SSSE3_TARGET static void
+expandRgbToRgbaSsse3(const std::uint8_t *rgb, std::uint8_t *rgba, std::size_t pixel_count) noexcept
+{
+    const __m128i shuffle = _mm_setr_epi8(0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1);
+    const __m128i alpha = _mm_set1_epi32(static_cast<int>(0xFF000000u));
+    std::size_t i = 0;
+    for (; i + 16 <= pixel_count; i += 16, rgb += 48, rgba += 64) {
+        const __m128i first = _mm_loadu_si128(reinterpret_cast<const __m128i *>(rgb));
+        const __m128i second = _mm_loadu_si128(reinterpret_cast<const __m128i *>(rgb + 16));
+        const __m128i third = _mm_loadu_si128(reinterpret_cast<const __m128i *>(rgb + 32));
+        const __m128i groups[4]{first, _mm_alignr_epi8(second, first, 12), _mm_alignr_epi8(third, second, 8), _mm_srli_si128(third, 4)};
+        for (int group = 0; group < 4; ++group) {
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(rgba) + group, _mm_or_si128(_mm_shuffle_epi8(groups[group], shuffle), alpha));
+        }
+    }
+    expandRgbToRgbaScalar(rgb, rgba, pixel_count - i);
+}
+#endif
+
+void
+expandRgbToRgba(const std::uint8_t *rgb, std::uint8_t *rgba, std::size_t pixel_count) noexcept
+{
+#ifdef TEXTUREUPLOAD_USE_SSSE3
+#ifdef __GNUC__
+    static const bool has_ssse3 = __builtin_cpu_supports("ssse3");
+#else
+    static constexpr bool has_ssse3 = true;
+#endif
+    if (has_ssse3) {
+        expandRgbToRgbaSsse3(rgb, rgba, pixel_count);
+        return;
+    }
+#endif
+    expandRgbToRgbaScalar(rgb, rgba, pixel_count);
+}
+
+bool
+hasTextureStorage(void) noexcept
+{
+    return 0 != GLAD_GL_ARB_texture_storage;
+}
+
+static GLsizei
+getMipLevelCount(GLsizei width, GLsizei height) noexcept
+{
+    GLsizei levels = 1;
+    for (GLsizei size = std::max(width, height); size > 1; size /= 2) {
+        ++levels;
+    }
+    return levels;
+}
+
+UploadStats
+upload(Resource::Texture &texture, const Utils::ImageData &data, const Options &options)
+{
+    const auto start = std::chrono::steady_clock::now();
+    if (!texture.isResident()) {
+        texture = Resource::Texture::create();
+    }
+    glBindTexture(GL_TEXTURE_2D, texture.get());
+    if (nullptr == data.pixels) {
+        return {0.0, 0, false};
+    }
+
+    const Format format = chooseFormat(data.channels, options);
+    const auto pixel_count = static_cast<std::size_t>(data.width) * static_cast<std::size_t>(data.height);
+    const std::uint8_t *pixels = data.pixels;
+    std::vector<std::uint8_t> expanded{};
+    if (format.channels != data.channels) {
+        expanded.resize(pixel_count * 4);
+        expandRgbToRgba(pixels, expanded.data(), pixel_count);
+        pixels = expanded.data();
+    }
+
+    /* Single and dual channel images are shown as grey, with alpha for the latter */
+    if (1 == format.channels || 2 == format.channels) {
+        const GLint swizzle[4]{GL_RED, GL_RED, GL_RED, 1 == format.channels ? GL_ONE : GL_GREEN};
+        glTexParameteriv(GL_TEXTURE_2D, GL_TEXTURE_SWIZZLE_RGBA, swizzle);
+    }
+
+    const GLsizei levels = options.mipmaps ? getMipLevelCount(data.width, data.height) : 1;
+    const bool is_immutable = hasTextureStorage();
+    GLint previous_alignment = 4;
+    glGetIntegerv(GL_UNPACK_ALIGNMENT, &previous_alignment);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, getUnpackAlignment(static_cast<std::size_t>(data.width) * static_cast<std::size_t>(format.channels)));
+    if (is_immutable) {
+        /* Every level is allocated up front, glGenerateMipmap then only fills them */
+        glTexStorage2D(GL_TEXTURE_2D, levels, format.internal_format, data.width, data.height);
+        glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, data.width, data.height, format.format, GL_UNSIGNED_BYTE, pixels);
+    } else {
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, levels - 1);
+        glTexImage2D(GL_TEXTURE_2D, 0, static_cast<GLint>(format.internal_format), data.width, data.height, 0, format.format, GL_UNSIGNED_BYTE, pixels);
+    }
+    glPixelStorei(GL_UNPACK_ALIGNMENT, previous_alignment);
+    if (options.mipmaps) {
+        glGenerateMipmap(GL_TEXTURE_2D);
+    } else {
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    }
+
+    const std::size_t bytes = Resource::estimateTextureSize(data.width, data.height, static_cast<GLint>(format.internal_format), options.mipmaps);
+    texture.setSize(bytes);
+    const std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+    return {elapsed.count(), bytes, is_immutable};
+}
+
+}; // namespace TextureUpload
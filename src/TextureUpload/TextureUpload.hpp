@@ -0,0 +1,56 @@
+#ifndef TEXTUREUPLOAD_HPP
+#define TEXTUREUPLOAD_HPP
+
+#include <glad/glad.h>
+
+#include "Resource.hpp"
+#include "Utils.hpp"
+
+#include <cstddef>
+#include <cstdint>
+
+namespace TextureUpload
+{
+
+struct Options
+{
+    /* Colour textures are sampled as sRGB, single and dual channel ones have no sRGB format */
+    bool srgb = false;
+    bool mipmaps = true;
+    /* Drivers usually convert three channel uploads to four on the CPU, doing it ourselves is faster */
+    bool expand_rgb = true;
+};
+
+struct Format
+{
+    GLenum internal_format;
+    GLenum format;
+    /* Channels per uploaded pixel, after any expansion */
+    int channels;
+};
+
+struct UploadStats
+{
+    /* CPU time spent submitting, the copy to the GPU may still be in flight */
+    double milliseconds;
+    std::size_t bytes;
+    /* Allocated once with glTexStorage2D */
+    bool is_immutable;
+};
+
+Format chooseFormat(int channels, const Options &options) noexcept;
+/* Largest alignment dividing the row size, so no row is read past its end */
+GLint getUnpackAlignment(std::size_t row_bytes) noexcept;
+void expandRgbToRgba(const std::uint8_t *rgb, std::uint8_t *rgba, std::size_t pixel_count) noexcept;
+
+/* Whether glad found GL_ARB_texture_storage, which every 4.2 and later driver exposes, so glTexStorage2D is loaded */
+bool hasTextureStorage(void) noexcept;
+
+/*
+ * Allocate and fill the texture bound to GL_TEXTURE_2D of the active unit, creating the handle first if needed.
+ * Nothing is allocated for images without pixels.
+ */
+UploadStats upload(Resource::Texture &texture, const Utils::ImageData &data, const Options &options = {});
+
+}; // namespace TextureUpload
+#endif
@@ -0,0 +1,446 @@
+#include "JobSystem.hpp"
+
+#include <fmt/core.h>
+
+#include <chrono>
+#include <random>
+#include <thread>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace Utils
+{
+
+static constexpr std::size_t NO_WORKER{~std::size_t{0}};
+static constexpr std::size_t DEQUE_CAPACITY{8192};
+static constexpr std::size_t JOB_RING_SIZE{4096};
+static constexpr int SPIN_ROUNDS{64};
+
+/* Set on the threads of a job system so that jobs they submit go to their own deque */
+static thread_local JobSystem *current_system = nullptr;
+static thread_local std::size_t current_index = NO_WORKER;
+
+static JobSystemOptions shared_options{};
+static std::atomic<bool> shared_created{false};
+
+static std::uint64_t
+getNanosecondsSince(std::chrono::steady_clock::time_point start) noexcept
+{
+    return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count());
+}
+
+/* Fixed capacity Chase-Lev deque, the owner pushes and pops at the bottom and thieves take from the top */
+class WorkDeque
+{
+  public:
+    WorkDeque() : slots{std::make_unique<std::atomic<Job *>[]>(DEQUE_CAPACITY)} {}
+
+    /* Fails when full, the owner then runs the job right away */
+    bool
+    push(Job *job) noexcept
+    {
+        const std::int64_t b = bottom.load(std::memory_order_relaxed);
+        const std::int64_t t = top.load(std::memory_order_acquire);
+        if (b - t >= static_cast<std::int64_t>(DEQUE_CAPACITY)) {
+            return false;
+        }
+        slots[static_cast<std::size_t>(b) & (DEQUE_CAPACITY - 1)].store(job, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        bottom.store(b + 1, std::memory_order_relaxed);
+        return true;
+    }
+
+    Job *
+    pop(void) noexcept
+    {
+        const std::int64_t b = bottom.load(std::memory_order_relaxed) - 1;
+        bottom.store(b, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        std::int64_t t = top.load(std::memory_order_relaxed);
+        if (t > b) {
+            bottom.store(b + 1, std::memory_order_relaxed);
+            return nullptr;
+        }
+        Job *job = slots[static_cast<std::size_t>(b) & (DEQUE_CAPACITY - 1)].load(std::memory_order_relaxed);
+        if (t == b) {
+            /* Last job, race the thieves for it */
+            if (!top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+                job = nullptr;
+            }
+            bottom.store(b + 1, std::memory_order_relaxed);
+        }
+        return job;
+    }
+
+    Job *
+    steal(void) noexcept
+    {
+        std::int64_t t = top.load(std::memory_order_acquire);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        const std::int64_t b = bottom.load(std::memory_order_acquire);
+        if (t >= b) {
+            return nullptr;
+        }
+        Job *job = slots[static_cast<std::size_t>(t) & (DEQUE_CAPACITY - 1)].load(std::memory_order_relaxed);
+        if (!top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+            return nullptr;
+        }
+        return job;
+    }
+
+    bool
+    isEmpty(void) const noexcept
+    {
+        return bottom.load(std::memory_order_relaxed) <= top.load(std::memory_order_relaxed);
+    }
+
+  private:
+    alignas(64) std::atomic<std::int64_t> top{0};
+    alignas(64) std::atomic<std::int64_t> bottom{0};
+    std::unique_ptr<std::atomic<Job *>[]> slots;
+};
+
+struct JobSystem::Worker
+{
+    WorkDeque deque{};
+    /* Only the owner allocates from its ring, slots still in use are skipped for a heap allocation */
+    std::unique_ptr<Job[]> ring = std::make_unique<Job[]>(JOB_RING_SIZE);
+    std::size_t next_job = 0;
+    std::minstd_rand random{};
+    std::jthread thread{};
+
+    alignas(64) std::atomic<std::uint64_t> executed{0};
+    std::atomic<std::uint64_t> steals{0};
+    std::atomic<std::uint64_t> failed_steals{0};
+    std::atomic<std::uint64_t> idle_nanoseconds{0};
+};
+
+bool
+JobCounter::isDone(void) const noexcept
+{
+    return 0 == pending.load(std::memory_order_acquire);
+}
+
+JobSystem::JobSystem(const JobSystemOptions &options)
+{
+    const unsigned int hardware_threads = std::max(1u, std::thread::hardware_concurrency());
+    const std::size_t worker_count = 0 == options.worker_count ? hardware_threads : options.worker_count;
+    workers.reserve(worker_count);
+    for (std::size_t i = 0; i < worker_count; ++i) {
+        workers.push_back(std::make_unique<Worker>());
+        workers.back()->random.seed(i + 1);
+    }
+    previous_system = current_system;
+    previous_index = current_index;
+    current_system = this;
+    current_index = 0;
+
+    /* Worker 0 is the calling thread */
+    for (std::size_t i = 1; i < worker_count; ++i) {
+        workers[i]->thread = std::jthread{[this, i] { workerLoop(i); }};
+        if (!options.pin_workers) {
+            continue;
+        }
+#ifdef __linux__
+        cpu_set_t cpu_set;
+        CPU_ZERO(&cpu_set);
+        CPU_SET(i % hardware_threads, &cpu_set);
+        if (0 != pthread_setaffinity_np(workers[i]->thread.native_handle(), sizeof(cpu_set), &cpu_set)) {
+            fmt::print(stderr, "JobSystem: Failed to pin worker {} to core {}.\n", i, i % hardware_threads);
+        }
+#else
+        if (1 == i) {
+            fmt::print(stderr, "JobSystem: {}\n", "Pinning workers is only supported on Linux.");
+        }
+#endif
+    }
+}
+
+JobSystem::~JobSystem()
+{
+    {
+        std::lock_guard lock{sleep_mutex};
+        stopping = true;
+        ++epoch;
+    }
+    wake_up.notify_all();
+    for (std::unique_ptr<Worker> &worker : workers) {
+        if (worker->thread.joinable()) {
+            worker->thread.join();
+        }
+    }
+    if (this == current_system) {
+        current_system = previous_system;
+        current_index = previous_index;
+    }
+}
+
+void
+JobSystem::configure(const JobSystemOptions &options) noexcept
+{
+    if (shared_created.load()) {
+        fmt::print(stderr, "JobSystem::configure: {}\n", "The shared job system already started, options are ignored.");
+        return;
+    }
+    shared_options = options;
+}
+
+JobSystem &
+JobSystem::getInstance(void)
+{
+    static JobSystem system{[] {
+        shared_created = true;
+        return shared_options;
+    }()};
+    return system;
+}
+
+std::size_t
+JobSystem::getWorkerCount(void) const noexcept
+{
+    return workers.size();
+}
+
+std::vector<JobWorkerStats>
+JobSystem::getStats(void) const
+{
+    std::vector<JobWorkerStats> stats{};
+    stats.reserve(workers.size());
+    for (const std::unique_ptr<Worker> &worker : workers) {
+        stats.push_back({worker->executed.load(), worker->steals.load(), worker->failed_steals.load(),
+                         static_cast<double>(worker->idle_nanoseconds.load()) * 1e-9});
+    }
+    return stats;
+}
+
+void
+JobSystem::resetStats(void) noexcept
+{
+    for (std::unique_ptr<Worker> &worker : workers) {
+        worker->executed = 0;
+        worker->steals = 0;
+        worker->failed_steals = 0;
+        worker->idle_nanoseconds = 0;
+    }
+}
+
+std::size_t
+JobSystem::getCurrentIndex(void) const noexcept
+{
+    return this == current_system ? current_index : NO_WORKER;
+}
+
+bool
+JobSystem::isLocalQueueEmpty(void) const noexcept
+{
+    const std::size_t index = getCurrentIndex();
+    if (NO_WORKER == index) {
+        return 0 == injected_count.load(std::memory_order_relaxed);
+    }
+    return workers[index]->deque.isEmpty();
+}
+
+Job *
+JobSystem::allocateJob(void)
+{
+    const std::size_t index = getCurrentIndex();
+    if (NO_WORKER != index) {
+        Worker &worker = *workers[index];
+        Job &job = worker.ring[worker.next_job];
+        if (!job.in_use.load(std::memory_order_acquire)) {
+            worker.next_job = (worker.next_job + 1) % JOB_RING_SIZE;
+            job.in_use.store(true, std::memory_order_relaxed);
+            job.from_heap = false;
+            return &job;
+        }
+    }
+    Job *job = new Job{};
+    job->from_heap = true;
+    return job;
+}
+
+void
+JobSystem::submit(Job *job, JobCounter *counter, JobCounter *dependency)
+{
+    job->counter = counter;
+    if (nullptr != counter) {
+        counter->pending.fetch_add(1, std::memory_order_relaxed);
+    }
+    if (nullptr != dependency) {
+        std::lock_guard lock{dependency->mutex};
+        if (0 != dependency->pending.load(std::memory_order_acquire)) {
+            dependency->dependents.push_back(job);
+            return;
+        }
+    }
+    schedule(job);
+}
+
+void
+JobSystem::schedule(Job *job)
+{
+    const std::size_t index = getCurrentIndex();
+    if (NO_WORKER == index) {
+        {
+            std::lock_guard lock{injection_mutex};
+            injected.push_back(job);
+        }
+        injected_count.fetch_add(1, std::memory_order_seq_cst);
+    } else if (!workers[index]->deque.push(job)) {
+        execute(job);
+        return;
+    }
+    wakeWorker();
+}
+
+void
+JobSystem::wakeWorker(void)
+{
+    /* Pairs with the fence of a worker going to sleep, either it sees the job or we see it sleeping */
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (0 == sleepers.load(std::memory_order_relaxed)) {
+        return;
+    }
+    {
+        std::lock_guard lock{sleep_mutex};
+        ++epoch;
+    }
+    wake_up.notify_one();
+}
+
+void
+JobSystem::execute(Job *job)
+{
+    job->invoke(*job);
+    JobCounter *counter = job->counter;
+    if (job->from_heap) {
+        delete job;
+    } else {
+        job->in_use.store(false, std::memory_order_release);
+    }
+
+    const std::size_t index = getCurrentIndex();
+    if (NO_WORKER != index) {
+        workers[index]->executed.fetch_add(1, std::memory_order_relaxed);
+    }
+    if (nullptr == counter) {
+        return;
+    }
+
+    std::vector<Job *> released{};
+    {
+        std::lock_guard lock{counter->mutex};
+        if (1 == counter->pending.fetch_sub(1, std::memory_order_acq_rel)) {
+            released.swap(counter->dependents);
+        }
+    }
+    for (Job *dependent : released) {
+        schedule(dependent);
+    }
+}
+
+Job *
+JobSystem::findJob(std::size_t index)
+{
+    if (NO_WORKER != index) {
+        if (Job *job = workers[index]->deque.pop()) {
+            return job;
+        }
+    }
+    if (0 != injected_count.load(std::memory_order_relaxed)) {
+        std::lock_guard lock{injection_mutex};
+        if (!injected.empty()) {
+            Job *job = injected.front();
+            injected.pop_front();
+            injected_count.fetch_sub(1, std::memory_order_relaxed);
+            return job;
+        }
+    }
+
+    /* Start at a random victim so that thieves do not all hammer the same deque */
+    const std::size_t count = workers.size();
+    const std::size_t start = NO_WORKER == index ? 0 : workers[index]->random() % count;
+    for (std::size_t i = 0; i < count; ++i) {
+        const std::size_t victim = (start + i) % count;
+        if (victim == index || workers[victim]->deque.isEmpty()) {
+            continue;
+        }
+        Job *job = workers[victim]->deque.steal();
+        if (NO_WORKER != index) {
+            (nullptr == job ? workers[index]->failed_steals : workers[index]->steals).fetch_add(1, std::memory_order_relaxed);
+        }
+        if (nullptr != job) {
+            return job;
+        }
+    }
+    return nullptr;
+}
+
+void
+JobSystem::wait(JobCounter &counter)
+{
+    const std::size_t index = getCurrentIndex();
+    std::chrono::steady_clock::time_point idle_start{};
+    bool idle = false;
+    while (!counter.isDone()) {
+        if (Job *job = findJob(index)) {
+            if (idle && NO_WORKER != index) {
+                workers[index]->idle_nanoseconds.fetch_add(getNanosecondsSince(idle_start), std::memory_order_relaxed);
+            }
+            idle = false;
+            execute(job);
+            continue;
+        }
+        if (!idle) {
+            idle = true;
+            idle_start = std::chrono::steady_clock::now();
+        }
+        std::this_thread::yield();
+    }
+    if (idle && NO_WORKER != index) {
+        workers[index]->idle_nanoseconds.fetch_add(getNanosecondsSince(idle_start), std::memory_order_relaxed);
+    }
+    /* The last decrement may still hold the lock */
+    std::lock_guard lock{counter.mutex};
+}
+
+void
+JobSystem::workerLoop(std::size_t index)
+{
+    current_system = this;
+    current_index = index;
+    Worker &worker = *workers[index];
+    while (!stopping.load(std::memory_order_relaxed)) {
+        if (Job *job = findJob(index)) {
+            execute(job);
+            continue;
+        }
+
+        const auto idle_start = std::chrono::steady_clock::now();
+        Job *job = nullptr;
+        for (int round = 0; round < SPIN_ROUNDS && nullptr == job; ++round) {
+            std::this_thread::yield();
+            job = findJob(index);
+        }
+        if (nullptr == job) {
+            const std::uint64_t seen_epoch = epoch.load();
+            sleepers.fetch_add(1, std::memory_order_seq_cst);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            job = findJob(index);
+            if (nullptr == job) {
+                std::unique_lock lock{sleep_mutex};
+                wake_up.wait(lock, [this, seen_epoch] { return epoch.load() != seen_epoch || stopping.load(); });
+            }
+            sleepers.fetch_sub(1, std::memory_order_relaxed);
+        }
+        worker.idle_nanoseconds.fetch_add(getNanosecondsSince(idle_start), std::memory_order_relaxed);
+        if (nullptr != job) {
+            execute(job);
+        }
+    }
+}
+
+}; // namespace Utils
@@ -0,0 +1,198 @@
+#ifndef JOBSYSTEM_HPP
+#define JOBSYSTEM_HPP
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace Utils
+{
+
+class JobCounter;
+
+/* A type-erased function small enough to live in the owning worker's job ring, bigger ones are stored on the heap */
+struct Job
+{
+    void (*invoke)(Job &job) = nullptr;
+    JobCounter *counter = nullptr;
+    /* Set while the job sits in a worker ring, cleared by whoever ran it */
+    std::atomic<bool> in_use{false};
+    bool from_heap = false;
+    alignas(std::max_align_t) std::array<std::byte, 64> storage{};
+};
+
+/* Number of unfinished jobs that reported to it, and the jobs waiting for it to reach zero */
+class JobCounter
+{
+  public:
+    JobCounter() = default;
+
+    bool isDone(void) const noexcept;
+
+    JobCounter(const JobCounter &) = delete;
+    JobCounter(JobCounter &&) = delete;
+    JobCounter &operator=(const JobCounter &) = delete;
+    JobCounter &operator=(JobCounter &&) = delete;
+
+  private:
+    friend class JobSystem;
+
+    std::atomic<std::uint32_t> pending{0};
+    /* Taken on every decrement so the counter can be destroyed as soon as a waiter saw it reach zero */
+    std::mutex mutex{};
+    std::vector<Job *> dependents{};
+};
+
+struct JobSystemOptions
+{
+    /* Threads taking part in the work including the calling one, 0 uses one per hardware thread */
+    std::size_t worker_count = 0;
+    /* Bind every worker thread to its own core, only supported on Linux */
+    bool pin_workers = false;
+};
+
+struct JobWorkerStats
+{
+    std::uint64_t executed;
+    std::uint64_t steals;
+    std::uint64_t failed_steals;
+    double idle_seconds;
+};
+
+/*
+ * Work-stealing scheduler, every worker owns a Chase-Lev deque: it pushes and pops its own jobs at the bottom
+ * while idle workers steal the oldest jobs from the top. The thread that created the system is worker 0 and
+ * only helps while it waits, other threads can submit and wait too and go through a shared injection queue.
+ * Jobs must not throw.
+ */
+class JobSystem
+{
+  public:
+    explicit JobSystem(const JobSystemOptions &options = {});
+    ~JobSystem();
+
+    /* Options of the shared instance, only applied if called before its first use */
+    static void configure(const JobSystemOptions &options) noexcept;
+    static JobSystem &getInstance(void);
+
+    /* Queue function(), counter is incremented now and decremented once it ran, dependency has to reach zero first */
+    template <class Function>
+    void
+    run(Function &&function, JobCounter *counter = nullptr, JobCounter *dependency = nullptr)
+    {
+        using Stored = std::decay_t<Function>;
+        Job *job = allocateJob();
+        if constexpr (sizeof(Stored) <= sizeof(Job::storage) && alignof(Stored) <= alignof(std::max_align_t)) {
+            new (job->storage.data()) Stored(std::forward<Function>(function));
+            job->invoke = [](Job &self) {
+                Stored &stored = *std::launder(reinterpret_cast<Stored *>(self.storage.data()));
+                stored();
+                stored.~Stored();
+            };
+        } else {
+            new (job->storage.data()) Stored *(new Stored(std::forward<Function>(function)));
+            job->invoke = [](Job &self) {
+                Stored *stored = *std::launder(reinterpret_cast<Stored **>(self.storage.data()));
+                (*stored)();
+                delete stored;
+            };
+        }
+        submit(job, counter, dependency);
+    }
+
+    /* Run other jobs until counter reaches zero */
+    void wait(JobCounter &counter);
+
+    /*
+     * Call function(begin, end) over [0, count) and return once all of it ran. Ranges are split in halves only while
+     * the local deque is empty, so the work spreads as fast as workers go idle without queuing a job per chunk,
+     * chunks are never smaller than min_grain.
+     */
+    template <class Function>
+    void
+    parallelFor(std::size_t count, Function &&function, std::size_t min_grain = 1)
+    {
+        if (0 == count) {
+            return;
+        }
+        static constexpr std::size_t CHUNKS_PER_WORKER{8};
+        const std::size_t grain = std::max({std::size_t{1}, min_grain, count / (getWorkerCount() * CHUNKS_PER_WORKER)});
+        if (count <= grain || 1 == getWorkerCount()) {
+            function(std::size_t{0}, count);
+            return;
+        }
+        JobCounter counter{};
+        forRange(0, count, grain, function, counter);
+        wait(counter);
+    }
+
+    std::size_t getWorkerCount(void) const noexcept;
+    std::vector<JobWorkerStats> getStats(void) const;
+    void resetStats(void) noexcept;
+
+    JobSystem(const JobSystem &) = delete;
+    JobSystem(JobSystem &&) = delete;
+    JobSystem &operator=(const JobSystem &) = delete;
+    JobSystem &operator=(JobSystem &&) = delete;
+
+  private:
+    struct Worker;
+
+    template <class Function>
+    void
+    forRange(std::size_t begin, std::size_t end, std::size_t grain, Function &function, JobCounter &counter)
+    {
+        while (begin < end) {
+            if (end - begin > grain && isLocalQueueEmpty()) {
+                const std::size_t middle = begin + (end - begin) / 2;
+                run([this, middle, end, grain, &function, &counter] { forRange(middle, end, grain, function, counter); }, &counter);
+                end = middle;
+                continue;
+            }
+            const std::size_t chunk_end = std::min(end, begin + grain);
+            function(begin, chunk_end);
+            begin = chunk_end;
+        }
+    }
+
+    Job *allocateJob(void);
+    void submit(Job *job, JobCounter *counter, JobCounter *dependency);
+    void schedule(Job *job);
+    void execute(Job *job);
+    Job *findJob(std::size_t index);
+    bool isLocalQueueEmpty(void) const noexcept;
+    std::size_t getCurrentIndex(void) const noexcept;
+    void workerLoop(std::size_t index);
+    void wakeWorker(void);
+
+    std::vector<std::unique_ptr<Worker>> workers{};
+
+    std::mutex injection_mutex{};
+    std::deque<Job *> injected{};
+    std::atomic<std::size_t> injected_count{0};
+
+    /* Idle workers sleep until the epoch moves, submitters only take the lock when someone sleeps */
+    std::mutex sleep_mutex{};
+    std::condition_variable wake_up{};
+    std::atomic<std::uint64_t> epoch{0};
+    std::atomic<std::size_t> sleepers{0};
+    std::atomic<bool> stopping{false};
+
+    /* The creating thread may already be worker 0 of another system */
+    JobSystem *previous_system = nullptr;
+    std::size_t previous_index = 0;
+};
+
+}; // namespace Utils
+
+#endif
@@ -3,6 +3,17 @@
 #include <fmt/core.h>
 #include <stb_image.h>
 
+#ifdef UTILS_HAS_JPEG
+#include <csetjmp>
+#include <cstdio>
+#include <jpeglib.h>
+#endif
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iterator>
+
 namespace Utils
 {
 
@@ -13,27 +24,239 @@ ScrollingColour::getNext(void) noexcept
     return getCurrent();
 }
 
+RGBColour
+ScrollingColour::getAt(double time) noexcept
+{
+    /* A full cycle is 300 steps, there is no point in running more after a long pause */
+    static constexpr long long MAX_STEPS{300};
+    const auto step = static_cast<long long>(std::floor(time * STEPS_PER_SECOND));
+    const long long steps = std::min(step - last_step.value_or(step), MAX_STEPS);
+    for (long long i = 0; i < steps; ++i) {
+        UpdateColours();
+    }
+    last_step = step;
+    return getCurrent();
+}
+
 RGBColour
 ScrollingColour::getCurrent(void) const noexcept
 {
     return colour;
 }
 
-Image::Image(const std::filesystem::path &img_path) noexcept
+/*
+ * Average each factor x factor block, for decoders which cannot shrink while decoding.
+ * Sizes are rounded up like libjpeg does, the blocks on the right and bottom edges may be partial.
+ */
+static PixelBuffer
+downscale(PixelBuffer source, ImageData &data, int factor) noexcept
+{
+    const int width = (data.width + factor - 1) / factor;
+    const int height = (data.height + factor - 1) / factor;
+    const auto channels = static_cast<std::size_t>(data.channels);
+    PixelBuffer scaled{static_cast<unsigned char *>(std::malloc(static_cast<std::size_t>(width * height) * channels)), std::free};
+    if (nullptr == scaled) {
+        return scaled;
+    }
+
+    for (int y = 0; y < height; ++y) {
+        const int row_end = std::min((y + 1) * factor, data.height);
+        for (int x = 0; x < width; ++x) {
+            const int column_end = std::min((x + 1) * factor, data.width);
+            const auto block_size = static_cast<unsigned>((row_end - y * factor) * (column_end - x * factor));
+            for (std::size_t channel = 0; channel < channels; ++channel) {
+                unsigned sum = 0;
+                for (int row = y * factor; row < row_end; ++row) {
+                    const unsigned char *pixel = source.get() + (static_cast<std::size_t>(row * data.width + x * factor)) * channels + channel;
+                    for (int column = x * factor; column < column_end; ++column, pixel += channels) {
+                        sum += *pixel;
+                    }
+                }
+                scaled.get()[static_cast<std::size_t>(y * width + x) * channels + channel] = static_cast<unsigned char>((sum + block_size / 2) / block_size);
+            }
+        }
+    }
+    data.width = width;
+    data.height = height;
+    return scaled;
+}
+
+namespace
+{
+
+class StbImageDecoder final : public ImageDecoder
+{
+  public:
+    std::string_view
+    getName(void) const noexcept override
+    {
+        return "stb_image";
+    }
+
+    bool
+    canDecode(std::span<const unsigned char>) const noexcept override
+    {
+        return true;
+    }
+
+    PixelBuffer
+    decode(std::span<const unsigned char> encoded, const DecodeOptions &options, ImageData &data) const override
+    {
+        stbi_set_flip_vertically_on_load_thread(options.flip_vertically);
+        PixelBuffer pixels{stbi_load_from_memory(encoded.data(), static_cast<int>(encoded.size()), &data.width, &data.height, &data.channels, 0),
+                           stbi_image_free};
+        if (nullptr == pixels || options.scale_denominator <= 1) {
+            return pixels;
+        }
+        return downscale(std::move(pixels), data, options.scale_denominator);
+    }
+};
+
+#ifdef UTILS_HAS_JPEG
+/* libjpeg reports errors by calling error_exit, which must not return */
+struct JpegErrorManager
+{
+    jpeg_error_mgr manager;
+    std::jmp_buf jump_buffer;
+};
+
+[[noreturn]] void
+jpegErrorExit(j_common_ptr info)
+{
+    std::longjmp(reinterpret_cast<JpegErrorManager *>(info->err)->jump_buffer, 1);
+}
+
+/*
+ * libjpeg-turbo has SIMD IDCT, upsampling and colour conversion, and scales by 1/2, 1/4 and 1/8
+ * in the IDCT itself so the skipped coefficients are never transformed.
+ */
+class JpegDecoder final : public ImageDecoder
+{
+  public:
+    std::string_view
+    getName(void) const noexcept override
+    {
+        return "libjpeg";
+    }
+
+    bool
+    canDecode(std::span<const unsigned char> encoded) const noexcept override
+    {
+        return encoded.size() >= 3 && 0xFF == encoded[0] && 0xD8 == encoded[1] && 0xFF == encoded[2];
+    }
+
+    PixelBuffer
+    decode(std::span<const unsigned char> encoded, const DecodeOptions &options, ImageData &data) const override
+    {
+        /* Only trivially destructible locals may live across the jump */
+        jpeg_decompress_struct info{};
+        JpegErrorManager error{};
+        unsigned char *volatile pixels = nullptr;
+
+        info.err = jpeg_std_error(&error.manager);
+        error.manager.error_exit = jpegErrorExit;
+        if (0 != setjmp(error.jump_buffer)) {
+            jpeg_destroy_decompress(&info);
+            std::free(pixels);
+            return {nullptr, std::free};
+        }
+
+        jpeg_create_decompress(&info);
+        const unsigned long encoded_size = encoded.size();
+        jpeg_mem_src(&info, encoded.data(), encoded_size);
+        jpeg_read_header(&info, TRUE);
+        info.out_color_space = JCS_GRAYSCALE == info.jpeg_color_space ? JCS_GRAYSCALE : JCS_RGB;
+        info.scale_num = 1;
+        info.scale_denom = static_cast<unsigned>(std::clamp(options.scale_denominator, 1, 8));
+        jpeg_start_decompress(&info);
+
+        data.width = static_cast<int>(info.output_width);
+        data.height = static_cast<int>(info.output_height);
+        data.channels = info.output_components;
+        const std::size_t stride = static_cast<std::size_t>(info.output_width) * static_cast<std::size_t>(info.output_components);
+        pixels = static_cast<unsigned char *>(std::malloc(stride * info.output_height));
+        if (nullptr == pixels) {
+            jpeg_destroy_decompress(&info);
+            return {nullptr, std::free};
+        }
+
+        /* Flipping is free, the scanlines are written straight into their final row */
+        while (info.output_scanline < info.output_height) {
+            const JDIMENSION row = options.flip_vertically ? info.output_height - 1 - info.output_scanline : info.output_scanline;
+            JSAMPROW row_pointer = pixels + row * stride;
+            jpeg_read_scanlines(&info, &row_pointer, 1);
+        }
+        jpeg_finish_decompress(&info);
+        jpeg_destroy_decompress(&info);
+        return {pixels, std::free};
+    }
+};
+#endif
+
+std::vector<std::unique_ptr<ImageDecoder>> &
+decoderRegistry(void)
+{
+    static std::vector<std::unique_ptr<ImageDecoder>> decoders = [] {
+        std::vector<std::unique_ptr<ImageDecoder>> built_in{};
+#ifdef UTILS_HAS_JPEG
+        built_in.push_back(std::make_unique<JpegDecoder>());
+#endif
+        built_in.push_back(std::make_unique<StbImageDecoder>());
+        return built_in;
+    }();
+    return decoders;
+}
+
+}; // namespace
+
+void
+registerImageDecoder(std::unique_ptr<ImageDecoder> decoder)
+{
+    std::vector<std::unique_ptr<ImageDecoder>> &decoders = decoderRegistry();
+    decoders.insert(decoders.begin(), std::move(decoder));
+}
+
+std::span<const std::unique_ptr<ImageDecoder>>
+getImageDecoders(void)
+{
+    return decoderRegistry();
+}
+
+Image::Image(const std::filesystem::path &img_path, const DecodeOptions &options) noexcept
 {
-    stbi_set_flip_vertically_on_load(true);
-    data = {0, 0, 0, nullptr};
     if (!std::filesystem::is_regular_file(img_path)) {
         fmt::print(stderr, "Image: Path '{}' is not a file.\n", img_path.string());
         return;
     }
-    data.pixels = stbi_load(img_path.c_str(), &data.width, &data.height, &data.channels, 0);
+    std::ifstream stream{img_path, std::ios::in | std::ios::binary};
+    const std::vector<unsigned char> encoded{std::istreambuf_iterator<char>{stream}, std::istreambuf_iterator<char>{}};
+    decode(encoded, options);
+    if (nullptr == data.pixels) {
+        fmt::print(stderr, "Image: Failed to decode '{}'.\n", img_path.string());
+    }
 }
 
-Image::~Image() noexcept
+Image::Image(std::span<const unsigned char> encoded, const DecodeOptions &options) noexcept
+{
+    decode(encoded, options);
+}
+
+void
+Image::decode(std::span<const unsigned char> encoded, const DecodeOptions &options) noexcept
 {
-    if (nullptr != data.pixels) {
-        stbi_image_free(data.pixels);
+    for (const std::unique_ptr<ImageDecoder> &decoder : getImageDecoders()) {
+        if (!decoder->canDecode(encoded)) {
+            continue;
+        }
+        ImageData decoded{0, 0, 0, nullptr};
+        PixelBuffer buffer = decoder->decode(encoded, options, decoded);
+        if (nullptr != buffer) {
+            pixels = std::move(buffer);
+            data = decoded;
+            data.pixels = pixels.get();
+            decoder_name = decoder->getName();
+            return;
+        }
     }
 }
 
@@ -43,6 +266,113 @@ Image::getImageData(void) const noexcept
     return data;
 }
 
+std::string_view
+Image::getDecoderName(void) const noexcept
+{
+    return decoder_name;
+}
+
+FileCache &
+FileCache::getInstance(void)
+{
+    static FileCache cache{};
+    return cache;
+}
+
+void
+FileCache::setEnabled(bool enabled) noexcept
+{
+    is_enabled.store(enabled, std::memory_order_relaxed);
+}
+
+std::shared_ptr<const std::string>
+FileCache::getText(const std::filesystem::path &file_path)
+{
+    return get(texts, file_path, [&file_path] {
+        std::ifstream stream{file_path, std::ios::in | std::ios::binary};
+        if (!stream.is_open()) {
+            fmt::print(stderr, "FileCache::getText: Failed to open file {}.\n", file_path.string());
+            return std::make_shared<const std::string>();
+        }
+        return std::make_shared<const std::string>(std::istreambuf_iterator<char>{stream}, std::istreambuf_iterator<char>{});
+    });
+}
+
+std::shared_ptr<const Image>
+FileCache::getImage(const std::filesystem::path &image_path)
+{
+    return get(images, image_path, [&image_path] { return std::make_shared<const Image>(image_path); });
+}
+
+std::size_t
+FileCache::getHitCount(void) const noexcept
+{
+    return hits.load(std::memory_order_relaxed);
+}
+
+std::size_t
+FileCache::getLoadCount(void) const noexcept
+{
+    return loads.load(std::memory_order_relaxed);
+}
+
+template <class T, class Load>
+std::shared_ptr<const T>
+FileCache::get(Entries<T> &entries, const std::filesystem::path &file_path, Load &&load)
+{
+    if (!is_enabled.load(std::memory_order_relaxed)) {
+        loads.fetch_add(1, std::memory_order_relaxed);
+        return load();
+    }
+
+    std::promise<std::shared_ptr<const T>> promise{};
+    {
+        std::unique_lock lock{mutex};
+        const auto [entry, inserted] = entries.try_emplace(file_path.lexically_normal().string());
+        if (!inserted) {
+            const std::shared_future<std::shared_ptr<const T>> loaded = entry->second;
+            lock.unlock();
+            hits.fetch_add(1, std::memory_order_relaxed);
+            return loaded.get();
+        }
+        entry->second = promise.get_future().share();
+    }
+    loads.fetch_add(1, std::memory_order_relaxed);
+    /* Outside of the lock so that different files load in parallel */
+    std::shared_ptr<const T> value = load();
+    promise.set_value(value);
+    return value;
+}
+
+CommandLine::CommandLine(int argc, char **argv)
+{
+    for (int i = 1; i < argc; ++i) {
+        arguments.emplace_back(argv[i]);
+    }
+}
+
+bool
+CommandLine::hasFlag(std::string_view name) const noexcept
+{
+    for (std::string_view argument : arguments) {
+        if (argument.starts_with("--") && argument.substr(2) == name) {
+            return true;
+        }
+    }
+    return false;
+}
+
+std::optional<std::string_view>
+CommandLine::getValue(std::string_view name) const noexcept
+{
+    for (std::string_view argument : arguments) {
+        if (argument.starts_with("--") && argument.substr(2).starts_with(name) && argument.size() > name.size() + 2 && '=' == argument[name.size() + 2]) {
+            return argument.substr(name.size() + 3);
+        }
+    }
+    return std::nullopt;
+}
+
 void
 ScrollingColour::UpdateColours(void) noexcept
 {
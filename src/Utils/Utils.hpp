@@ -2,7 +2,19 @@
 #define UTILS_HPP
 
 #include <array>
+#include <atomic>
+#include <charconv>
+#include <cstdlib>
 #include <filesystem>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
 
 namespace Utils
 {
@@ -15,10 +27,17 @@ struct RGBColour
 class ScrollingColour
 {
   public:
+    /* Redraws per second for the scroll to look continuous, it advances at the same speed whatever the frame rate */
+    static constexpr double UPDATE_RATE{20.0};
+
     RGBColour getNext(void) noexcept;
+    /* Advance by the steps due since the previous call, time being in seconds */
+    RGBColour getAt(double time) noexcept;
     RGBColour getCurrent(void) const noexcept;
 
   private:
+    static constexpr double STEPS_PER_SECOND{60.0};
+
     void UpdateColours(void) noexcept;
     enum class ScrollingState
     {
@@ -28,6 +47,7 @@ class ScrollingColour
     };
     ScrollingState state = ScrollingState::RED;
     RGBColour colour = {1.0f, 0.0f, 0.0f};
+    std::optional<long long> last_step{};
 };
 
 struct ImageData
@@ -36,20 +56,125 @@ struct ImageData
     unsigned char *pixels;
 };
 
+struct DecodeOptions
+{
+    /* Shrink by 1, 2, 4 or 8 while decoding, for when only a smaller mip level is needed */
+    int scale_denominator = 1;
+    /* Bottom row first, as glTexImage2D expects */
+    bool flip_vertically = true;
+};
+
+/* Pixels released by whichever allocator the decoder used */
+using PixelBuffer = std::unique_ptr<unsigned char, void (*)(void *)>;
+
+class ImageDecoder
+{
+  public:
+    virtual ~ImageDecoder() noexcept = default;
+
+    virtual std::string_view getName(void) const noexcept = 0;
+    /* Only looks at the signature, decode() may still fail */
+    virtual bool canDecode(std::span<const unsigned char> encoded) const noexcept = 0;
+    /* Empty buffer on failure */
+    virtual PixelBuffer decode(std::span<const unsigned char> encoded, const DecodeOptions &options, ImageData &data) const = 0;
+};
+
+/*
+ * Decoders are tried in order until one succeeds, stb_image always comes last and accepts anything.
+ * Registered decoders go before the built-in ones, registration is not thread safe.
+ */
+void registerImageDecoder(std::unique_ptr<ImageDecoder> decoder);
+std::span<const std::unique_ptr<ImageDecoder>> getImageDecoders(void);
+
 class Image
 {
   public:
-    Image(const std::filesystem::path &img_path) noexcept;
-    ~Image() noexcept;
+    Image(const std::filesystem::path &img_path, const DecodeOptions &options = {}) noexcept;
+    Image(std::span<const unsigned char> encoded, const DecodeOptions &options = {}) noexcept;
+    ~Image() noexcept = default;
     Image(const Image &) = delete;
     Image(Image &&) = delete;
     Image &operator=(const Image &) = delete;
     Image &operator=(Image &&) = delete;
 
     const ImageData &getImageData(void) const noexcept;
+    /* Name of the decoder that produced the pixels, empty if none did */
+    std::string_view getDecoderName(void) const noexcept;
+
+  private:
+    void decode(std::span<const unsigned char> encoded, const DecodeOptions &options) noexcept;
+
+    ImageData data{0, 0, 0, nullptr};
+    PixelBuffer pixels{nullptr, std::free};
+    std::string_view decoder_name{};
+};
+
+/*
+ * Text files and decoded images shared by everyone loading the same file, several hosted scenes for instance.
+ * Disabled by default so that a single application does not keep pixels around once uploaded, every call then loads
+ * the file again. Thread safe, callers asking for a file being loaded wait for it instead of loading it twice.
+ */
+class FileCache
+{
+  public:
+    static FileCache &getInstance(void);
+
+    void setEnabled(bool enabled) noexcept;
+
+    /* Empty on failure */
+    std::shared_ptr<const std::string> getText(const std::filesystem::path &file_path);
+    /* Decoded with the default options */
+    std::shared_ptr<const Image> getImage(const std::filesystem::path &image_path);
+
+    /* Requests served from the cache and files actually loaded */
+    std::size_t getHitCount(void) const noexcept;
+    std::size_t getLoadCount(void) const noexcept;
+
+    FileCache(const FileCache &) = delete;
+    FileCache(FileCache &&) = delete;
+    FileCache &operator=(const FileCache &) = delete;
+    FileCache &operator=(FileCache &&) = delete;
+
+  private:
+    template <class T> using Entries = std::unordered_map<std::string, std::shared_future<std::shared_ptr<const T>>>;
+
+    FileCache(void) = default;
+    ~FileCache() = default;
+
+    template <class T, class Load> std::shared_ptr<const T> get(Entries<T> &entries, const std::filesystem::path &file_path, Load &&load);
+
+    std::atomic<bool> is_enabled{false};
+    std::mutex mutex{};
+    Entries<std::string> texts{};
+    Entries<Image> images{};
+    std::atomic<std::size_t> hits{0}, loads{0};
+};
+
+/* Launch options of the form --name or --name=value */
+class CommandLine
+{
+  public:
+    CommandLine(void) noexcept = default;
+    CommandLine(int argc, char **argv);
+
+    bool hasFlag(std::string_view name) const noexcept;
+    std::optional<std::string_view> getValue(std::string_view name) const noexcept;
+
+    template <class T>
+    T
+    getNumber(std::string_view name, T fallback) const noexcept
+    {
+        const std::optional<std::string_view> value = getValue(name);
+        if (!value) {
+            return fallback;
+        }
+        T number = fallback;
+        const auto result = std::from_chars(value->data(), value->data() + value->size(), number);
+        return std::errc{} == result.ec ? number : fallback;
+    }
 
   private:
-    ImageData data;
+    std::vector<std::string_view> arguments{};
 };
 
 template <class T, std::size_t N>
@@ -0,0 +1,156 @@
+#include "Animation.hpp"
+#include "Utils.hpp"
+
+#include <fmt/core.h>
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+/* Cost of evaluating animation tracks every frame, per kind and against one object per track holding its own keys */
+
+/* What every animated object would otherwise carry, evaluated one after the other */
+struct ObjectTween
+{
+    double start, duration;
+    Animation::Playback playback;
+    Animation::Easing easing;
+    std::vector<float> key_times, key_values;
+    std::array<float, 4> value;
+
+    void
+    update(double time) noexcept
+    {
+        const double elapsed = (time - start) / duration;
+        float phase = 0.0f;
+        switch (playback) {
+        case Animation::Playback::LOOP:
+            phase = static_cast<float>(elapsed - std::floor(elapsed));
+            break;
+        case Animation::Playback::PING_PONG:
+            phase = static_cast<float>(1.0 - std::fabs((elapsed * 0.5 - std::floor(elapsed * 0.5)) * 2.0 - 1.0));
+            break;
+        case Animation::Playback::ONCE:
+            phase = static_cast<float>(std::clamp(elapsed, 0.0, 1.0));
+            break;
+        }
+        std::size_t segment = 0;
+        while (segment + 2 < key_times.size() && phase > key_times[segment + 1]) {
+            ++segment;
+        }
+        float weight = std::clamp((phase - key_times[segment]) / (key_times[segment + 1] - key_times[segment]), 0.0f, 1.0f);
+        switch (easing) {
+        case Animation::Easing::SMOOTH_STEP:
+            weight = weight * weight * (3.0f - 2.0f * weight);
+            break;
+        case Animation::Easing::CUBIC_IN:
+            weight = weight * weight * weight;
+            break;
+        case Animation::Easing::CUBIC_OUT:
+            weight = 1.0f - (1.0f - weight) * (1.0f - weight) * (1.0f - weight);
+            break;
+        case Animation::Easing::CUBIC_IN_OUT:
+            weight = 0.5f > weight ? 4.0f * weight * weight * weight : 1.0f - 4.0f * (1.0f - weight) * (1.0f - weight) * (1.0f - weight);
+            break;
+        case Animation::Easing::STEP:
+            weight = 1.0f <= weight ? 1.0f : 0.0f;
+            break;
+        case Animation::Easing::LINEAR:
+            break;
+        }
+        for (std::size_t component = 0; component < value.size(); ++component) {
+            const float from = key_values[segment * 4 + component];
+            value[component] = from + (key_values[segment * 4 + 4 + component] - from) * weight;
+        }
+    }
+};
+
+struct TrackSource
+{
+    Animation::Timing timing;
+    Animation::Easing easing;
+    std::vector<float> key_times, key_values;
+};
+
+static std::vector<TrackSource>
+generateTracks(std::size_t count, std::size_t components, std::uint32_t seed)
+{
+    std::mt19937 generator{seed};
+    std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+    std::vector<TrackSource> tracks(count);
+    for (TrackSource &track : tracks) {
+        const auto start = static_cast<double>(unit(generator)) * 4.0;
+        const auto duration = 0.5 + static_cast<double>(unit(generator)) * 4.0;
+        track.timing = {start, duration, static_cast<Animation::Playback>(generator() % 3)};
+        track.easing = static_cast<Animation::Easing>(generator() % 6);
+        const std::size_t key_count = 2 + generator() % 4;
+        for (std::size_t key = 0; key < key_count; ++key) {
+            track.key_times.push_back(static_cast<float>(key) / static_cast<float>(key_count - 1));
+            for (std::size_t component = 0; component < components; ++component) {
+                track.key_values.push_back(unit(generator) * 2.0f - 1.0f);
+            }
+        }
+    }
+    return tracks;
+}
+
+template <class Function>
+static double
+timeFrames(int frames, Function &&function)
+{
+    /* One warm-up frame so that the data is in the caches */
+    function(0.0);
+    const auto start = std::chrono::steady_clock::now();
+    for (int frame = 0; frame < frames; ++frame) {
+        function(static_cast<double>(frame) / 60.0);
+    }
+    const std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+    return elapsed.count() / frames;
+}
+
+static void
+printRow(const char *name, std::size_t tracks, double milliseconds)
+{
+    fmt::print("{:<16} {:>9} {:>10.3f} {:>9.2f} {:>14.3f}\n", name, tracks, milliseconds, milliseconds * 1e6 / static_cast<double>(tracks),
+               milliseconds * 1e5 / static_cast<double>(tracks));
+}
+
+int
+main(int argc, char **argv)
+{
+    const Utils::CommandLine options{argc, argv};
+    const std::size_t track_count = std::max(options.getNumber<std::size_t>("tracks", 100000), std::size_t{1});
+    const int frames = std::max(options.getNumber<int>("frames", 200), 1);
+
+    fmt::print("{} tracks, {} frames\n", track_count, frames);
+    fmt::print("{:<16} {:>9} {:>10} {:>9} {:>14}\n", "Kind", "Tracks", "ms/frame", "ns/track", "ms/100k tracks");
+    static constexpr std::array<std::pair<const char *, Animation::TrackKind>, 4> KINDS{{{"scalar", Animation::TrackKind::SCALAR},
+                                                                                        {"vec3", Animation::TrackKind::VEC3},
+                                                                                        {"colour", Animation::TrackKind::COLOUR},
+                                                                                        {"rotation", Animation::TrackKind::ROTATION}}};
+    for (const auto &[name, kind] : KINDS) {
+        Animation::TrackGroup group{kind};
+        for (const TrackSource &track : generateTracks(track_count, Animation::getComponentCount(kind), 1)) {
+            group.add(track.timing, track.key_times, track.key_values, track.easing);
+        }
+        printRow(name, track_count, timeFrames(frames, [&group](double time) { group.evaluate(time); }));
+    }
+
+    /* The same colour tracks, every object evaluating its own */
+    std::vector<ObjectTween> objects{};
+    for (TrackSource &track : generateTracks(track_count, 4, 1)) {
+        objects.push_back({track.timing.start, track.timing.duration, track.timing.playback, track.easing, std::move(track.key_times),
+                           std::move(track.key_values), {}});
+    }
+    printRow("colour objects", track_count, timeFrames(frames, [&objects](double time) {
+                 for (ObjectTween &object : objects) {
+                     object.update(time);
+                 }
+             }));
+    return EXIT_SUCCESS;
+}
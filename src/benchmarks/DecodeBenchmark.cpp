@@ -0,0 +1,142 @@
+#include "Capture.hpp"
+#include "Utils.hpp"
+
+#include <fmt/core.h>
+
+#ifdef DECODE_BENCHMARK_HAS_JPEG
+#include <cstdio>
+#include <jpeglib.h>
+#endif
+
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+/* Decode throughput of every registered decoder over generated images, in MB/s of decoded pixels */
+
+struct EncodedImage
+{
+    std::string name;
+    int width, height;
+    std::vector<unsigned char> bytes;
+};
+
+/* Smooth gradients with some noise and hard edges, which compresses like a photograph with text on it */
+static std::vector<std::uint8_t>
+generatePixels(int width, int height)
+{
+    std::vector<std::uint8_t> pixels(static_cast<std::size_t>(width * height) * 4);
+    std::uint32_t state = 0x12345678u;
+    for (int y = 0; y < height; ++y) {
+        for (int x = 0; x < width; ++x) {
+            state = state * 1664525u + 1013904223u;
+            const auto noise = static_cast<int>(state >> 28);
+            const bool stripe = 0 == ((x / 37 + y / 53) % 7);
+            const auto offset = static_cast<std::size_t>(y * width + x) * 4;
+            pixels[offset + 0] = static_cast<std::uint8_t>(stripe ? 255 : (x * 255 / width + noise) & 0xFF);
+            pixels[offset + 1] = static_cast<std::uint8_t>(stripe ? 255 : (y * 255 / height + noise) & 0xFF);
+            pixels[offset + 2] = static_cast<std::uint8_t>(128.0 + 127.0 * std::sin((x + y) * 0.01));
+            pixels[offset + 3] = 255;
+        }
+    }
+    return pixels;
+}
+
+static std::vector<unsigned char>
+encodePng(const std::vector<std::uint8_t> &pixels, int width, int height)
+{
+    const std::filesystem::path file_path = std::filesystem::temp_directory_path() / "decode-benchmark.png";
+    Capture::writePng(file_path, {0, width, height, pixels});
+    std::ifstream stream{file_path, std::ios::in | std::ios::binary};
+    std::vector<unsigned char> bytes{std::istreambuf_iterator<char>{stream}, std::istreambuf_iterator<char>{}};
+    std::filesystem::remove(file_path);
+    return bytes;
+}
+
+#ifdef DECODE_BENCHMARK_HAS_JPEG
+static std::vector<unsigned char>
+encodeJpeg(const std::vector<std::uint8_t> &pixels, int width, int height, int quality)
+{
+    jpeg_compress_struct info{};
+    jpeg_error_mgr error{};
+    info.err = jpeg_std_error(&error);
+    jpeg_create_compress(&info);
+
+    unsigned char *buffer = nullptr;
+    unsigned long size = 0;
+    jpeg_mem_dest(&info, &buffer, &size);
+    info.image_width = static_cast<JDIMENSION>(width);
+    info.image_height = static_cast<JDIMENSION>(height);
+    info.input_components = 4;
+    info.in_color_space = JCS_EXT_RGBA;
+    jpeg_set_defaults(&info);
+    jpeg_set_quality(&info, quality, TRUE);
+    jpeg_start_compress(&info, TRUE);
+    while (info.next_scanline < info.image_height) {
+        JSAMPROW row = const_cast<std::uint8_t *>(pixels.data()) + static_cast<std::size_t>(info.next_scanline) * static_cast<std::size_t>(width) * 4;
+        jpeg_write_scanlines(&info, &row, 1);
+    }
+    jpeg_finish_compress(&info);
+    jpeg_destroy_compress(&info);
+
+    std::vector<unsigned char> bytes{buffer, buffer + size};
+    std::free(buffer);
+    return bytes;
+}
+#endif
+
+static std::vector<EncodedImage>
+generateCorpus(void)
+{
+    std::vector<EncodedImage> corpus{};
+    for (int size : {512, 1024, 2048}) {
+        const std::vector<std::uint8_t> pixels = generatePixels(size, size);
+#ifdef DECODE_BENCHMARK_HAS_JPEG
+        corpus.push_back({fmt::format("jpeg q90 {}x{}", size, size), size, size, encodeJpeg(pixels, size, size, 90)});
+#endif
+        corpus.push_back({fmt::format("png {}x{}", size, size), size, size, encodePng(pixels, size, size)});
+    }
+    return corpus;
+}
+
+int
+main(int argc, char **argv)
+{
+    const Utils::CommandLine options{argc, argv};
+    const int iterations = std::max(options.getNumber<int>("iterations", 10), 1);
+
+    const std::vector<EncodedImage> corpus = generateCorpus();
+    fmt::print("{:<20} {:<10} {:>5} {:>12} {:>12} {:>10}\n", "Image", "Decoder", "Scale", "Encoded MB/s", "Decoded MB/s", "ms/image");
+    for (const EncodedImage &image : corpus) {
+        for (const std::unique_ptr<Utils::ImageDecoder> &decoder : Utils::getImageDecoders()) {
+            if (!decoder->canDecode(image.bytes)) {
+                continue;
+            }
+            for (int scale : {1, 2, 4, 8}) {
+                std::size_t decoded_bytes = 0;
+                const auto start = std::chrono::steady_clock::now();
+                for (int i = 0; i < iterations; ++i) {
+                    Utils::ImageData data{0, 0, 0, nullptr};
+                    const Utils::PixelBuffer pixels = decoder->decode(image.bytes, {scale, true}, data);
+                    if (nullptr == pixels) {
+                        fmt::print(stderr, "main: {} failed to decode {}.\n", decoder->getName(), image.name);
+                        return EXIT_FAILURE;
+                    }
+                    decoded_bytes += static_cast<std::size_t>(data.width * data.height * data.channels);
+                }
+                const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+                const double encoded_megabytes = static_cast<double>(image.bytes.size() * static_cast<std::size_t>(iterations)) / 1e6;
+                const double decoded_megabytes = static_cast<double>(decoded_bytes) / 1e6;
+                fmt::print("{:<20} {:<10} {:>5} {:>12.1f} {:>12.1f} {:>10.2f}\n", image.name, decoder->getName(), fmt::format("1/{}", scale),
+                           encoded_megabytes / elapsed.count(), decoded_megabytes / elapsed.count(), elapsed.count() * 1e3 / iterations);
+            }
+        }
+    }
+    return EXIT_SUCCESS;
+}
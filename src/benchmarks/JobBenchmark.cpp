@@ -0,0 +1,176 @@
+#include "Culling.hpp"
+#include "JobSystem.hpp"
+#include "Utils.hpp"
+
+#include <fmt/core.h>
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <functional>
+#include <string>
+#include <thread>
+#include <vector>
+
+/* Scaling of typical CPU frame work over the job system, from 1 worker up to one per hardware thread */
+
+struct SceneObject
+{
+    glm::vec3 position;
+    glm::vec3 axis;
+    float angle;
+    float speed;
+};
+
+struct SpriteVertex
+{
+    glm::vec2 position;
+    glm::vec2 uv;
+};
+
+struct FrameData
+{
+    std::vector<SceneObject> objects;
+    std::vector<glm::mat4> world_matrices;
+    std::vector<std::uint8_t> visible;
+    std::vector<SpriteVertex> vertices;
+};
+
+struct Phase
+{
+    std::string name;
+    std::function<void(Utils::JobSystem &, FrameData &, float)> run;
+};
+
+static FrameData
+generateFrameData(std::size_t object_count)
+{
+    FrameData data{};
+    data.objects.reserve(object_count);
+    std::uint32_t state = 0x9E3779B9u;
+    auto next = [&state] {
+        state = state * 1664525u + 1013904223u;
+        return static_cast<float>(state >> 8) / static_cast<float>(1u << 24);
+    };
+    for (std::size_t i = 0; i < object_count; ++i) {
+        data.objects.push_back({glm::vec3{next() * 200.0f - 100.0f, next() * 200.0f - 100.0f, -next() * 200.0f}, glm::vec3{next(), next() + 0.1f, next()},
+                                next() * 6.28f, next() * 2.0f});
+    }
+    data.world_matrices.resize(object_count);
+    data.visible.resize(object_count);
+    data.vertices.resize(object_count * 4);
+    return data;
+}
+
+static std::vector<Phase>
+getPhases(std::size_t grain)
+{
+    std::vector<Phase> phases{};
+    phases.push_back({"transforms", [grain](Utils::JobSystem &jobs, FrameData &data, float time) {
+                          jobs.parallelFor(
+                              data.objects.size(),
+                              [&data, time](std::size_t begin, std::size_t end) {
+                                  for (std::size_t i = begin; i < end; ++i) {
+                                      const SceneObject &object = data.objects[i];
+                                      glm::mat4 matrix = glm::translate(glm::mat4{1.0f}, object.position);
+                                      matrix = glm::rotate(matrix, object.angle + time * object.speed, object.axis);
+                                      data.world_matrices[i] = glm::scale(matrix, glm::vec3{0.5f});
+                                  }
+                              },
+                              grain);
+                      }});
+    phases.push_back({"culling", [grain](Utils::JobSystem &jobs, FrameData &data, float) {
+                          const Culling::Frustum frustum{glm::perspective(glm::radians(60.0f), 16.0f / 9.0f, 0.1f, 150.0f)};
+                          const Culling::BoundingBox unit_box{glm::vec3{-1.0f}, glm::vec3{1.0f}};
+                          jobs.parallelFor(
+                              data.objects.size(),
+                              [&data, &frustum, &unit_box](std::size_t begin, std::size_t end) {
+                                  for (std::size_t i = begin; i < end; ++i) {
+                                      const Culling::BoundingBox box = unit_box.transformed(data.world_matrices[i]);
+                                      data.visible[i] = Culling::Containment::OUTSIDE != frustum.test(box);
+                                  }
+                              },
+                              grain);
+                      }});
+    phases.push_back({"sprite vertices", [grain](Utils::JobSystem &jobs, FrameData &data, float) {
+                          static constexpr std::array<glm::vec2, 4> CORNERS{glm::vec2{-1.0f, -1.0f}, glm::vec2{1.0f, -1.0f}, glm::vec2{1.0f, 1.0f},
+                                                                            glm::vec2{-1.0f, 1.0f}};
+                          jobs.parallelFor(
+                              data.objects.size(),
+                              [&data](std::size_t begin, std::size_t end) {
+                                  for (std::size_t i = begin; i < end; ++i) {
+                                      const glm::mat4 &matrix = data.world_matrices[i];
+                                      for (std::size_t corner = 0; corner < CORNERS.size(); ++corner) {
+                                          const glm::vec4 position = matrix * glm::vec4{CORNERS[corner].x, CORNERS[corner].y, 0.0f, 1.0f};
+                                          data.vertices[i * 4 + corner] = {glm::vec2{position.x, position.y},
+                                                                           glm::vec2{CORNERS[corner].x * 0.5f + 0.5f, CORNERS[corner].y * 0.5f + 0.5f}};
+                                      }
+                                  }
+                              },
+                              grain);
+                      }});
+    return phases;
+}
+
+static std::vector<std::size_t>
+getWorkerCounts(std::size_t max_workers)
+{
+    std::vector<std::size_t> counts{};
+    for (std::size_t count = 1; count < max_workers; count *= 2) {
+        counts.push_back(count);
+    }
+    counts.push_back(max_workers);
+    return counts;
+}
+
+int
+main(int argc, char **argv)
+{
+    const Utils::CommandLine options{argc, argv};
+    const auto object_count = std::max(options.getNumber<std::size_t>("objects", 200000), std::size_t{1});
+    const int frames = std::max(options.getNumber<int>("frames", 100), 1);
+    const auto grain = options.getNumber<std::size_t>("grain", 256);
+    const std::size_t max_workers = std::max(options.getNumber<std::size_t>("workers", std::thread::hardware_concurrency()), std::size_t{1});
+    const bool pin_workers = options.hasFlag("pin");
+
+    FrameData data = generateFrameData(object_count);
+    const std::vector<Phase> phases = getPhases(grain);
+    std::vector<double> single_worker_milliseconds(phases.size(), 0.0);
+
+    fmt::print("{} objects, {} frames, grain {}{}\n", object_count, frames, grain, pin_workers ? ", pinned workers" : "");
+    fmt::print("{:<16} {:>7} {:>10} {:>8} {:>10} {:>8} {:>12} {:>9}\n", "Phase", "Workers", "ms/frame", "Speedup", "Jobs", "Steals", "Failed steals",
+               "Idle %");
+    for (std::size_t worker_count : getWorkerCounts(max_workers)) {
+        Utils::JobSystem jobs{{worker_count, pin_workers}};
+        for (std::size_t phase = 0; phase < phases.size(); ++phase) {
+            /* One warm-up frame so that the workers are awake and the caches hold the data */
+            phases[phase].run(jobs, data, 0.0f);
+            jobs.resetStats();
+            const auto start = std::chrono::steady_clock::now();
+            for (int frame = 0; frame < frames; ++frame) {
+                phases[phase].run(jobs, data, static_cast<float>(frame) / 60.0f);
+            }
+            const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+            Utils::JobWorkerStats total{0, 0, 0, 0.0};
+            for (const Utils::JobWorkerStats &stats : jobs.getStats()) {
+                total.executed += stats.executed;
+                total.steals += stats.steals;
+                total.failed_steals += stats.failed_steals;
+                total.idle_seconds += stats.idle_seconds;
+            }
+            const double milliseconds = elapsed.count() * 1e3 / frames;
+            if (1 == worker_count) {
+                single_worker_milliseconds[phase] = milliseconds;
+            }
+            const double idle_percent = 100.0 * total.idle_seconds / (elapsed.count() * static_cast<double>(worker_count));
+            fmt::print("{:<16} {:>7} {:>10.3f} {:>7.2f}x {:>10} {:>8} {:>12} {:>8.1f}%\n", phases[phase].name, worker_count, milliseconds,
+                       single_worker_milliseconds[phase] / milliseconds, total.executed, total.steals, total.failed_steals, idle_percent);
+        }
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,112 @@
+#include "../BaseApplication.hpp"
+
+#include "Resource.hpp"
+#include "TextureUpload.hpp"
+#include "Utils.hpp"
+
+#include <fmt/core.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/* Upload time and estimated memory of the texture upload path against a plain glTexImage2D to GL_RGB */
+class UploadBenchmark : public BaseApplication
+{
+  public:
+    virtual ~UploadBenchmark() = default;
+
+  private:
+    void
+    setup(void) override
+    {
+        const int iterations = std::max(options.getNumber<int>("iterations", 10), 1);
+        fmt::print("glTexStorage2D {}\n", TextureUpload::hasTextureStorage() ? "available" : "unavailable");
+        fmt::print("{:<16} {:<10} {:>10} {:>10} {:>10}\n", "Image", "Path", "Submit ms", "Total ms", "MiB");
+
+        for (int size : {512, 1024, 2048}) {
+            for (int channels : {1, 3, 4}) {
+                const std::vector<unsigned char> pixels = generatePixels(size, channels);
+                const Utils::ImageData data{size, size, channels, const_cast<unsigned char *>(pixels.data())};
+                const std::string name = fmt::format("{}x{}x{}", size, size, channels);
+
+                measure(name, "glTexImage", iterations, [&data](Resource::Texture &texture) { return uploadLegacy(texture, data); });
+                measure(name, "storage", iterations, [&data](Resource::Texture &texture) { return TextureUpload::upload(texture, data); });
+            }
+        }
+        glfwSetWindowShouldClose(window, GLFW_TRUE);
+    }
+
+    static std::vector<unsigned char>
+    generatePixels(int size, int channels)
+    {
+        std::vector<unsigned char> pixels(static_cast<std::size_t>(size * size * channels));
+        for (std::size_t i = 0; i < pixels.size(); ++i) {
+            pixels[i] = static_cast<unsigned char>(i * 31 + i / 7);
+        }
+        return pixels;
+    }
+
+    /* What the chapters did before, with the source format at least matching the channels */
+    static TextureUpload::UploadStats
+    uploadLegacy(Resource::Texture &texture, const Utils::ImageData &data)
+    {
+        const auto start = std::chrono::steady_clock::now();
+        static constexpr GLenum FORMATS[]{GL_RED, GL_RG, GL_RGB, GL_RGBA};
+        texture = Resource::Texture::create();
+        glBindTexture(GL_TEXTURE_2D, texture.get());
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, data.width, data.height, 0, FORMATS[data.channels - 1], GL_UNSIGNED_BYTE, data.pixels);
+        glGenerateMipmap(GL_TEXTURE_2D);
+        const std::size_t bytes = Resource::estimateTextureSize(data.width, data.height, GL_RGB, true);
+        texture.setSize(bytes);
+        const std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+        return {elapsed.count(), bytes, false};
+    }
+
+    /* Submit time is what the render thread pays, total waits for the GPU to finish the copy and the mipmaps */
+    template <class Function>
+    void
+    measure(const std::string &name, const char *path, int iterations, Function &&function)
+    {
+        double submit_milliseconds = 0.0;
+        double total_milliseconds = 0.0;
+        std::size_t bytes = 0;
+        for (int i = 0; i < iterations; ++i) {
+            Resource::Texture texture{};
+            const auto start = std::chrono::steady_clock::now();
+            const TextureUpload::UploadStats stats = function(texture);
+            glFinish();
+            const std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+            submit_milliseconds += stats.milliseconds;
+            total_milliseconds += elapsed.count();
+            bytes = stats.bytes;
+        }
+        static constexpr double MEBIBYTE{1024.0 * 1024.0};
+        fmt::print("{:<16} {:<10} {:>10.2f} {:>10.2f} {:>10.2f}\n", name, path, submit_milliseconds / iterations, total_milliseconds / iterations,
+                   static_cast<double>(bytes) / MEBIBYTE);
+    }
+
+    void
+    processInputs(void) override
+    {
+    }
+
+    void
+    render(void) override
+    {
+    }
+
+    void
+    teardown(void) override
+    {
+    }
+};
+
+int
+main(int argc, char **argv)
+{
+    UploadBenchmark app{};
+    return app.run(argc, argv);
+}
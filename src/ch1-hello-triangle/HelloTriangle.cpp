@@ -1,6 +1,7 @@
 #include "../BaseApplication.hpp"
 
 #include "HelloTriangleFiles.hpp"
+#include "Resource.hpp"
 #include "Shader.hpp"
 #include "Utils.hpp"
 
@@ -42,35 +43,39 @@ class HelloTriange : public BaseApplication
         };
 
         /* Generate buffers */
-        glGenVertexArrays(static_cast<GLsizei>(vaos.size()), vaos.data());
-        glGenBuffers(static_cast<GLsizei>(vbos.size()), vbos.data());
-        glGenBuffers(static_cast<GLsizei>(ebos.size()), ebos.data());
+        Resource::createAll(vaos);
+        Resource::createAll(vbos);
+        Resource::createAll(ebos);
 
         /* Bind the VAO first so the latter commands are tied to it */
-        glBindVertexArray(vaos[0]);
+        glBindVertexArray(vaos[0].get());
 
         /* Copy the vertices into the VBO */
-        glBindBuffer(GL_ARRAY_BUFFER, vbos[0]);
+        glBindBuffer(GL_ARRAY_BUFFER, vbos[0].get());
         glBufferData(GL_ARRAY_BUFFER, Utils::arrayDataSize(horizontal_vertices), horizontal_vertices.data(), GL_STATIC_DRAW);
+        vbos[0].setSize(Utils::arrayDataSize(horizontal_vertices));
 
         /* Copie the indices into the EBO */
-        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ebos[0]);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ebos[0].get());
         glBufferData(GL_ELEMENT_ARRAY_BUFFER, Utils::arrayDataSize(horizontal_indices), horizontal_indices.data(), GL_STATIC_DRAW);
+        ebos[0].setSize(Utils::arrayDataSize(horizontal_indices));
 
         /* Set vertices attributes */
         glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(GLfloat), nullptr);
         glEnableVertexAttribArray(0);
 
         /* Bind the VAO first so the latter commands are tied to it */
-        glBindVertexArray(vaos[1]);
+        glBindVertexArray(vaos[1].get());
 
         /* Copy the vertices into the VBO */
-        glBindBuffer(GL_ARRAY_BUFFER, vbos[1]);
+        glBindBuffer(GL_ARRAY_BUFFER, vbos[1].get());
         glBufferData(GL_ARRAY_BUFFER, Utils::arrayDataSize(vertical_vertices), vertical_vertices.data(), GL_STATIC_DRAW);
+        vbos[1].setSize(Utils::arrayDataSize(vertical_vertices));
 
         /* Copie the indices into the EBO */
-        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ebos[1]);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ebos[1].get());
         glBufferData(GL_ELEMENT_ARRAY_BUFFER, Utils::arrayDataSize(vertical_indices), vertical_indices.data(), GL_STATIC_DRAW);
+        ebos[1].setSize(Utils::arrayDataSize(vertical_indices));
 
         /* Set vertices attributes */
         glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(GLfloat), nullptr);
@@ -78,55 +83,70 @@ class HelloTriange : public BaseApplication
 
         horizontal_shader = std::make_unique<Shader>(VERTEX_SHADER_FILE, HORIZONTAL_FRAGMENT_SHADER_FILE);
         vertical_shader = std::make_unique<Shader>(VERTEX_SHADER_FILE, VERTICAL_FRAGMENT_SHADER_FILE);
+
+        damage.addAnimation(Utils::ScrollingColour::UPDATE_RATE);
+
+        input.bind(QUIT, GLFW_KEY_ESCAPE);
     }
 
+    enum Action : Input::ActionId
+    {
+        QUIT
+    };
+
     void
     processInputs(void) override
     {
-        if (glfwGetKey(window, GLFW_KEY_ESCAPE) == GLFW_PRESS)
+        if (input.isDown(QUIT))
             glfwSetWindowShouldClose(window, true);
     }
 
     void
     render(void) override
     {
-        Utils::RGBColour colour = scroller.getNext();
+        Utils::RGBColour colour = scroller.getAt(frame_time);
         glClearColor(colour.r, colour.g, colour.b, 1.0f);
         glClear(GL_COLOR_BUFFER_BIT);
 
         horizontal_shader->useProgram();
-        glBindVertexArray(vaos[0]);
+        glBindVertexArray(vaos[0].get());
         glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
         glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
 
         vertical_shader->useProgram();
-        glBindVertexArray(vaos[1]);
+        glBindVertexArray(vaos[1].get());
         glPolygonMode(GL_FRONT_AND_BACK, GL_LINE);
         glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
-
-        glfwSwapBuffers(window);
-        glfwPollEvents();
     }
 
     void
     teardown(void) override
     {
-        glDeleteVertexArrays(static_cast<GLsizei>(vaos.size()), vaos.data());
-        glDeleteBuffers(static_cast<GLsizei>(vbos.size()), vbos.data());
-        glDeleteBuffers(static_cast<GLsizei>(ebos.size()), ebos.data());
+        Resource::resetAll(vaos);
+        Resource::resetAll(vbos);
+        Resource::resetAll(ebos);
         horizontal_shader.reset();
         vertical_shader.reset();
     }
 
     std::unique_ptr<Shader> horizontal_shader = nullptr;
     std::unique_ptr<Shader> vertical_shader = nullptr;
-    std::array<GLuint, 2> vaos, vbos, ebos;
+    std::array<Resource::VertexArray, 2> vaos{};
+    std::array<Resource::Buffer, 2> vbos{}, ebos{};
     Utils::ScrollingColour scroller{};
 };
 
+#ifdef SCENE_HOST
+std::unique_ptr<BaseApplication>
+createHelloTriangle(void)
+{
+    return std::make_unique<HelloTriange>();
+}
+#else
 int
-main(int, char **)
+main(int argc, char **argv)
 {
     HelloTriange app{};
-    return app.run();
+    return app.run(argc, argv);
 }
+#endif
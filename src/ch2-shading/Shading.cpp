@@ -1,15 +1,16 @@
 #include "../BaseApplication.hpp"
 
+#include "Resource.hpp"
 #include "Shader.hpp"
 #include "ShadingFiles.hpp"
 #include "Utils.hpp"
 
 #include <memory>
 
-class Texture : public BaseApplication
+class Shading : public BaseApplication
 {
   public:
-    virtual ~Texture() = default;
+    virtual ~Shading() = default;
 
   private:
     void
@@ -23,18 +24,20 @@ class Texture : public BaseApplication
 
         static constexpr std::array<GLuint, 3> indices{0, 1, 2};
 
-        glGenVertexArrays(static_cast<GLsizei>(vaos.size()), vaos.data());
-        glGenBuffers(static_cast<GLsizei>(vbos.size()), vbos.data());
-        glGenBuffers(static_cast<GLsizei>(ebos.size()), ebos.data());
+        Resource::createAll(vaos);
+        Resource::createAll(vbos);
+        Resource::createAll(ebos);
 
-        glBindVertexArray(vaos[0]);
+        glBindVertexArray(vaos[0].get());
 
-        glBindBuffer(GL_ARRAY_BUFFER, vbos[0]);
+        glBindBuffer(GL_ARRAY_BUFFER, vbos[0].get());
         glBufferData(GL_ARRAY_BUFFER, Utils::arrayDataSize(vertices), vertices.data(), GL_STATIC_DRAW);
+        vbos[0].setSize(Utils::arrayDataSize(vertices));
 
         /* Copie the indices into the EBO */
-        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ebos[0]);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ebos[0].get());
         glBufferData(GL_ELEMENT_ARRAY_BUFFER, Utils::arrayDataSize(indices), indices.data(), GL_STATIC_DRAW);
+        ebos[0].setSize(Utils::arrayDataSize(indices));
 
         /* Set vertices position attributes */
         glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(GLfloat), nullptr);
@@ -45,101 +48,125 @@ class Texture : public BaseApplication
         glEnableVertexAttribArray(1);
 
         shader = std::make_unique<Shader>(VERTEX_SHADER_FILE, FRAGMENT_SHADER_FILE);
+
+        damage.addAnimation(Utils::ScrollingColour::UPDATE_RATE);
+
+        input.bind({
+            {QUIT, GLFW_KEY_ESCAPE},
+            {MOVE_LEFT, GLFW_KEY_H},
+            {MOVE_RIGHT, GLFW_KEY_L},
+            {MOVE_DOWN, GLFW_KEY_J},
+            {MOVE_UP, GLFW_KEY_K},
+            {FLIP, GLFW_KEY_SPACE},
+        });
     }
 
+    enum Action : Input::ActionId
+    {
+        QUIT,
+        MOVE_LEFT,
+        MOVE_RIGHT,
+        MOVE_DOWN,
+        MOVE_UP,
+        FLIP
+    };
+
     void
     processInputs(void) override
     {
-        if (glfwGetKey(window, GLFW_KEY_ESCAPE) == GLFW_PRESS) {
+        if (input.isDown(QUIT)) {
             glfwSetWindowShouldClose(window, GLFW_TRUE);
         }
 
         /* Triangle movement */
-        if (glfwGetKey(window, GLFW_KEY_H) == GLFW_PRESS) {
+        if (input.isDown(MOVE_LEFT)) {
             updateHorizontalOffset(-0.02f);
         }
-        if (glfwGetKey(window, GLFW_KEY_L) == GLFW_PRESS) {
+        if (input.isDown(MOVE_RIGHT)) {
             updateHorizontalOffset(0.02f);
         }
-        if (glfwGetKey(window, GLFW_KEY_J) == GLFW_PRESS) {
+        if (input.isDown(MOVE_DOWN)) {
             updateVerticalOffset(-0.02f);
         }
-        if (glfwGetKey(window, GLFW_KEY_K) == GLFW_PRESS) {
+        if (input.isDown(MOVE_UP)) {
             updateVerticalOffset(0.02f);
         }
 
         /* Triangle flip */
-        static bool is_space_released = true;
-        if (glfwGetKey(window, GLFW_KEY_SPACE) == GLFW_PRESS && is_space_released) {
+        if (input.wasPressed(FLIP)) {
             updateFlip();
-            is_space_released = false;
-        }
-        if (glfwGetKey(window, GLFW_KEY_SPACE) == GLFW_RELEASE) {
-            is_space_released = true;
         }
     }
 
     void
     updateHorizontalOffset(GLfloat increment)
     {
-        static GLfloat current_offset = 0.0f;
-        current_offset += increment;
-        current_offset = Utils::clamp(current_offset, -1.0f, 1.0f);
-        shader->setUniform("hOffset", current_offset);
+        horizontal_offset = Utils::clamp(horizontal_offset + increment, -1.0f, 1.0f);
+        shader->setUniform("hOffset", horizontal_offset);
+        damage.markDirty();
     }
 
     void
     updateVerticalOffset(GLfloat increment)
     {
-        static GLfloat current_offset = 0.0f;
-        current_offset += increment;
-        current_offset = Utils::clamp(current_offset, -1.0f, 1.0f);
-        shader->setUniform("vOffset", current_offset);
+        vertical_offset = Utils::clamp(vertical_offset + increment, -1.0f, 1.0f);
+        shader->setUniform("vOffset", vertical_offset);
+        damage.markDirty();
     }
 
     void
     updateFlip(void)
     {
-        static GLint flip = 1;
         flip *= -1;
         shader->setUniform("flip", flip);
+        damage.markDirty();
     }
 
     void
     render(void) override
     {
-        Utils::RGBColour colour = scroller.getNext();
+        Utils::RGBColour colour = scroller.getAt(frame_time);
         glClearColor(colour.r, colour.g, colour.b, 1.0f);
         glClear(GL_COLOR_BUFFER_BIT);
 
         /* Set the shader program and attributes (through vao) */
         shader->useProgram();
-        glBindVertexArray(vaos[0]);
+        glBindVertexArray(vaos[0].get());
 
         /* Bind the element buffer and draw it */
-        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ebos[0]);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ebos[0].get());
         glDrawElements(GL_TRIANGLES, 3, GL_UNSIGNED_INT, NULL);
-
-        /* Keep last */
-        glfwSwapBuffers(window);
     }
 
     void
     teardown(void) override
     {
-        glDeleteVertexArrays(static_cast<GLsizei>(vaos.size()), vaos.data());
-        glDeleteBuffers(static_cast<GLsizei>(vbos.size()), vbos.data());
-        glDeleteBuffers(static_cast<GLsizei>(ebos.size()), ebos.data());
+        Resource::resetAll(vaos);
+        Resource::resetAll(vbos);
+        Resource::resetAll(ebos);
+        shader.reset();
     }
 
     std::unique_ptr<Shader> shader = nullptr;
-    std::array<GLuint, 1> vaos, vbos, ebos;
+    std::array<Resource::VertexArray, 1> vaos{};
+    std::array<Resource::Buffer, 1> vbos{}, ebos{};
     Utils::ScrollingColour scroller{};
+    GLfloat horizontal_offset = 0.0f;
+    GLfloat vertical_offset = 0.0f;
+    GLint flip = 1;
 };
 
+#ifdef SCENE_HOST
+std::unique_ptr<BaseApplication>
+createShading(void)
+{
+    return std::make_unique<Shading>();
+}
+#else
 int
-main(int, char **)
+main(int argc, char **argv)
 {
-    Texture app{};
-    return app.run();
-}
\ No newline at end of file
+    Shading app{};
+    return app.run(argc, argv);
+}
+#endif
\ No newline at end of file
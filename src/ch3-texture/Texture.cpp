@@ -1,5 +1,7 @@
 #include "../BaseApplication.hpp"
 
+#include "Loader.hpp"
+#include "Resource.hpp"
 #include "Shader.hpp"
 #include "TextureFiles.hpp"
 #include "Utils.hpp"
@@ -27,39 +29,24 @@ class Texture : public BaseApplication
             1, 2, 3, /* Second triangle */
         };
 
-        Utils::Image yanfei{YANFEI_FILE};
-        Utils::Image hutao{HUTAO_FILE};
-
-        const Utils::ImageData &yanfei_data = yanfei.getImageData();
-        const Utils::ImageData &hutao_data = hutao.getImageData();
-
-        glGenTextures(static_cast<GLsizei>(textures.size()), textures.data());
-
-        glActiveTexture(GL_TEXTURE0);
-        glBindTexture(GL_TEXTURE_2D, textures[0]);
-        if (nullptr != yanfei_data.pixels) {
-            glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, yanfei_data.width, yanfei_data.height, 0, GL_RGB, GL_UNSIGNED_BYTE, yanfei_data.pixels);
-            glGenerateMipmap(GL_TEXTURE_2D);
+        /* Decoded and uploaded in the background, the quad is drawn untextured until then */
+        for (std::size_t i = 0; i < TEXTURE_FILES.size(); ++i) {
+            pending_textures[i] = Loader::loadTexture(*loader, TEXTURE_FILES[i]);
         }
 
-        glActiveTexture(GL_TEXTURE1);
-        glBindTexture(GL_TEXTURE_2D, textures[1]);
-        if (nullptr != hutao_data.pixels) {
-            glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, hutao_data.width, hutao_data.height, 0, GL_RGB, GL_UNSIGNED_BYTE, hutao_data.pixels);
-            glGenerateMipmap(GL_TEXTURE_2D);
-        }
+        Resource::createAll(vaos);
+        Resource::createAll(vbos);
+        Resource::createAll(ebos);
 
-        glGenVertexArrays(static_cast<GLsizei>(vaos.size()), vaos.data());
-        glGenBuffers(static_cast<GLsizei>(vbos.size()), vbos.data());
-        glGenBuffers(static_cast<GLsizei>(ebos.size()), ebos.data());
+        glBindVertexArray(vaos[0].get());
 
-        glBindVertexArray(vaos[0]);
-
-        glBindBuffer(GL_ARRAY_BUFFER, vbos[0]);
+        glBindBuffer(GL_ARRAY_BUFFER, vbos[0].get());
         glBufferData(GL_ARRAY_BUFFER, Utils::arrayDataSize(vertices), vertices.data(), GL_STATIC_DRAW);
+        vbos[0].setSize(Utils::arrayDataSize(vertices));
 
-        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ebos[0]);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ebos[0].get());
         glBufferData(GL_ELEMENT_ARRAY_BUFFER, Utils::arrayDataSize(indices), indices.data(), GL_STATIC_DRAW);
+        ebos[0].setSize(Utils::arrayDataSize(indices));
 
         glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 5 * sizeof(GLfloat), nullptr);
         glEnableVertexAttribArray(0);
@@ -71,46 +58,66 @@ class Texture : public BaseApplication
         shader->useProgram();
         shader->setUniform("texture0", 0);
         shader->setUniform("texture1", 1);
+
+        damage.addAnimation(Utils::ScrollingColour::UPDATE_RATE);
+
+        input.bind({
+            {QUIT, GLFW_KEY_ESCAPE},
+            {MOVE_LEFT, GLFW_KEY_H},
+            {MOVE_RIGHT, GLFW_KEY_L},
+            {MOVE_DOWN, GLFW_KEY_J},
+            {MOVE_UP, GLFW_KEY_K},
+            {FLIP, GLFW_KEY_SPACE},
+            {MIX_UP, GLFW_KEY_UP},
+            {MIX_DOWN, GLFW_KEY_DOWN},
+        });
     }
 
+    enum Action : Input::ActionId
+    {
+        QUIT,
+        MOVE_LEFT,
+        MOVE_RIGHT,
+        MOVE_DOWN,
+        MOVE_UP,
+        FLIP,
+        MIX_UP,
+        MIX_DOWN
+    };
+
     void
     processInputs(void) override
     {
-        if (glfwGetKey(window, GLFW_KEY_ESCAPE) == GLFW_PRESS) {
+        if (input.isDown(QUIT)) {
             glfwSetWindowShouldClose(window, GLFW_TRUE);
         }
 
         /* Triangle movement */
-        if (glfwGetKey(window, GLFW_KEY_H) == GLFW_PRESS) {
+        if (input.isDown(MOVE_LEFT)) {
             updateHorizontalOffset(-0.02f);
             shader->setUniform("direction", -1);
         }
-        if (glfwGetKey(window, GLFW_KEY_L) == GLFW_PRESS) {
+        if (input.isDown(MOVE_RIGHT)) {
             updateHorizontalOffset(0.02f);
             shader->setUniform("direction", 1);
         }
-        if (glfwGetKey(window, GLFW_KEY_J) == GLFW_PRESS) {
+        if (input.isDown(MOVE_DOWN)) {
             updateVerticalOffset(-0.02f);
         }
-        if (glfwGetKey(window, GLFW_KEY_K) == GLFW_PRESS) {
+        if (input.isDown(MOVE_UP)) {
             updateVerticalOffset(0.02f);
         }
 
         /* Horizontal flip */
-        static bool is_space_released = true;
-        if (glfwGetKey(window, GLFW_KEY_SPACE) == GLFW_PRESS && is_space_released) {
+        if (input.wasPressed(FLIP)) {
             updateHorizontalFlip();
-            is_space_released = false;
-        }
-        if (glfwGetKey(window, GLFW_KEY_SPACE) == GLFW_RELEASE) {
-            is_space_released = true;
         }
 
         /* Set texture mixing */
-        if (glfwGetKey(window, GLFW_KEY_UP) == GLFW_PRESS) {
+        if (input.isDown(MIX_UP)) {
             updateTextureMix(0.02f);
         }
-        if (glfwGetKey(window, GLFW_KEY_DOWN) == GLFW_PRESS) {
+        if (input.isDown(MIX_DOWN)) {
             updateTextureMix(-0.02f);
         }
     }
@@ -118,78 +125,100 @@ class Texture : public BaseApplication
     void
     updateHorizontalOffset(GLfloat increment)
     {
-        static GLfloat current_offset = 0.0f;
-        current_offset += increment;
-        current_offset = Utils::clamp(current_offset, -1.0f, 1.0f);
-        shader->setUniform("hOffset", current_offset);
+        horizontal_offset = Utils::clamp(horizontal_offset + increment, -1.0f, 1.0f);
+        shader->setUniform("hOffset", horizontal_offset);
+        damage.markDirty();
     }
 
     void
     updateVerticalOffset(GLfloat increment)
     {
-        static GLfloat current_offset = 0.0f;
-        current_offset += increment;
-        current_offset = Utils::clamp(current_offset, -1.0f, 1.0f);
-        shader->setUniform("vOffset", current_offset);
+        vertical_offset = Utils::clamp(vertical_offset + increment, -1.0f, 1.0f);
+        shader->setUniform("vOffset", vertical_offset);
+        damage.markDirty();
     }
 
     void
     updateHorizontalFlip(void)
     {
-        static GLint flip = 1;
         flip *= -1;
         shader->setUniform("flip", flip);
+        damage.markDirty();
     }
 
     void
     updateTextureMix(GLfloat increment)
     {
-        static GLfloat mixer = 0.5f;
-        mixer += increment;
-        mixer = Utils::clamp(mixer, 0.0f, 1.0f);
+        mixer = Utils::clamp(mixer + increment, 0.0f, 1.0f);
         shader->setUniform("mixer", mixer);
+        damage.markDirty();
     }
 
     void
     render(void) override
     {
-        Utils::RGBColour colour = scroller.getNext();
+        Utils::RGBColour colour = scroller.getAt(frame_time);
         glClearColor(colour.r, colour.g, colour.b, 1.0f);
         glClear(GL_COLOR_BUFFER_BIT);
+        for (std::size_t i = 0; i < textures.size(); ++i) {
+            /* A texture mixed out entirely is not used, it may be evicted and is loaded again once mixed back in */
+            if ((0 == i && mixer >= 1.0f) || (1 == i && mixer <= 0.0f)) {
+                continue;
+            }
+            if (!Loader::refreshTexture(*loader, pending_textures[i], textures[i], TEXTURE_FILES[i])) {
+                /* Keep polling until the texture arrives, again if it got evicted */
+                damage.markDirty();
+            }
+        }
 
         /* Set the shader program and attributes (through vao) */
         shader->useProgram();
         glActiveTexture(GL_TEXTURE0);
-        glBindTexture(GL_TEXTURE_2D, textures[0]);
+        glBindTexture(GL_TEXTURE_2D, textures[0].get());
         glActiveTexture(GL_TEXTURE1);
-        glBindTexture(GL_TEXTURE_2D, textures[1]);
-        glBindVertexArray(vaos[0]);
+        glBindTexture(GL_TEXTURE_2D, textures[1].get());
+        glBindVertexArray(vaos[0].get());
 
         /* Bind the element buffer and draw it */
-        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ebos[0]);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ebos[0].get());
         glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, NULL);
-
-        /* Keep last */
-        glfwSwapBuffers(window);
     }
 
     void
     teardown(void) override
     {
-        glDeleteVertexArrays(static_cast<GLsizei>(vaos.size()), vaos.data());
-        glDeleteBuffers(static_cast<GLsizei>(vbos.size()), vbos.data());
-        glDeleteBuffers(static_cast<GLsizei>(ebos.size()), ebos.data());
+        Resource::resetAll(vaos);
+        Resource::resetAll(vbos);
+        Resource::resetAll(ebos);
+        Loader::resetAll(pending_textures);
+        Resource::resetAll(textures);
+        shader.reset();
     }
 
     std::unique_ptr<Shader> shader = nullptr;
-    std::array<GLuint, 1> vaos, vbos, ebos;
-    std::array<GLuint, 2> textures;
+    std::array<Resource::VertexArray, 1> vaos{};
+    std::array<Resource::Buffer, 1> vbos{}, ebos{};
+    std::array<Resource::Texture, 2> textures{};
+    static constexpr std::array<const char *, 2> TEXTURE_FILES{YANFEI_FILE, HUTAO_FILE};
+    std::array<Loader::Pending<Resource::Texture>, 2> pending_textures{};
     Utils::ScrollingColour scroller{};
+    GLfloat horizontal_offset = 0.0f;
+    GLfloat vertical_offset = 0.0f;
+    GLint flip = 1;
+    GLfloat mixer = 0.5f;
 };
 
+#ifdef SCENE_HOST
+std::unique_ptr<BaseApplication>
+createTexture(void)
+{
+    return std::make_unique<Texture>();
+}
+#else
 int
-main(int, char **)
+main(int argc, char **argv)
 {
     Texture app{};
-    return app.run();
+    return app.run(argc, argv);
 }
+#endif
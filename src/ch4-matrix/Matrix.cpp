@@ -1,13 +1,56 @@
 #include "../BaseApplication.hpp"
 
+#include "Animation.hpp"
+#include "Culling.hpp"
+#include "Ecs.hpp"
+#include "Loader.hpp"
 #include "MatrixFiles.hpp"
+#include "Resource.hpp"
 #include "Shader.hpp"
 #include "Utils.hpp"
 
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 
+#include <cmath>
 #include <memory>
+#include <numbers>
+#include <vector>
+
+/* Scene components */
+struct Transform
+{
+    glm::vec3 translation;
+    GLfloat angle;
+    glm::vec3 scale;
+};
+
+struct WorldMatrix
+{
+    glm::mat4 matrix;
+};
+
+struct TextureFlip
+{
+    glm::vec2 flips;
+};
+
+/* Offsets accumulated from the keyboard, the translation only keeps their clamped value */
+struct PlayerControl
+{
+    glm::vec2 offsets;
+};
+
+/* Scale follows the sine of the time */
+struct Pulse
+{
+    GLfloat amplitude;
+};
+
+struct CullingProxy
+{
+    Culling::ObjectId object;
+};
 
 class Matrix : public BaseApplication
 {
@@ -30,39 +73,24 @@ class Matrix : public BaseApplication
             1, 2, 3, /* Second triangle */
         };
 
-        Utils::Image yanfei{YANFEI_FILE};
-        Utils::Image hutao{HUTAO_FILE};
-
-        const Utils::ImageData &yanfei_data = yanfei.getImageData();
-        const Utils::ImageData &hutao_data = hutao.getImageData();
-
-        glGenTextures(static_cast<GLsizei>(textures.size()), textures.data());
-
-        glActiveTexture(GL_TEXTURE0);
-        glBindTexture(GL_TEXTURE_2D, textures[0]);
-        if (nullptr != yanfei_data.pixels) {
-            glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, yanfei_data.width, yanfei_data.height, 0, GL_RGB, GL_UNSIGNED_BYTE, yanfei_data.pixels);
-            glGenerateMipmap(GL_TEXTURE_2D);
-        }
-
-        glActiveTexture(GL_TEXTURE1);
-        glBindTexture(GL_TEXTURE_2D, textures[1]);
-        if (nullptr != hutao_data.pixels) {
-            glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, hutao_data.width, hutao_data.height, 0, GL_RGB, GL_UNSIGNED_BYTE, hutao_data.pixels);
-            glGenerateMipmap(GL_TEXTURE_2D);
+        /* Decoded and uploaded in the background, the quad is drawn untextured until then */
+        for (std::size_t i = 0; i < TEXTURE_FILES.size(); ++i) {
+            pending_textures[i] = Loader::loadTexture(*loader, TEXTURE_FILES[i]);
         }
 
-        glGenVertexArrays(static_cast<GLsizei>(vaos.size()), vaos.data());
-        glGenBuffers(static_cast<GLsizei>(vbos.size()), vbos.data());
-        glGenBuffers(static_cast<GLsizei>(ebos.size()), ebos.data());
+        Resource::createAll(vaos);
+        Resource::createAll(vbos);
+        Resource::createAll(ebos);
 
-        glBindVertexArray(vaos[0]);
+        glBindVertexArray(vaos[0].get());
 
-        glBindBuffer(GL_ARRAY_BUFFER, vbos[0]);
+        glBindBuffer(GL_ARRAY_BUFFER, vbos[0].get());
         glBufferData(GL_ARRAY_BUFFER, Utils::arrayDataSize(vertices), vertices.data(), GL_STATIC_DRAW);
+        vbos[0].setSize(Utils::arrayDataSize(vertices));
 
-        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ebos[0]);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ebos[0].get());
         glBufferData(GL_ELEMENT_ARRAY_BUFFER, Utils::arrayDataSize(indices), indices.data(), GL_STATIC_DRAW);
+        ebos[0].setSize(Utils::arrayDataSize(indices));
 
         glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 5 * sizeof(GLfloat), nullptr);
         glEnableVertexAttribArray(0);
@@ -74,60 +102,151 @@ class Matrix : public BaseApplication
         shader->useProgram();
         shader->setUniform("texture0", 0);
         shader->setUniform("texture1", 1);
+
+        /* Both boxes start as the untransformed quad, the culling system refits them every frame */
+        world.create(Transform{glm::vec3(0.0f), 0.0f, glm::vec3(1.0f, 1.0f, 1.0f)}, WorldMatrix{}, TextureFlip{glm::vec2(1.0f)}, PlayerControl{glm::vec2(0.0f)}, CullingProxy{0});
+        world.create(Transform{glm::vec3(-0.5f, 0.5f, 0.0f), 0.0f, glm::vec3(1.0f)}, WorldMatrix{}, TextureFlip{glm::vec2(1.0f)}, Pulse{1.0f}, CullingProxy{1});
+        bvh.build({QUAD_BOUNDS, QUAD_BOUNDS});
+        draw_items.resize(bvh.getObjectCount());
+
+        setupSystems();
+        setupAnimations();
+
+        /* The background scroll and the pulse keep changing the picture when no key is held */
+        damage.addAnimation(BACKGROUND_UPDATE_RATE);
+        damage.addAnimation(PULSE_UPDATE_RATE);
+
+        input.bind({
+            {QUIT, GLFW_KEY_ESCAPE},
+            {MOVE_LEFT, GLFW_KEY_H},
+            {MOVE_RIGHT, GLFW_KEY_L},
+            {MOVE_DOWN, GLFW_KEY_J},
+            {MOVE_UP, GLFW_KEY_K},
+            {FLIP, GLFW_KEY_SPACE},
+            {MIX_UP, GLFW_KEY_UP},
+            {MIX_DOWN, GLFW_KEY_DOWN},
+            {SCALE_UP, GLFW_KEY_EQUAL},
+            {SCALE_DOWN, GLFW_KEY_MINUS},
+            {ROTATE_LEFT, GLFW_KEY_LEFT},
+            {ROTATE_RIGHT, GLFW_KEY_RIGHT},
+        });
+    }
+
+    enum Action : Input::ActionId
+    {
+        QUIT,
+        MOVE_LEFT,
+        MOVE_RIGHT,
+        MOVE_DOWN,
+        MOVE_UP,
+        FLIP,
+        MIX_UP,
+        MIX_DOWN,
+        SCALE_UP,
+        SCALE_DOWN,
+        ROTATE_LEFT,
+        ROTATE_RIGHT
+    };
+
+    /* The background scrolls from red to green to blue, the pulse follows the sine of the time */
+    void
+    setupAnimations(void)
+    {
+        static constexpr std::array<float, 4> BACKGROUND_TIMES{0.0f, 1.0f / 3.0f, 2.0f / 3.0f, 1.0f};
+        static constexpr std::array<float, 16> BACKGROUND_COLOURS{
+            1.0f, 0.0f, 0.0f, 1.0f, /* Red */
+            0.0f, 1.0f, 0.0f, 1.0f, /* Green */
+            0.0f, 0.0f, 1.0f, 1.0f, /* Blue */
+            1.0f, 0.0f, 0.0f, 1.0f, /* Red */
+        };
+        background_track = colours.add({frame_time, 5.0, Animation::Playback::LOOP}, BACKGROUND_TIMES, BACKGROUND_COLOURS);
+
+        /* One period sampled finely enough to stay within 0.005 of the sine, the extrema and zeros are keys */
+        std::array<float, PULSE_KEY_COUNT> pulse_times{}, pulse_values{};
+        for (std::size_t key = 0; key < PULSE_KEY_COUNT; ++key) {
+            pulse_times[key] = static_cast<float>(key) / static_cast<float>(PULSE_KEY_COUNT - 1);
+            pulse_values[key] = static_cast<float>(std::sin(2.0 * std::numbers::pi * static_cast<double>(pulse_times[key])));
+        }
+        pulse_track = scalars.add({0.0, 2.0 * std::numbers::pi, Animation::Playback::LOOP}, pulse_times, pulse_values);
+    }
+
+    void
+    setupSystems(void)
+    {
+        schedule.addSystem("pulse", Ecs::componentMask<Pulse>(), Ecs::componentMask<Transform>(), [this](Ecs::World &scene) {
+            scene.each<Pulse, Transform>([this](const Pulse &pulse, Transform &transform) {
+                transform.scale = glm::vec3(pulse.amplitude * pulse_value);
+            });
+        });
+
+        schedule.addSystem("transform", Ecs::componentMask<Transform>(), Ecs::componentMask<WorldMatrix>(), [](Ecs::World &scene) {
+            static constexpr glm::vec3 rotation_axis(0.0f, 0.0f, 1.0f);
+            scene.parallelEach<Transform, WorldMatrix>([](const Transform &transform, WorldMatrix &world_matrix) {
+                glm::mat4 transformation = glm::mat4(1.0f);
+                /* Scale -> Rotate -> Translate is the recommended order of operation, but order of operation is reverse! */
+                transformation = glm::translate(transformation, transform.translation);
+                transformation = glm::rotate(transformation, glm::radians(transform.angle), rotation_axis);
+                transformation = glm::scale(transformation, transform.scale);
+                world_matrix.matrix = transformation;
+            });
+        });
+
+        /* Only keep the boxes whose transformation leaves them on screen */
+        schedule.addSystem("culling", Ecs::componentMask<WorldMatrix, TextureFlip, CullingProxy>(), 0, [this](Ecs::World &scene) {
+            scene.each<WorldMatrix, TextureFlip, CullingProxy>([this](const WorldMatrix &world_matrix, const TextureFlip &flip, const CullingProxy &proxy) {
+                bvh.update(proxy.object, QUAD_BOUNDS.transformed(world_matrix.matrix));
+                draw_items[proxy.object] = {world_matrix.matrix, flip.flips};
+            });
+        });
     }
 
     void
     processInputs(void) override
     {
-        if (glfwGetKey(window, GLFW_KEY_ESCAPE) == GLFW_PRESS) {
+        if (input.isDown(QUIT)) {
             glfwSetWindowShouldClose(window, GLFW_TRUE);
         }
 
         /* Translation vector */
-        if (glfwGetKey(window, GLFW_KEY_H) == GLFW_PRESS) {
+        if (input.isDown(MOVE_LEFT)) {
             updateHorizontalOffset(-0.02f);
-            flips.x = -1.0f;
+            updateTextureFlip([](glm::vec2 &flips) { flips.x = -1.0f; });
         }
-        if (glfwGetKey(window, GLFW_KEY_L) == GLFW_PRESS) {
+        if (input.isDown(MOVE_RIGHT)) {
             updateHorizontalOffset(0.02f);
-            flips.x = 1.0f;
+            updateTextureFlip([](glm::vec2 &flips) { flips.x = 1.0f; });
         }
-        if (glfwGetKey(window, GLFW_KEY_J) == GLFW_PRESS) {
+        if (input.isDown(MOVE_DOWN)) {
             updateVerticalOffset(-0.02f);
         }
-        if (glfwGetKey(window, GLFW_KEY_K) == GLFW_PRESS) {
+        if (input.isDown(MOVE_UP)) {
             updateVerticalOffset(0.02f);
         }
 
         /* Horizontal flip */
-        static bool is_space_released = true;
-        if (glfwGetKey(window, GLFW_KEY_SPACE) == GLFW_PRESS && is_space_released) {
-            flips.y *= -1.0f;
-            is_space_released = false;
-        }
-        if (glfwGetKey(window, GLFW_KEY_SPACE) == GLFW_RELEASE) {
-            is_space_released = true;
+        if (input.wasPressed(FLIP)) {
+            updateTextureFlip([](glm::vec2 &flips) { flips.y *= -1.0f; });
         }
 
         /* Set texture mixing */
-        if (glfwGetKey(window, GLFW_KEY_UP) == GLFW_PRESS) {
+        if (input.isDown(MIX_UP)) {
             updateTextureMix(0.02f);
         }
-        if (glfwGetKey(window, GLFW_KEY_DOWN) == GLFW_PRESS) {
+        if (input.isDown(MIX_DOWN)) {
             updateTextureMix(-0.02f);
         }
 
         /* Transformation matrix */
-        if (glfwGetKey(window, GLFW_KEY_EQUAL) == GLFW_PRESS) {
+        if (input.isDown(SCALE_UP)) {
             updateMatrixScale(0.02f);
         }
-        if (glfwGetKey(window, GLFW_KEY_MINUS) == GLFW_PRESS) {
+        if (input.isDown(SCALE_DOWN)) {
             updateMatrixScale(-0.02f);
         }
-        if (glfwGetKey(window, GLFW_KEY_LEFT) == GLFW_PRESS) {
+        if (input.isDown(ROTATE_LEFT)) {
             updateMatrixRotation(2.0f);
         }
-        if (glfwGetKey(window, GLFW_KEY_RIGHT) == GLFW_PRESS) {
+        if (input.isDown(ROTATE_RIGHT)) {
             updateMatrixRotation(-2.0f);
         }
     }
@@ -135,117 +254,152 @@ class Matrix : public BaseApplication
     void
     updateHorizontalOffset(GLfloat increment)
     {
-        static GLfloat current_offset = 0.0f;
-        current_offset += increment;
-        translation.x = Utils::clamp(current_offset, -1.0f, 1.0f);
+        world.each<PlayerControl, Transform>([increment](PlayerControl &control, Transform &transform) {
+            control.offsets.x += increment;
+            transform.translation.x = Utils::clamp(control.offsets.x, -1.0f, 1.0f);
+        });
+        damage.markDirty();
     }
 
     void
     updateVerticalOffset(GLfloat increment)
     {
-        static GLfloat current_offset = 0.0f;
-        current_offset += increment;
-        translation.y = Utils::clamp(current_offset, -1.0f, 1.0f);
+        world.each<PlayerControl, Transform>([increment](PlayerControl &control, Transform &transform) {
+            control.offsets.y += increment;
+            transform.translation.y = Utils::clamp(control.offsets.y, -1.0f, 1.0f);
+        });
+        damage.markDirty();
+    }
+
+    template <class Function>
+    void
+    updateTextureFlip(Function &&function)
+    {
+        world.each<TextureFlip>([&function](TextureFlip &flip) { function(flip.flips); });
+        damage.markDirty();
     }
 
     void
     updateTextureMix(GLfloat increment)
     {
-        static GLfloat mixer = 0.5f;
         mixer += increment;
         mixer = Utils::clamp(mixer, 0.0f, 1.0f);
         shader->setUniform("mixer", mixer);
+        damage.markDirty();
     }
 
     void
     updateMatrixScale(GLfloat increment)
     {
-        scale += increment;
+        world.each<PlayerControl, Transform>([increment](PlayerControl &, Transform &transform) {
+            transform.scale.x += increment;
+            transform.scale.y += increment;
+        });
+        damage.markDirty();
     }
 
     void
     updateMatrixRotation(GLfloat increment)
     {
-        angle += increment;
+        world.each<PlayerControl, Transform>([increment](PlayerControl &, Transform &transform) {
+            transform.angle += increment;
+        });
+        damage.markDirty();
     }
 
     void
     render(void) override
     {
-        Utils::RGBColour colour = scroller.getNext();
-        glClearColor(colour.r, colour.g, colour.b, 1.0f);
+        colours.evaluate(frame_time);
+        scalars.evaluate(frame_time);
+        const float *colour = colours.getValue(background_track);
+        glClearColor(colour[0], colour[1], colour[2], colour[3]);
         glClear(GL_COLOR_BUFFER_BIT);
+        for (std::size_t i = 0; i < textures.size(); ++i) {
+            if (!Loader::refreshTexture(*loader, pending_textures[i], textures[i], TEXTURE_FILES[i])) {
+                /* Keep polling until the texture arrives, again if it got evicted */
+                damage.markDirty();
+            }
+        }
+
+        /* Run the scene systems, the culling one leaves the draw items and bounds up to date */
+        pulse_value = *scalars.getValue(pulse_track);
+        schedule.run(world);
+        visible_boxes.clear();
+        bvh.cull(Culling::Frustum{glm::mat4(1.0f)}, visible_boxes);
 
         /* Set the shader program and attributes (through vao) */
         shader->useProgram();
-        updateTransformation();
-        updateTextureFlip();
         glActiveTexture(GL_TEXTURE0);
-        glBindTexture(GL_TEXTURE_2D, textures[0]);
+        glBindTexture(GL_TEXTURE_2D, textures[0].get());
         glActiveTexture(GL_TEXTURE1);
-        glBindTexture(GL_TEXTURE_2D, textures[1]);
-        glBindVertexArray(vaos[0]);
-
-        /* Bind the element buffer and draw it */
-        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ebos[0]);
-        glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, NULL);
-
-        drawSecondBox();
-
-        /* Keep last */
-        glfwSwapBuffers(window);
-    }
-
-    void
-    updateTransformation(void)
-    {
-        static constexpr glm::vec3 rotation_axis(0.0f, 0.0f, 1.0f);
-        glm::mat4 transformation = glm::mat4(1.0f);
-        /* Scale -> Rotate -> Translate is the recommended order of operation, but order of operation is reverse! */
-        transformation = glm::translate(transformation, translation);
-        transformation = glm::rotate(transformation, glm::radians(angle), rotation_axis);
-        transformation = glm::scale(transformation, glm::vec3(scale, scale, 1.0f));
-        shader->setUniform("transform", transformation);
-    }
-
-    void
-    updateTextureFlip(void)
-    {
-        shader->setUniform("flips", flips);
-    }
-
-    void
-    drawSecondBox(void)
-    {
-        GLfloat time = static_cast<GLfloat>(std::sin(glfwGetTime()));
-        glm::mat4 transformation = glm::mat4(1.0f);
-        transformation = glm::translate(transformation, glm::vec3(-0.5f, 0.5f, 0.0f));
-        transformation = glm::scale(transformation, glm::vec3(time));
-        shader->setUniform("transform", transformation);
-        glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, NULL);
+        glBindTexture(GL_TEXTURE_2D, textures[1].get());
+        glBindVertexArray(vaos[0].get());
+
+        /* Bind the element buffer and draw the visible boxes */
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ebos[0].get());
+        for (Culling::ObjectId box : visible_boxes) {
+            shader->setUniform("transform", draw_items[box].transformation);
+            shader->setUniform("flips", draw_items[box].flips);
+            glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, NULL);
+        }
     }
 
     void
     teardown(void) override
     {
-        glDeleteVertexArrays(static_cast<GLsizei>(vaos.size()), vaos.data());
-        glDeleteBuffers(static_cast<GLsizei>(vbos.size()), vbos.data());
-        glDeleteBuffers(static_cast<GLsizei>(ebos.size()), ebos.data());
+        Resource::resetAll(vaos);
+        Resource::resetAll(vbos);
+        Resource::resetAll(ebos);
+        Loader::resetAll(pending_textures);
+        Resource::resetAll(textures);
+        shader.reset();
     }
 
+    /* Redraws per second for the background scroll and the pulse to look smooth */
+    static constexpr double BACKGROUND_UPDATE_RATE{20.0};
+    static constexpr double PULSE_UPDATE_RATE{30.0};
+    static constexpr std::size_t PULSE_KEY_COUNT{33};
+    /* Bounds of the quad described by the vertices in setup() */
+    static constexpr Culling::BoundingBox QUAD_BOUNDS{{-0.5f, -0.5f, 0.0f}, {0.5f, 0.5f, 0.0f}};
+
     std::unique_ptr<Shader> shader = nullptr;
-    std::array<GLuint, 1> vaos, vbos, ebos;
-    std::array<GLuint, 2> textures;
-    Utils::ScrollingColour scroller{};
-    glm::vec3 translation{0.0f};
-    glm::vec2 flips{1.0f};
-    GLfloat scale = 1.0f;
-    GLfloat angle = 0.0f;
+    std::array<Resource::VertexArray, 1> vaos{};
+    std::array<Resource::Buffer, 1> vbos{}, ebos{};
+    std::array<Resource::Texture, 2> textures{};
+    static constexpr std::array<const char *, 2> TEXTURE_FILES{YANFEI_FILE, HUTAO_FILE};
+    std::array<Loader::Pending<Resource::Texture>, 2> pending_textures{};
+    Animation::TrackGroup colours{Animation::TrackKind::COLOUR};
+    Animation::TrackGroup scalars{Animation::TrackKind::SCALAR};
+    Animation::TrackId background_track = 0;
+    Animation::TrackId pulse_track = 0;
+    GLfloat mixer = 0.5f;
+    GLfloat pulse_value = 0.0f;
+
+    struct DrawItem
+    {
+        glm::mat4 transformation;
+        glm::vec2 flips;
+    };
+
+    Ecs::World world{};
+    Ecs::Schedule schedule{};
+    Culling::BoundingVolumeHierarchy bvh{};
+    std::vector<DrawItem> draw_items{};
+    std::vector<Culling::ObjectId> visible_boxes{};
 };
 
+#ifdef SCENE_HOST
+std::unique_ptr<BaseApplication>
+createMatrix(void)
+{
+    return std::make_unique<Matrix>();
+}
+#else
 int
-main(int, char **)
+main(int argc, char **argv)
 {
     Matrix app{};
-    return app.run();
+    return app.run(argc, argv);
 }
+#endif
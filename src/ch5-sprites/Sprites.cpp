@@ -0,0 +1,150 @@
+#include "../BaseApplication.hpp"
+
+#include "Loader.hpp"
+#include "Resource.hpp"
+#include "Shader.hpp"
+#include "SpriteBatch.hpp"
+#include "SpritesFiles.hpp"
+#include "Utils.hpp"
+
+#include <glm/glm.hpp>
+
+#include <cmath>
+#include <memory>
+#include <random>
+#include <vector>
+
+class Sprites : public BaseApplication
+{
+  public:
+    virtual ~Sprites() = default;
+
+  private:
+    void
+    setup(void) override
+    {
+        for (std::size_t i = 0; i < TEXTURE_FILES.size(); ++i) {
+            pending_textures[i] = Loader::loadTexture(*loader, TEXTURE_FILES[i]);
+        }
+
+        shader = std::make_unique<Shader>(VERTEX_SHADER_FILE, FRAGMENT_SHADER_FILE);
+        shader->useProgram();
+        shader->setUniform("texture0", 0);
+
+        const auto sprite_count = options.getNumber<std::size_t>("sprites", 100000);
+        batch = std::make_unique<SpriteBatch>();
+
+        /* Alternate the textures so that only sorting can merge the sprites into two draws */
+        std::mt19937 generator{42};
+        std::uniform_real_distribution<GLfloat> unit(0.0f, 1.0f);
+        particles.reserve(sprite_count);
+        for (std::size_t i = 0; i < sprite_count; ++i) {
+            particles.push_back({glm::vec2(unit(generator) * 2.0f - 1.0f, unit(generator) * 2.0f - 1.0f), unit(generator) * 6.2831853f,
+                                 0.5f + unit(generator), 0.01f + 0.04f * unit(generator), glm::vec4(unit(generator), unit(generator), unit(generator), 1.0f),
+                                 i % 2});
+        }
+
+        /* Every sprite moves every frame */
+        damage.addAnimation(0.0);
+
+        input.bind({
+            {QUIT, GLFW_KEY_ESCAPE},
+            {TOGGLE_SORT, GLFW_KEY_SPACE},
+        });
+    }
+
+    enum Action : Input::ActionId
+    {
+        QUIT,
+        TOGGLE_SORT
+    };
+
+    void
+    processInputs(void) override
+    {
+        if (input.isDown(QUIT)) {
+            glfwSetWindowShouldClose(window, GLFW_TRUE);
+        }
+
+        if (input.wasPressed(TOGGLE_SORT)) {
+            sort_mode = SpriteBatch::SortMode::STATE == sort_mode ? SpriteBatch::SortMode::SUBMISSION : SpriteBatch::SortMode::STATE;
+        }
+    }
+
+    void
+    render(void) override
+    {
+        glClearColor(0.1f, 0.1f, 0.1f, 1.0f);
+        glClear(GL_COLOR_BUFFER_BIT);
+        for (std::size_t i = 0; i < textures.size(); ++i) {
+            if (!Loader::refreshTexture(*loader, pending_textures[i], textures[i], TEXTURE_FILES[i])) {
+                /* Keep polling until the texture arrives, again if it got evicted */
+                damage.markDirty();
+            }
+        }
+
+        const auto time = static_cast<GLfloat>(frame_time);
+
+        batch->begin(sort_mode);
+        for (const Particle &particle : particles) {
+            /* Each sprite circles its anchor while spinning */
+            const GLfloat angle = particle.phase + time * particle.speed;
+            const GLfloat cosine = std::cos(angle) * particle.size;
+            const GLfloat sine = std::sin(angle) * particle.size;
+            glm::mat4 transformation{1.0f};
+            transformation[0] = glm::vec4(cosine, sine, 0.0f, 0.0f);
+            transformation[1] = glm::vec4(-sine, cosine, 0.0f, 0.0f);
+            const glm::vec2 position = particle.anchor + 0.05f * glm::vec2(std::cos(angle), std::sin(angle));
+            transformation[3] = glm::vec4(position.x, position.y, 0.0f, 1.0f);
+            batch->draw({shader.get(), textures[particle.texture].get()}, transformation, {{0.0f, 0.0f}, {1.0f, 1.0f}}, particle.tint);
+        }
+        batch->end();
+
+        if (0 == frame_count % 120) {
+            const SpriteBatchStats &stats = batch->getStats();
+            fmt::print("Sprites: {} sprites, {} batches, {} flushes\n", stats.sprites, stats.batches, stats.flushes);
+        }
+    }
+
+    void
+    teardown(void) override
+    {
+        batch.reset();
+        Loader::resetAll(pending_textures);
+        Resource::resetAll(textures);
+        shader.reset();
+    }
+
+    struct Particle
+    {
+        glm::vec2 anchor;
+        GLfloat phase;
+        GLfloat speed;
+        GLfloat size;
+        glm::vec4 tint;
+        std::size_t texture;
+    };
+
+    std::unique_ptr<Shader> shader = nullptr;
+    std::unique_ptr<SpriteBatch> batch = nullptr;
+    std::array<Resource::Texture, 2> textures{};
+    static constexpr std::array<const char *, 2> TEXTURE_FILES{YANFEI_FILE, HUTAO_FILE};
+    std::array<Loader::Pending<Resource::Texture>, 2> pending_textures{};
+    std::vector<Particle> particles{};
+    SpriteBatch::SortMode sort_mode = SpriteBatch::SortMode::STATE;
+};
+
+#ifdef SCENE_HOST
+std::unique_ptr<BaseApplication>
+createSprites(void)
+{
+    return std::make_unique<Sprites>();
+}
+#else
+int
+main(int argc, char **argv)
+{
+    Sprites app{};
+    return app.run(argc, argv);
+}
+#endif
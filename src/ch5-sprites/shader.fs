@@ -0,0 +1,13 @@
+#version 330 core
+in vec2 TexCoords;
+in vec4 Tint;
+
+out vec4 FragColour;
+
+uniform sampler2D texture0;
+
+void
+main()
+{
+    FragColour = texture(texture0, TexCoords) * Tint;
+}
@@ -0,0 +1,700 @@
+#include "../BaseApplication.hpp"
+
+#include "Culling.hpp"
+#include "Resource.hpp"
+#include "Shader.hpp"
+#include "SpriteBatch.hpp"
+#include "StressFiles.hpp"
+#include "TextureUpload.hpp"
+#include "Utils.hpp"
+
+#include <fmt/core.h>
+#include <glm/glm.hpp>
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <random>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/*
+ * Scene of generated sprites for scaling tests, every object gets a random transform, texture and shader variant from the seed.
+ * With --sweep=KNOB the scene is regenerated every --frames-per-step frames with the knob doubled, and the frame, CPU and GPU
+ * times of each step are printed so that the step where the cost stops growing linearly stands out.
+ * With --occlusion the objects are drawn opaque at their own depth after a depth prepass of the largest and nearest, optionally
+ * culled against a CPU depth pyramid of those occluders and tested with occlusion queries, the fragments shaded are
+ * counted so that the overdraw saved can be compared with the time spent culling.
+ */
+class Stress : public BaseApplication
+{
+  public:
+    virtual ~Stress() = default;
+
+  private:
+    enum class Knob
+    {
+        OBJECTS,
+        TEXTURES,
+        VARIANTS,
+        OVERDRAW,
+        ANIMATED
+    };
+
+    enum class Occlusion
+    {
+        /* Blended in batch order, every fragment is shaded */
+        OFF,
+        /* Opaque with depth testing after a depth prepass of the occluders */
+        DEPTH,
+        /* Plus objects hidden in the depth pyramid of the occluders are not drawn */
+        HIERARCHICAL,
+        /* Plus each remaining object is drawn under conditional rendering of its own occlusion query */
+        QUERIES
+    };
+
+    struct Knobs
+    {
+        std::size_t objects;
+        std::size_t textures;
+        std::size_t variants;
+        /* Average number of objects covering a pixel of the window */
+        float overdraw;
+        /* Fraction of the objects moving every frame, the others keep their transform and bounds */
+        float animated;
+    };
+
+    struct StepResult
+    {
+        double value;
+        std::size_t visible;
+        std::size_t occluded;
+        std::size_t batches;
+        /* Samples that passed the depth test in the colour pass, in millions per frame */
+        double fragments;
+        double frame_milliseconds;
+        double cpu_milliseconds;
+        double gpu_milliseconds;
+    };
+
+    struct SceneObject
+    {
+        glm::vec2 position;
+        GLfloat angle;
+        GLfloat spin;
+        GLfloat size;
+        /* In NDC, only used with occlusion */
+        GLfloat depth;
+        glm::vec4 tint;
+        std::uint32_t variant;
+        std::uint32_t texture;
+        bool animated;
+    };
+
+    /* In the order of Knob */
+    static constexpr std::array<std::string_view, 5> KNOB_NAMES{"objects", "textures", "variants", "overdraw", "animated"};
+    /* In the order of Occlusion */
+    static constexpr std::array<std::string_view, 4> OCCLUSION_NAMES{"off", "depth", "hiz", "queries"};
+    static constexpr std::size_t VARIANT_COUNT{4};
+    static constexpr std::size_t QUERY_COUNT{4};
+    /* Objects past this many in query mode are drawn without a test */
+    static constexpr std::size_t MAX_OBJECT_QUERIES{16384};
+    static constexpr std::size_t WARM_UP_FRAMES{10};
+    static constexpr int TEXTURE_SIZE{64};
+    /* Objects are spread slightly past the window so that culling has something to reject */
+    static constexpr GLfloat SPREAD{1.25f};
+
+    void
+    setup(void) override
+    {
+        seed = options.getNumber<std::uint32_t>("seed", 1);
+        knobs = {options.getNumber<std::size_t>("objects", 10000), std::max(options.getNumber<std::size_t>("textures", 8), std::size_t{1}),
+                 std::clamp(options.getNumber<std::size_t>("variants", VARIANT_COUNT), std::size_t{1}, VARIANT_COUNT),
+                 std::max(options.getNumber<float>("overdraw", 2.0f), 0.0f), std::clamp(options.getNumber<float>("animated", 0.25f), 0.0f, 1.0f)};
+        sort_mode = "submission" == options.getValue("sort").value_or("state") ? SpriteBatch::SortMode::SUBMISSION : SpriteBatch::SortMode::STATE;
+
+        if (const auto knob_name = options.getValue("sweep")) {
+            sweep = parseKnob(*knob_name);
+            if (!sweep) {
+                fmt::print(stderr, "setup: {}\n", "Unknown sweep knob, expected objects, textures, variants, overdraw or animated.");
+            }
+        }
+        if (const auto occlusion_name = options.getValue("occlusion")) {
+            if (const auto mode = parseOcclusion(*occlusion_name)) {
+                occlusion = *mode;
+            } else {
+                fmt::print(stderr, "setup: {}\n", "Unknown occlusion mode, expected off, depth, hiz or queries.");
+            }
+        }
+        occluder_count = options.getNumber<std::size_t>("occluders", 256);
+        sweep_steps = std::max(options.getNumber<std::size_t>("steps", 6), std::size_t{1});
+        frames_per_step = std::max(options.getNumber<std::size_t>("frames-per-step", 120), std::size_t{1});
+
+        shaders[0] = std::make_unique<Shader>(VERTEX_SHADER_FILE, FLAT_FRAGMENT_SHADER_FILE);
+        shaders[1] = std::make_unique<Shader>(VERTEX_SHADER_FILE, TEXTURED_FRAGMENT_SHADER_FILE);
+        shaders[2] = std::make_unique<Shader>(VERTEX_SHADER_FILE, BLUR_FRAGMENT_SHADER_FILE);
+        shaders[3] = std::make_unique<Shader>(VERTEX_SHADER_FILE, NOISE_FRAGMENT_SHADER_FILE);
+        for (const std::unique_ptr<Shader> &shader : shaders) {
+            shader->useProgram();
+            shader->setUniform("texture0", 0);
+        }
+        batch = std::make_unique<SpriteBatch>();
+        glGenQueries(QUERY_COUNT, queries.data());
+        glGenQueries(QUERY_COUNT, fragment_queries.data());
+
+        base_knobs = knobs;
+        if (sweep) {
+            /* The swap would otherwise hide everything under the refresh interval */
+            glfwSwapInterval(0);
+            applyStep(0);
+            fmt::print("Stress: sweeping {} over {} steps of {} frames\n", getKnobName(*sweep), sweep_steps, frames_per_step);
+            fmt::print("Stress: occlusion {}\n", getOcclusionName(occlusion));
+            fmt::print("{:>10} {:>9} {:>9} {:>8} {:>10} {:>10} {:>8} {:>8} {:>8} {:>6}\n", getKnobName(*sweep), "Visible", "Occluded", "Batches", "MFragments",
+                       "Frame ms", "CPU ms", "GPU ms", "Growth", "Bound");
+        }
+        generateScene();
+        /* Measured frames have to be rendered back to back */
+        damage.addAnimation(0.0);
+
+        input.bind({
+            {QUIT, GLFW_KEY_ESCAPE},
+            {SWITCH_OCCLUSION, GLFW_KEY_SPACE},
+        });
+    }
+
+    enum Action : Input::ActionId
+    {
+        QUIT,
+        SWITCH_OCCLUSION
+    };
+
+    static std::optional<Knob>
+    parseKnob(std::string_view name) noexcept
+    {
+        for (std::size_t i = 0; i < KNOB_NAMES.size(); ++i) {
+            if (KNOB_NAMES[i] == name) {
+                return static_cast<Knob>(i);
+            }
+        }
+        return std::nullopt;
+    }
+
+    static std::string_view
+    getKnobName(Knob knob) noexcept
+    {
+        return KNOB_NAMES[static_cast<std::size_t>(knob)];
+    }
+
+    static std::optional<Occlusion>
+    parseOcclusion(std::string_view name) noexcept
+    {
+        for (std::size_t i = 0; i < OCCLUSION_NAMES.size(); ++i) {
+            if (OCCLUSION_NAMES[i] == name) {
+                return static_cast<Occlusion>(i);
+            }
+        }
+        return std::nullopt;
+    }
+
+    static std::string_view
+    getOcclusionName(Occlusion mode) noexcept
+    {
+        return OCCLUSION_NAMES[static_cast<std::size_t>(mode)];
+    }
+
+    /* Counts and overdraw double at every step, variants are added one by one and the animated fraction goes from 0 to 1 */
+    void
+    applyStep(std::size_t step)
+    {
+        const auto scale = static_cast<std::size_t>(1) << step;
+        switch (*sweep) {
+        case Knob::OBJECTS:
+            knobs.objects = base_knobs.objects * scale;
+            break;
+        case Knob::TEXTURES:
+            knobs.textures = base_knobs.textures * scale;
+            break;
+        case Knob::VARIANTS:
+            knobs.variants = std::min(step + 1, VARIANT_COUNT);
+            break;
+        case Knob::OVERDRAW:
+            knobs.overdraw = base_knobs.overdraw * static_cast<float>(scale);
+            break;
+        case Knob::ANIMATED:
+            knobs.animated = 1 == sweep_steps ? 1.0f : static_cast<float>(step) / static_cast<float>(sweep_steps - 1);
+            break;
+        }
+    }
+
+    double
+    getKnobValue(void) const noexcept
+    {
+        switch (*sweep) {
+        case Knob::OBJECTS:
+            return static_cast<double>(knobs.objects);
+        case Knob::TEXTURES:
+            return static_cast<double>(knobs.textures);
+        case Knob::VARIANTS:
+            return static_cast<double>(knobs.variants);
+        case Knob::OVERDRAW:
+            return static_cast<double>(knobs.overdraw);
+        case Knob::ANIMATED:
+            return static_cast<double>(knobs.animated);
+        }
+        return 0.0;
+    }
+
+    /* The same seed and knobs always give the same scene */
+    void
+    generateScene(void)
+    {
+        std::mt19937 generator{seed};
+        /* Apart so that the scene without occlusion stays the same */
+        std::mt19937 depth_generator{seed + 1};
+        std::uniform_real_distribution<GLfloat> unit(0.0f, 1.0f);
+
+        if (textures.size() != knobs.textures) {
+            std::mt19937 texture_generator{seed};
+            textures.clear();
+            textures.resize(knobs.textures);
+            std::vector<unsigned char> pixels(static_cast<std::size_t>(TEXTURE_SIZE * TEXTURE_SIZE * 4));
+            for (Resource::Texture &texture : textures) {
+                generateTexture(texture_generator, pixels);
+                TextureUpload::upload(texture, {TEXTURE_SIZE, TEXTURE_SIZE, 4, pixels.data()});
+            }
+        }
+
+        /* Sized so that the objects on screen cover it overdraw times on average */
+        const GLfloat spread_area = 4.0f * SPREAD * SPREAD;
+        const GLfloat size = std::sqrt(knobs.overdraw * spread_area / static_cast<GLfloat>(std::max(knobs.objects, std::size_t{1})));
+        std::uniform_int_distribution<std::uint32_t> variant(0, static_cast<std::uint32_t>(knobs.variants - 1));
+        std::uniform_int_distribution<std::uint32_t> texture(0, static_cast<std::uint32_t>(knobs.textures - 1));
+        objects.clear();
+        objects.reserve(knobs.objects);
+        std::vector<Culling::BoundingBox> boxes{};
+        boxes.reserve(knobs.objects);
+        for (std::size_t i = 0; i < knobs.objects; ++i) {
+            const glm::vec2 position{(unit(generator) * 2.0f - 1.0f) * SPREAD, (unit(generator) * 2.0f - 1.0f) * SPREAD};
+            objects.push_back({position, unit(generator) * 6.2831853f, unit(generator) * 2.0f - 1.0f, size * (0.5f + unit(generator)),
+                               (unit(depth_generator) * 2.0f - 1.0f) * 0.9f,
+                               glm::vec4(unit(generator), unit(generator), unit(generator), 0.5f + 0.5f * unit(generator)), variant(generator),
+                               texture(generator), unit(generator) < knobs.animated});
+            boxes.push_back(getBounds(objects.back()));
+        }
+        bvh.build(boxes);
+        visible.clear();
+    }
+
+    /* Checker of two random colours fading out towards the edges, so that blending has to read the destination */
+    static void
+    generateTexture(std::mt19937 &generator, std::vector<unsigned char> &pixels)
+    {
+        std::uniform_int_distribution<int> channel(64, 255);
+        const std::array<int, 6> colours{channel(generator), channel(generator), channel(generator), channel(generator), channel(generator), channel(generator)};
+        const int cell = 4 << (generator() % 3);
+        for (int y = 0; y < TEXTURE_SIZE; ++y) {
+            for (int x = 0; x < TEXTURE_SIZE; ++x) {
+                const std::size_t offset = static_cast<std::size_t>((y * TEXTURE_SIZE + x) * 4);
+                const int colour = ((x / cell + y / cell) % 2) * 3;
+                const float dx = (static_cast<float>(x) + 0.5f) / TEXTURE_SIZE * 2.0f - 1.0f;
+                const float dy = (static_cast<float>(y) + 0.5f) / TEXTURE_SIZE * 2.0f - 1.0f;
+                const float alpha = std::clamp(1.5f - std::sqrt(dx * dx + dy * dy) * 1.5f, 0.0f, 1.0f);
+                pixels[offset + 0] = static_cast<unsigned char>(colours[static_cast<std::size_t>(colour + 0)]);
+                pixels[offset + 1] = static_cast<unsigned char>(colours[static_cast<std::size_t>(colour + 1)]);
+                pixels[offset + 2] = static_cast<unsigned char>(colours[static_cast<std::size_t>(colour + 2)]);
+                pixels[offset + 3] = static_cast<unsigned char>(alpha * 255.0f);
+            }
+        }
+    }
+
+    static glm::mat4
+    getTransformation(const SceneObject &object) noexcept
+    {
+        const GLfloat cosine = std::cos(object.angle) * object.size;
+        const GLfloat sine = std::sin(object.angle) * object.size;
+        glm::mat4 transformation{1.0f};
+        transformation[0] = glm::vec4(cosine, sine, 0.0f, 0.0f);
+        transformation[1] = glm::vec4(-sine, cosine, 0.0f, 0.0f);
+        transformation[3] = glm::vec4(object.position.x, object.position.y, object.depth, 1.0f);
+        return transformation;
+    }
+
+    /* Corners of the quad as drawn, in order around it */
+    static std::array<glm::vec2, 4>
+    getCorners(const SceneObject &object) noexcept
+    {
+        const glm::mat4 transformation = getTransformation(object);
+        std::array<glm::vec2, 4> corners{glm::vec2(-0.5f, -0.5f), glm::vec2(0.5f, -0.5f), glm::vec2(0.5f, 0.5f), glm::vec2(-0.5f, 0.5f)};
+        for (glm::vec2 &corner : corners) {
+            const glm::vec4 moved = transformation * glm::vec4(corner.x, corner.y, 0.0f, 1.0f);
+            corner = glm::vec2(moved.x, moved.y);
+        }
+        return corners;
+    }
+
+    /* Bounds of the unit quad whatever its rotation */
+    static Culling::BoundingBox
+    getBounds(const SceneObject &object) noexcept
+    {
+        const GLfloat radius = object.size * 0.70710678f;
+        return {{object.position.x - radius, object.position.y - radius, object.depth}, {object.position.x + radius, object.position.y + radius, object.depth}};
+    }
+
+    void
+    processInputs(void) override
+    {
+        if (input.isDown(QUIT)) {
+            glfwSetWindowShouldClose(window, GLFW_TRUE);
+        }
+        /* A sweep keeps one mode so that its steps compare */
+        if (input.wasPressed(SWITCH_OCCLUSION) && !sweep) {
+            occlusion = static_cast<Occlusion>((static_cast<std::size_t>(occlusion) + 1) % OCCLUSION_NAMES.size());
+            resetMeasurements();
+            fmt::print("Stress: occlusion {}\n", getOcclusionName(occlusion));
+        }
+    }
+
+    void
+    render(void) override
+    {
+        const auto frame_start = std::chrono::steady_clock::now();
+        glClearColor(0.1f, 0.1f, 0.1f, 1.0f);
+        glClear(Occlusion::OFF == occlusion ? GL_COLOR_BUFFER_BIT : GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+        glBeginQuery(GL_TIME_ELAPSED, queries[query_index]);
+
+        /* Animated objects drift around their position and spin, only their leaves are refitted */
+        const auto delta = static_cast<GLfloat>(std::min(frame_time - last_frame_time, 0.1));
+        last_frame_time = frame_time;
+        for (std::size_t i = 0; i < objects.size(); ++i) {
+            SceneObject &object = objects[i];
+            if (!object.animated) {
+                continue;
+            }
+            object.angle += object.spin * delta;
+            object.position += 0.05f * delta * glm::vec2(std::cos(object.angle), std::sin(object.angle));
+            bvh.update(static_cast<Culling::ObjectId>(i), getBounds(object));
+        }
+        if (bvh.needsRebuild()) {
+            bvh.rebuild();
+        }
+        visible.clear();
+        bvh.cull(Culling::Frustum{glm::mat4(1.0f)}, visible);
+
+        occluded = 0;
+        std::size_t tested = 0;
+        if (Occlusion::OFF == occlusion) {
+            glEnable(GL_BLEND);
+            glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+        } else {
+            selectOccluders();
+            drawDepthPrepass();
+            if (Occlusion::DEPTH != occlusion) {
+                cullOccluded();
+            }
+            if (Occlusion::QUERIES == occlusion) {
+                tested = issueObjectQueries();
+            }
+            /* The occluders are drawn again at the depth they already wrote */
+            glDepthFunc(GL_LEQUAL);
+        }
+
+        glBeginQuery(GL_SAMPLES_PASSED, fragment_queries[query_index]);
+        main_batches = 0;
+        for (std::size_t i = 0; i < tested; ++i) {
+            glBeginConditionalRender(object_queries[i], GL_QUERY_WAIT);
+            drawObjects(visible.begin() + static_cast<std::ptrdiff_t>(i), visible.begin() + static_cast<std::ptrdiff_t>(i + 1));
+            glEndConditionalRender();
+        }
+        drawObjects(visible.begin() + static_cast<std::ptrdiff_t>(tested), visible.end());
+        glEndQuery(GL_SAMPLES_PASSED);
+
+        glEndQuery(GL_TIME_ELAPSED);
+        query_index = (query_index + 1) % QUERY_COUNT;
+        glDisable(GL_BLEND);
+        glDisable(GL_DEPTH_TEST);
+        glDepthFunc(GL_LESS);
+        const std::chrono::duration<double, std::milli> cpu_time = std::chrono::steady_clock::now() - frame_start;
+        accumulate(frame_start, cpu_time.count());
+    }
+
+    void
+    drawObjects(std::vector<Culling::ObjectId>::const_iterator begin, std::vector<Culling::ObjectId>::const_iterator end)
+    {
+        if (begin == end) {
+            return;
+        }
+        batch->begin(sort_mode);
+        for (auto id = begin; id != end; ++id) {
+            const SceneObject &object = objects[*id];
+            batch->draw({shaders[object.variant].get(), textures[object.texture].get()}, getTransformation(object), {{0.0f, 0.0f}, {1.0f, 1.0f}}, object.tint);
+        }
+        batch->end();
+        main_batches += batch->getStats().batches;
+    }
+
+    /* The visible objects most likely to hide others, the largest and nearest */
+    void
+    selectOccluders(void)
+    {
+        occluders.assign(visible.begin(), visible.end());
+        const std::size_t count = std::min(occluder_count, occluders.size());
+        const auto score = [this](Culling::ObjectId id) { return objects[id].size * objects[id].size * (1.0f - objects[id].depth); };
+        std::nth_element(occluders.begin(), occluders.begin() + static_cast<std::ptrdiff_t>(count), occluders.end(),
+                         [&score](Culling::ObjectId lhs, Culling::ObjectId rhs) { return score(lhs) > score(rhs); });
+        occluders.resize(count);
+    }
+
+    /* Depth only, the colour pass then skips whatever lies behind the occluders before shading it */
+    void
+    drawDepthPrepass(void)
+    {
+        glEnable(GL_DEPTH_TEST);
+        glDepthFunc(GL_LESS);
+        glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
+        batch->begin(SpriteBatch::SortMode::SUBMISSION);
+        for (Culling::ObjectId id : occluders) {
+            batch->draw({shaders[0].get(), 0}, getTransformation(objects[id]));
+        }
+        batch->end();
+        glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+    }
+
+    /* Drops the visible objects hidden behind the occluders according to their depth pyramid */
+    void
+    cullOccluded(void)
+    {
+        pyramid.clear();
+        for (Culling::ObjectId id : occluders) {
+            pyramid.addOccluder(getCorners(objects[id]), objects[id].depth);
+        }
+        pyramid.build();
+        const std::size_t candidates = visible.size();
+        std::erase_if(visible, [this](Culling::ObjectId id) { return pyramid.isOccluded(bvh.getBounds(id)); });
+        occluded = candidates - visible.size();
+    }
+
+    /*
+     * Draws the quad of every remaining object against the prepass depth under its own any-samples query, the colour
+     * pass then renders each object conditionally on its query on the GPU. This catches what the pyramid could not
+     * prove hidden at the cost of two draws per object. Returns how many objects got a query.
+     */
+    std::size_t
+    issueObjectQueries(void)
+    {
+        const std::size_t count = std::min(visible.size(), MAX_OBJECT_QUERIES);
+        if (object_queries.size() < count) {
+            const std::size_t first = object_queries.size();
+            object_queries.resize(count);
+            glGenQueries(static_cast<GLsizei>(count - first), object_queries.data() + first);
+        }
+        glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
+        glDepthMask(GL_FALSE);
+        glDepthFunc(GL_LEQUAL);
+        for (std::size_t i = 0; i < count; ++i) {
+            glBeginQuery(GL_ANY_SAMPLES_PASSED, object_queries[i]);
+            batch->begin(SpriteBatch::SortMode::SUBMISSION);
+            batch->draw({shaders[0].get(), 0}, getTransformation(objects[visible[i]]));
+            batch->end();
+            glEndQuery(GL_ANY_SAMPLES_PASSED);
+        }
+        glDepthMask(GL_TRUE);
+        glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+        return count;
+    }
+
+    void
+    resetMeasurements(void) noexcept
+    {
+        frames_in_step = 0;
+        measured_frames = 0;
+        gpu_samples = 0;
+        fragment_samples = 0;
+        frame_total = cpu_total = gpu_total = fragment_total = 0.0;
+        occluded_total = 0;
+        last_render_start.reset();
+    }
+
+    /* Queries are read QUERY_COUNT - 1 frames late so that reading them does not stall */
+    void
+    accumulate(std::chrono::steady_clock::time_point frame_start, double cpu_milliseconds)
+    {
+        ++frames_in_step;
+        std::optional<double> gpu_milliseconds{};
+        std::optional<double> fragments{};
+        if (frame_count + 1 >= QUERY_COUNT) {
+            GLint available = GL_FALSE;
+            glGetQueryObjectiv(queries[query_index], GL_QUERY_RESULT_AVAILABLE, &available);
+            if (GL_TRUE == available) {
+                GLuint64 nanoseconds = 0;
+                glGetQueryObjectui64v(queries[query_index], GL_QUERY_RESULT, &nanoseconds);
+                gpu_milliseconds = static_cast<double>(nanoseconds) * 1e-6;
+            }
+            glGetQueryObjectiv(fragment_queries[query_index], GL_QUERY_RESULT_AVAILABLE, &available);
+            if (GL_TRUE == available) {
+                GLuint64 samples = 0;
+                glGetQueryObjectui64v(fragment_queries[query_index], GL_QUERY_RESULT, &samples);
+                fragments = static_cast<double>(samples);
+            }
+        }
+        const std::optional<double> frame_milliseconds =
+            last_render_start ? std::optional<double>{std::chrono::duration<double, std::milli>(frame_start - *last_render_start).count()} : std::nullopt;
+        last_render_start = frame_start;
+
+        if (frames_in_step > WARM_UP_FRAMES) {
+            ++measured_frames;
+            cpu_total += cpu_milliseconds;
+            occluded_total += occluded;
+            if (frame_milliseconds) {
+                frame_total += *frame_milliseconds;
+            }
+            if (gpu_milliseconds) {
+                gpu_total += *gpu_milliseconds;
+                ++gpu_samples;
+            }
+            if (fragments) {
+                fragment_total += *fragments;
+                ++fragment_samples;
+            }
+        }
+
+        const std::size_t step_length = sweep ? frames_per_step + WARM_UP_FRAMES : 120;
+        if (frames_in_step < step_length) {
+            return;
+        }
+        const StepResult result{sweep ? getKnobValue() : 0.0,
+                                visible.size(),
+                                occluded_total / std::max(measured_frames, std::size_t{1}),
+                                main_batches,
+                                fragment_total * 1e-6 / static_cast<double>(std::max(fragment_samples, std::size_t{1})),
+                                frame_total / static_cast<double>(std::max(measured_frames, std::size_t{1})),
+                                cpu_total / static_cast<double>(std::max(measured_frames, std::size_t{1})),
+                                gpu_total / static_cast<double>(std::max(gpu_samples, std::size_t{1}))};
+        resetMeasurements();
+
+        if (!sweep) {
+            fmt::print("Stress: {} objects, {} visible, {} occluded, {} batches, {:.2f}M fragments, frame {:.3f} ms, CPU {:.3f} ms, GPU {:.3f} ms ({})\n",
+                       objects.size(), result.visible, result.occluded, result.batches, result.fragments, result.frame_milliseconds, result.cpu_milliseconds,
+                       result.gpu_milliseconds, getOcclusionName(occlusion));
+            return;
+        }
+        printStep(result);
+        results.push_back(result);
+        if (results.size() == sweep_steps) {
+            printSteepestStep();
+            glfwSetWindowShouldClose(window, GLFW_TRUE);
+            return;
+        }
+        applyStep(results.size());
+        generateScene();
+    }
+
+    void
+    printStep(const StepResult &result) const
+    {
+        const std::string growth = results.empty() || 0.0 >= results.back().frame_milliseconds
+                                       ? std::string{"-"}
+                                       : fmt::format("x{:.2f}", result.frame_milliseconds / results.back().frame_milliseconds);
+        fmt::print("{:>10.4g} {:>9} {:>9} {:>8} {:>10.2f} {:>10.3f} {:>8.3f} {:>8.3f} {:>8} {:>6}\n", result.value, result.visible, result.occluded,
+                   result.batches, result.fragments, result.frame_milliseconds, result.cpu_milliseconds, result.gpu_milliseconds, growth,
+                   result.gpu_milliseconds > result.cpu_milliseconds ? "GPU" : "CPU");
+    }
+
+    /* The cliff is where the frame time grew the most from one step to the next */
+    void
+    printSteepestStep(void) const
+    {
+        std::size_t steepest = 0;
+        double steepest_growth = 0.0;
+        for (std::size_t i = 1; i < results.size(); ++i) {
+            if (0.0 >= results[i - 1].frame_milliseconds) {
+                continue;
+            }
+            const double growth = results[i].frame_milliseconds / results[i - 1].frame_milliseconds;
+            if (growth > steepest_growth) {
+                steepest_growth = growth;
+                steepest = i;
+            }
+        }
+        if (0 == steepest) {
+            return;
+        }
+        const StepResult &result = results[steepest];
+        fmt::print("Stress: steepest step {} {:.4g} -> {:.4g}, frame time x{:.2f}, {} bound\n", getKnobName(*sweep), results[steepest - 1].value, result.value,
+                   steepest_growth, result.gpu_milliseconds > result.cpu_milliseconds ? "GPU" : "CPU");
+    }
+
+    void
+    teardown(void) override
+    {
+        glDeleteQueries(QUERY_COUNT, queries.data());
+        glDeleteQueries(QUERY_COUNT, fragment_queries.data());
+        if (!object_queries.empty()) {
+            glDeleteQueries(static_cast<GLsizei>(object_queries.size()), object_queries.data());
+        }
+        batch.reset();
+        textures.clear();
+        for (std::unique_ptr<Shader> &shader : shaders) {
+            shader.reset();
+        }
+    }
+
+    std::uint32_t seed = 1;
+    Knobs knobs{};
+    /* Values given on the command line, the first step of a sweep */
+    Knobs base_knobs{};
+    std::optional<Knob> sweep{};
+    std::size_t sweep_steps = 6;
+    std::size_t frames_per_step = 120;
+    SpriteBatch::SortMode sort_mode = SpriteBatch::SortMode::STATE;
+    Occlusion occlusion = Occlusion::OFF;
+    std::size_t occluder_count = 256;
+
+    std::array<std::unique_ptr<Shader>, VARIANT_COUNT> shaders{};
+    std::unique_ptr<SpriteBatch> batch = nullptr;
+    std::vector<Resource::Texture> textures{};
+    std::vector<SceneObject> objects{};
+    Culling::BoundingVolumeHierarchy bvh{};
+    std::vector<Culling::ObjectId> visible{};
+    std::vector<Culling::ObjectId> occluders{};
+    Culling::DepthPyramid pyramid{};
+    std::vector<GLuint> object_queries{};
+    std::size_t occluded = 0;
+    std::size_t main_batches = 0;
+
+    std::array<GLuint, QUERY_COUNT> queries{};
+    /* Samples passed in the colour pass, read as late as the timer queries */
+    std::array<GLuint, QUERY_COUNT> fragment_queries{};
+    std::size_t query_index = 0;
+    double last_frame_time = 0.0;
+    std::optional<std::chrono::steady_clock::time_point> last_render_start{};
+    std::size_t frames_in_step = 0;
+    std::size_t measured_frames = 0;
+    std::size_t gpu_samples = 0;
+    std::size_t fragment_samples = 0;
+    std::size_t occluded_total = 0;
+    double frame_total = 0.0;
+    double cpu_total = 0.0;
+    double gpu_total = 0.0;
+    double fragment_total = 0.0;
+    std::vector<StepResult> results{};
+};
+
+#ifdef SCENE_HOST
+std::unique_ptr<BaseApplication>
+createStress(void)
+{
+    return std::make_unique<Stress>();
+}
+#else
+int
+main(int argc, char **argv)
+{
+    Stress app{};
+    return app.run(argc, argv);
+}
+#endif
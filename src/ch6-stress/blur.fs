@@ -0,0 +1,21 @@
+#version 330 core
+in vec2 TexCoords;
+in vec4 Tint;
+
+out vec4 FragColour;
+
+uniform sampler2D texture0;
+
+/* Nine taps, bound by texture fetches */
+void
+main()
+{
+    vec2 texel = 1.0 / vec2(textureSize(texture0, 0));
+    vec4 sum = vec4(0.0);
+    for (int y = -1; y <= 1; ++y) {
+        for (int x = -1; x <= 1; ++x) {
+            sum += texture(texture0, TexCoords + vec2(x, y) * texel);
+        }
+    }
+    FragColour = sum / 9.0 * Tint;
+}
@@ -0,0 +1,11 @@
+#version 330 core
+in vec2 TexCoords;
+in vec4 Tint;
+
+out vec4 FragColour;
+
+void
+main()
+{
+    FragColour = Tint;
+}
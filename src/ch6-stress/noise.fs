@@ -0,0 +1,32 @@
+#version 330 core
+in vec2 TexCoords;
+in vec4 Tint;
+
+out vec4 FragColour;
+
+uniform sampler2D texture0;
+
+float
+hash(vec2 point)
+{
+    return fract(sin(dot(point, vec2(12.9898, 78.233))) * 43758.5453);
+}
+
+/* Value noise summed over octaves, bound by arithmetic */
+void
+main()
+{
+    float noise = 0.0;
+    float amplitude = 0.5;
+    vec2 point = TexCoords * 8.0;
+    for (int octave = 0; octave < 6; ++octave) {
+        vec2 cell = floor(point);
+        vec2 blend = smoothstep(0.0, 1.0, fract(point));
+        float bottom = mix(hash(cell), hash(cell + vec2(1.0, 0.0)), blend.x);
+        float top = mix(hash(cell + vec2(0.0, 1.0)), hash(cell + vec2(1.0, 1.0)), blend.x);
+        noise += amplitude * mix(bottom, top, blend.y);
+        amplitude *= 0.5;
+        point *= 2.0;
+    }
+    FragColour = texture(texture0, TexCoords) * Tint * vec4(vec3(0.5 + noise), 1.0);
+}
@@ -0,0 +1,15 @@
+#version 330 core
+layout(location = 0) in vec3 aPos;
+layout(location = 1) in vec2 aTexCoords;
+layout(location = 2) in vec4 aTint;
+
+out vec2 TexCoords;
+out vec4 Tint;
+
+void
+main()
+{
+    gl_Position = vec4(aPos, 1.0);
+    TexCoords = aTexCoords;
+    Tint = aTint;
+}
@@ -0,0 +1,232 @@
+#include "../BaseApplication.hpp"
+
+#include "PostProcessFiles.hpp"
+#include "RenderGraph.hpp"
+#include "Resource.hpp"
+#include "Shader.hpp"
+
+#include <fmt/core.h>
+#include <glm/glm.hpp>
+
+#include <memory>
+#include <string>
+
+/*
+ * Bloom and tone mapping as a render graph: an HDR scene, a bright pass and two rounds of separable blur at half
+ * resolution, a composite and a vignette into the backbuffer. A luminance pass nothing reads shows culling.
+ * The graph is compiled again whenever the framebuffer is resized, space toggles transient aliasing.
+ */
+class PostProcess : public BaseApplication
+{
+  public:
+    virtual ~PostProcess() = default;
+
+  private:
+    static constexpr std::size_t BLUR_ROUNDS{2};
+
+    void
+    setup(void) override
+    {
+        scene_shader = std::make_unique<Shader>(VERTEX_SHADER_FILE, SCENE_FRAGMENT_SHADER_FILE);
+        bright_shader = std::make_unique<Shader>(VERTEX_SHADER_FILE, BRIGHT_FRAGMENT_SHADER_FILE);
+        blur_shader = std::make_unique<Shader>(VERTEX_SHADER_FILE, BLUR_FRAGMENT_SHADER_FILE);
+        composite_shader = std::make_unique<Shader>(VERTEX_SHADER_FILE, COMPOSITE_FRAGMENT_SHADER_FILE);
+        vignette_shader = std::make_unique<Shader>(VERTEX_SHADER_FILE, VIGNETTE_FRAGMENT_SHADER_FILE);
+        composite_shader->useProgram();
+        composite_shader->setUniform("scene", 0);
+        composite_shader->setUniform("bloom", 1);
+
+        /* The fullscreen triangle comes from gl_VertexID but the core profile still needs a vertex array bound */
+        vao = Resource::VertexArray::create();
+        aliasing = !options.hasFlag("no-aliasing");
+        buildGraph();
+        compileGraph();
+
+        damage.addAnimation(0.0);
+
+        input.bind({
+            {QUIT, GLFW_KEY_ESCAPE},
+            {TOGGLE_ALIASING, GLFW_KEY_SPACE},
+        });
+    }
+
+    enum Action : Input::ActionId
+    {
+        QUIT,
+        TOGGLE_ALIASING
+    };
+
+    void
+    buildGraph(void)
+    {
+        graph = std::make_unique<RenderGraph::Graph>();
+        RenderGraph::ResourceId scene{};
+        graph->addPass(
+            "scene", [&scene](RenderGraph::PassBuilder &builder) { scene = builder.create("scene", {GL_RGBA16F}); },
+            [this](const RenderGraph::PassContext &context) {
+                scene_shader->useProgram();
+                scene_shader->setUniform("time", static_cast<GLfloat>(frame_time));
+                scene_shader->setUniform("aspect", static_cast<GLfloat>(context.getWidth()) / static_cast<GLfloat>(context.getHeight()));
+                drawFullscreen();
+            });
+
+        /* Debug view nothing consumes, culled unless it is made a side effect */
+        graph->addPass(
+            "luminance",
+            [scene](RenderGraph::PassBuilder &builder) {
+                builder.read(scene);
+                builder.create("luminance", {GL_R16F});
+            },
+            [this, scene](const RenderGraph::PassContext &context) { drawBright(context, scene, 0.0f); });
+
+        RenderGraph::ResourceId bloom{};
+        graph->addPass(
+            "bright",
+            [scene, &bloom](RenderGraph::PassBuilder &builder) {
+                builder.read(scene);
+                bloom = builder.create("bright", {GL_RGBA16F, 0.5f});
+            },
+            [this, scene](const RenderGraph::PassContext &context) { drawBright(context, scene, 1.0f); });
+
+        for (std::size_t round = 0; round < BLUR_ROUNDS; ++round) {
+            for (const bool horizontal : {true, false}) {
+                const std::string name = fmt::format("blur {} {}", horizontal ? 'x' : 'y', round);
+                const RenderGraph::ResourceId input_id = bloom;
+                graph->addPass(
+                    name,
+                    [input_id, &bloom, &name](RenderGraph::PassBuilder &builder) {
+                        builder.read(input_id);
+                        bloom = builder.create(name, {GL_RGBA16F, 0.5f});
+                    },
+                    [this, input_id, horizontal](const RenderGraph::PassContext &context) {
+                        context.bindTexture(input_id, 0);
+                        blur_shader->useProgram();
+                        const glm::vec2 texel{1.0f / static_cast<GLfloat>(context.getWidth()), 1.0f / static_cast<GLfloat>(context.getHeight())};
+                        blur_shader->setUniform("direction", horizontal ? glm::vec2(texel.x, 0.0f) : glm::vec2(0.0f, texel.y));
+                        drawFullscreen();
+                    });
+            }
+        }
+
+        RenderGraph::ResourceId tonemapped{};
+        graph->addPass(
+            "composite",
+            [scene, bloom, &tonemapped](RenderGraph::PassBuilder &builder) {
+                builder.read(scene);
+                builder.read(bloom);
+                tonemapped = builder.create("tonemapped", {GL_RGBA8});
+            },
+            [this, scene, bloom](const RenderGraph::PassContext &context) {
+                context.bindTexture(scene, 0);
+                context.bindTexture(bloom, 1);
+                composite_shader->useProgram();
+                composite_shader->setUniform("exposure", 0.8f);
+                drawFullscreen();
+            });
+
+        graph->addPass(
+            "vignette",
+            [this, tonemapped](RenderGraph::PassBuilder &builder) {
+                builder.read(tonemapped);
+                builder.write(graph->getBackbuffer());
+            },
+            [this, tonemapped](const RenderGraph::PassContext &context) {
+                context.bindTexture(tonemapped, 0);
+                vignette_shader->useProgram();
+                drawFullscreen();
+            });
+    }
+
+    void
+    compileGraph(void)
+    {
+        const Scaling::RenderTarget target = getRenderTarget();
+        graph_width = target.width;
+        graph_height = target.height;
+        if (!graph->compile(graph_width, graph_height, aliasing)) {
+            fmt::print(stderr, "compileGraph: {}\n", "Failed to compile the render graph.");
+            glfwSetWindowShouldClose(window, GLFW_TRUE);
+            return;
+        }
+        fmt::print("PostProcess: {}x{}, aliasing {}\n", graph_width, graph_height, aliasing ? "on" : "off");
+        graph->printSummary();
+    }
+
+    void
+    drawBright(const RenderGraph::PassContext &context, RenderGraph::ResourceId scene, GLfloat threshold) const
+    {
+        context.bindTexture(scene, 0);
+        bright_shader->useProgram();
+        bright_shader->setUniform("threshold", threshold);
+        drawFullscreen();
+    }
+
+    void
+    drawFullscreen(void) const
+    {
+        glBindVertexArray(vao.get());
+        glDrawArrays(GL_TRIANGLES, 0, 3);
+    }
+
+    void
+    processInputs(void) override
+    {
+        if (input.isDown(QUIT)) {
+            glfwSetWindowShouldClose(window, GLFW_TRUE);
+        }
+        if (input.wasPressed(TOGGLE_ALIASING)) {
+            aliasing = !aliasing;
+            compileGraph();
+        }
+    }
+
+    void
+    render(void) override
+    {
+        /* The output follows the window and, with dynamic resolution, the render scale */
+        const Scaling::RenderTarget target = getRenderTarget();
+        if (target.width != graph_width || target.height != graph_height) {
+            compileGraph();
+        }
+        graph->execute(target.framebuffer);
+    }
+
+    void
+    teardown(void) override
+    {
+        graph.reset();
+        vao.reset();
+        scene_shader.reset();
+        bright_shader.reset();
+        blur_shader.reset();
+        composite_shader.reset();
+        vignette_shader.reset();
+    }
+
+    std::unique_ptr<RenderGraph::Graph> graph = nullptr;
+    bool aliasing = true;
+    int graph_width = 0;
+    int graph_height = 0;
+
+    Resource::VertexArray vao{};
+    std::unique_ptr<Shader> scene_shader = nullptr;
+    std::unique_ptr<Shader> bright_shader = nullptr;
+    std::unique_ptr<Shader> blur_shader = nullptr;
+    std::unique_ptr<Shader> composite_shader = nullptr;
+    std::unique_ptr<Shader> vignette_shader = nullptr;
+};
+
+#ifdef SCENE_HOST
+std::unique_ptr<BaseApplication>
+createPostProcess(void)
+{
+    return std::make_unique<PostProcess>();
+}
+#else
+int
+main(int argc, char **argv)
+{
+    PostProcess app{};
+    return app.run(argc, argv);
+}
+#endif
@@ -0,0 +1,22 @@
+#version 330 core
+in vec2 TexCoords;
+
+out vec4 FragColour;
+
+uniform sampler2D texture0;
+/* One texel along the blurred axis */
+uniform vec2 direction;
+
+/* Separable Gaussian, nine taps folded into five bilinear fetches */
+void
+main()
+{
+    const float offsets[3] = float[](0.0, 1.3846153846, 3.2307692308);
+    const float weights[3] = float[](0.2270270270, 0.3162162162, 0.0702702703);
+    vec3 sum = texture(texture0, TexCoords).rgb * weights[0];
+    for (int i = 1; i < 3; ++i) {
+        sum += texture(texture0, TexCoords + direction * offsets[i]).rgb * weights[i];
+        sum += texture(texture0, TexCoords - direction * offsets[i]).rgb * weights[i];
+    }
+    FragColour = vec4(sum, 1.0);
+}
@@ -0,0 +1,17 @@
+#version 330 core
+in vec2 TexCoords;
+
+out vec4 FragColour;
+
+uniform sampler2D texture0;
+uniform float threshold;
+
+/* Keep what is brighter than the threshold, softened so that the bloom does not pop */
+void
+main()
+{
+    vec3 colour = texture(texture0, TexCoords).rgb;
+    float luminance = dot(colour, vec3(0.2126, 0.7152, 0.0722));
+    float weight = clamp((luminance - threshold) / max(luminance, 1e-4), 0.0, 1.0);
+    FragColour = vec4(colour * weight, 1.0);
+}
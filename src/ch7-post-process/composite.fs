@@ -0,0 +1,17 @@
+#version 330 core
+in vec2 TexCoords;
+
+out vec4 FragColour;
+
+uniform sampler2D scene;
+uniform sampler2D bloom;
+uniform float exposure;
+
+/* Add the bloom to the HDR scene, then ACES filmic tone mapping and gamma */
+void
+main()
+{
+    vec3 colour = (texture(scene, TexCoords).rgb + texture(bloom, TexCoords).rgb) * exposure;
+    colour = clamp((colour * (2.51 * colour + 0.03)) / (colour * (2.43 * colour + 0.59) + 0.14), 0.0, 1.0);
+    FragColour = vec4(pow(colour, vec3(1.0 / 2.2)), 1.0);
+}
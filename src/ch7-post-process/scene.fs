@@ -0,0 +1,23 @@
+#version 330 core
+in vec2 TexCoords;
+
+out vec4 FragColour;
+
+uniform float time;
+uniform float aspect;
+
+/* Orbiting lights brighter than 1 over a dim gradient, so that bloom has something to pick up */
+void
+main()
+{
+    vec2 position = (TexCoords * 2.0 - 1.0) * vec2(aspect, 1.0);
+    vec3 colour = mix(vec3(0.02, 0.03, 0.08), vec3(0.10, 0.06, 0.04), TexCoords.y);
+    for (int i = 0; i < 6; ++i) {
+        float angle = time * (0.3 + 0.1 * float(i)) + float(i) * 1.047;
+        vec2 centre = vec2(cos(angle), sin(angle * 1.3)) * (0.3 + 0.1 * float(i));
+        vec3 tint = 0.5 + 0.5 * cos(vec3(0.0, 2.1, 4.2) + float(i));
+        float distance = length(position - centre);
+        colour += tint * (4.0 * smoothstep(0.08, 0.06, distance) + 0.02 / (distance * distance + 0.01));
+    }
+    FragColour = vec4(colour, 1.0);
+}
@@ -0,0 +1,14 @@
+#version 330 core
+in vec2 TexCoords;
+
+out vec4 FragColour;
+
+uniform sampler2D texture0;
+
+void
+main()
+{
+    vec2 offset = TexCoords - 0.5;
+    float vignette = smoothstep(0.8, 0.3, length(offset));
+    FragColour = vec4(texture(texture0, TexCoords).rgb * vignette, 1.0);
+}
@@ -0,0 +1,224 @@
+#include "../BaseApplication.hpp"
+
+#include "Loader.hpp"
+#include "ParticleSystem.hpp"
+#include "ParticlesFiles.hpp"
+#include "Utils.hpp"
+
+#include <fmt/core.h>
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <optional>
+
+/*
+ * Fountain of particles simulated either on the GPU with transform feedback or on the CPU with SIMD over the job
+ * system, so that both can be compared on the same machine. Particles are drawn as instanced quads of an image.
+ * Every 120 frames the CPU time spent simulating and submitting the draw and the GPU time of the frame are printed
+ * for the path in use.
+ */
+class Particles : public BaseApplication
+{
+  public:
+    virtual ~Particles() = default;
+
+  private:
+    static constexpr std::size_t QUERY_COUNT{4};
+    static constexpr std::size_t REPORT_FRAMES{120};
+    static constexpr std::uint32_t MAX_PARTICLES{1u << 24};
+    static constexpr float PARTICLE_SIZE{0.006f};
+
+    void
+    setup(void) override
+    {
+        /* Plain sprites are drawn until the image arrives */
+        pending_texture = Loader::loadTexture(*loader, YANFEI_FILE);
+
+        emitter = ParticleSystem::getDefaultEmitter();
+        const auto capacity = std::clamp(options.getNumber<std::uint32_t>("particles", 250000), std::uint32_t{1}, MAX_PARTICLES);
+        /* Keeps the pool about full with the average lifetime of three quarters of the emitter's */
+        emission_rate = std::max(options.getNumber<float>("emission", static_cast<float>(capacity) / (0.75f * emitter.lifetime)), 0.0f);
+        ParticleSystem::Path path = ParticleSystem::Path::GPU;
+        if (const auto path_name = options.getValue("simulation")) {
+            if (const auto parsed = ParticleSystem::parsePath(*path_name)) {
+                path = *parsed;
+            } else {
+                fmt::print(stderr, "setup: {}\n", "Unknown simulation path, expected gpu or cpu.");
+            }
+        }
+
+        simulation = std::make_unique<ParticleSystem::Simulation>(UPDATE_SHADER_FILE, VERTEX_SHADER_FILE, FRAGMENT_SHADER_FILE);
+        simulation->setPath(path);
+        simulation->resize(capacity);
+        glGenQueries(QUERY_COUNT, queries.data());
+        printSettings();
+        damage.addAnimation(0.0);
+
+        input.bind({
+            {QUIT, GLFW_KEY_ESCAPE},
+            {MORE_PARTICLES, GLFW_KEY_UP},
+            {FEWER_PARTICLES, GLFW_KEY_DOWN},
+            {MORE_EMISSION, GLFW_KEY_RIGHT},
+            {LESS_EMISSION, GLFW_KEY_LEFT},
+            {SWITCH_PATH, GLFW_KEY_SPACE},
+        });
+    }
+
+    enum Action : Input::ActionId
+    {
+        QUIT,
+        MORE_PARTICLES,
+        FEWER_PARTICLES,
+        MORE_EMISSION,
+        LESS_EMISSION,
+        SWITCH_PATH
+    };
+
+    void
+    processInputs(void) override
+    {
+        if (input.isDown(QUIT)) {
+            glfwSetWindowShouldClose(window, GLFW_TRUE);
+        }
+        const std::uint32_t capacity = simulation->getCapacity();
+        if (input.wasPressed(MORE_PARTICLES) && capacity < MAX_PARTICLES) {
+            const std::uint32_t grown = std::min(capacity * 2, MAX_PARTICLES);
+            resize(grown, emission_rate * static_cast<float>(grown) / static_cast<float>(capacity));
+        }
+        if (input.wasPressed(FEWER_PARTICLES) && capacity > 1) {
+            resize(capacity / 2, emission_rate * 0.5f);
+        }
+        if (input.wasPressed(MORE_EMISSION)) {
+            emission_rate = std::max(emission_rate * 2.0f, 1.0f);
+            printSettings();
+        }
+        if (input.wasPressed(LESS_EMISSION)) {
+            emission_rate *= 0.5f;
+            printSettings();
+        }
+        if (input.wasPressed(SWITCH_PATH)) {
+            simulation->setPath(ParticleSystem::Path::GPU == simulation->getPath() ? ParticleSystem::Path::CPU : ParticleSystem::Path::GPU);
+            restart();
+        }
+    }
+
+    /* The emission follows the pool so that its fill rate stays the same */
+    void
+    resize(std::uint32_t capacity, float rate)
+    {
+        simulation->resize(capacity);
+        emission_rate = rate;
+        restart();
+    }
+
+    /* Measurements of the previous settings would be mixed with the new ones otherwise */
+    void
+    restart(void)
+    {
+        clock.reset();
+        frames_measured = gpu_samples = 0;
+        simulate_total = draw_total = gpu_total = 0.0;
+        printSettings();
+    }
+
+    void
+    printSettings(void) const
+    {
+        fmt::print("Particles: {} simulation, {} particles, {:.0f} emitted per second\n", ParticleSystem::getPathName(simulation->getPath()),
+                   simulation->getCapacity(), static_cast<double>(emission_rate));
+    }
+
+    void
+    render(void) override
+    {
+        const auto delta = static_cast<float>(std::min(frame_time - last_frame_time, 0.1));
+        last_frame_time = frame_time;
+        glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+        glClear(GL_COLOR_BUFFER_BIT);
+        /* Every frame is drawn anyway, no need to ask for one while the image loads */
+        Loader::refreshTexture(*loader, pending_texture, texture, YANFEI_FILE);
+        glBeginQuery(GL_TIME_ELAPSED, queries[query_index]);
+
+        const auto simulate_start = std::chrono::steady_clock::now();
+        simulation->simulate(emitter, delta, clock.advance(delta, emission_rate, simulation->getCapacity()));
+        const auto draw_start = std::chrono::steady_clock::now();
+        simulation->draw(PARTICLE_SIZE, texture.get());
+        const auto draw_end = std::chrono::steady_clock::now();
+
+        glEndQuery(GL_TIME_ELAPSED);
+        query_index = (query_index + 1) % QUERY_COUNT;
+        accumulate(std::chrono::duration<double, std::milli>(draw_start - simulate_start).count(),
+                   std::chrono::duration<double, std::milli>(draw_end - draw_start).count());
+    }
+
+    /* Queries are read QUERY_COUNT - 1 frames late so that reading them does not stall */
+    void
+    accumulate(double simulate_milliseconds, double draw_milliseconds)
+    {
+        ++frames_measured;
+        simulate_total += simulate_milliseconds;
+        draw_total += draw_milliseconds;
+        if (frame_count + 1 >= QUERY_COUNT) {
+            GLint available = GL_FALSE;
+            glGetQueryObjectiv(queries[query_index], GL_QUERY_RESULT_AVAILABLE, &available);
+            if (GL_TRUE == available) {
+                GLuint64 nanoseconds = 0;
+                glGetQueryObjectui64v(queries[query_index], GL_QUERY_RESULT, &nanoseconds);
+                gpu_total += static_cast<double>(nanoseconds) * 1e-6;
+                ++gpu_samples;
+            }
+        }
+        if (frames_measured < REPORT_FRAMES) {
+            return;
+        }
+        const auto frames = static_cast<double>(frames_measured);
+        fmt::print("Particles: {} {} particles, simulate {:.3f} ms, draw submission {:.3f} ms CPU, frame {:.3f} ms GPU\n",
+                   ParticleSystem::getPathName(simulation->getPath()), simulation->getCapacity(), simulate_total / frames, draw_total / frames,
+                   gpu_total / static_cast<double>(std::max(gpu_samples, std::size_t{1})));
+        frames_measured = gpu_samples = 0;
+        simulate_total = draw_total = gpu_total = 0.0;
+    }
+
+    void
+    teardown(void) override
+    {
+        glDeleteQueries(QUERY_COUNT, queries.data());
+        simulation.reset();
+        pending_texture.reset();
+        texture.reset();
+    }
+
+    std::unique_ptr<ParticleSystem::Simulation> simulation = nullptr;
+    ParticleSystem::Emitter emitter{};
+    ParticleSystem::EmissionClock clock{};
+    float emission_rate = 0.0f;
+    Resource::Texture texture{};
+    Loader::Pending<Resource::Texture> pending_texture{};
+
+    std::array<GLuint, QUERY_COUNT> queries{};
+    std::size_t query_index = 0;
+    double last_frame_time = 0.0;
+    std::size_t frames_measured = 0;
+    std::size_t gpu_samples = 0;
+    double simulate_total = 0.0;
+    double draw_total = 0.0;
+    double gpu_total = 0.0;
+};
+
+#ifdef SCENE_HOST
+std::unique_ptr<BaseApplication>
+createParticles(void)
+{
+    return std::make_unique<Particles>();
+}
+#else
+int
+main(int argc, char **argv)
+{
+    Particles app{};
+    return app.run(argc, argv);
+}
+#endif
@@ -0,0 +1,21 @@
+#version 330 core
+in vec2 TexCoords;
+in float Fade;
+
+out vec4 FragColour;
+
+uniform sampler2D sprite;
+/* Plain white until the image is loaded */
+uniform bool textured;
+
+const vec3 HOT = vec3(1.0, 0.6, 0.2);
+const vec3 COLD = vec3(0.2, 0.3, 1.0);
+
+void
+main()
+{
+    /* Round soft sprite tinted by its heat, cooling down as it ages */
+    float falloff = max(1.0 - length(TexCoords * 2.0 - 1.0), 0.0);
+    vec3 image = textured ? texture(sprite, TexCoords).rgb : vec3(1.0);
+    FragColour = vec4(image * mix(COLD, HOT, Fade), falloff * falloff * Fade);
+}
@@ -0,0 +1,25 @@
+#version 330 core
+layout(location = 0) in vec2 aCorner;
+layout(location = 1) in vec2 aPosition;
+layout(location = 2) in float aAge;
+layout(location = 3) in float aLifetime;
+
+out vec2 TexCoords;
+out float Fade;
+
+uniform float size;
+
+void
+main()
+{
+    /* Dead particles end up outside the clip volume and are never rasterised */
+    if (aAge >= aLifetime) {
+        gl_Position = vec4(2.0, 2.0, 2.0, 1.0);
+        TexCoords = vec2(0.0);
+        Fade = 0.0;
+        return;
+    }
+    gl_Position = vec4(aPosition + aCorner * size, 0.0, 1.0);
+    TexCoords = aCorner * 0.5 + 0.5;
+    Fade = 1.0 - aAge / aLifetime;
+}
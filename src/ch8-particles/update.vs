@@ -0,0 +1,70 @@
+#version 330 core
+layout(location = 0) in vec2 aPosition;
+layout(location = 1) in vec2 aVelocity;
+layout(location = 2) in float aAge;
+layout(location = 3) in float aLifetime;
+
+/* Captured by transform feedback, interleaved in this order */
+out vec2 Position;
+out vec2 Velocity;
+out float Age;
+out float Lifetime;
+
+uniform float delta;
+uniform vec2 origin;
+uniform vec2 gravity;
+uniform float spread;
+uniform float speed;
+uniform float lifetime;
+uniform float bounce;
+uniform int capacity;
+uniform int spawn_begin;
+uniform int spawn_count;
+uniform int seed;
+
+const float FLOOR = -1.0;
+
+/* Same hash as ParticleSystem::hash */
+uint
+hash(uint value)
+{
+    value ^= value >> 16u;
+    value *= 0x7FEB352Du;
+    value ^= value >> 15u;
+    value *= 0x846CA68Bu;
+    value ^= value >> 16u;
+    return value;
+}
+
+float
+random(uint index, uint salt)
+{
+    return float(hash(index * 3u + salt + uint(seed) * 0x9E3779B9u) >> 8u) * (1.0 / 16777216.0);
+}
+
+void
+main()
+{
+    uint index = uint(gl_VertexID);
+    uint slots = uint(capacity);
+    if ((index + slots - uint(spawn_begin)) % slots < uint(spawn_count)) {
+        float angle = 1.5707964 + (random(index, 0u) - 0.5) * spread;
+        float initial_speed = speed * (0.5 + 0.5 * random(index, 1u));
+        Position = origin;
+        Velocity = initial_speed * vec2(cos(angle), sin(angle));
+        Age = 0.0;
+        Lifetime = lifetime * (0.5 + 0.5 * random(index, 2u));
+        return;
+    }
+
+    vec2 velocity = aVelocity + gravity * delta;
+    vec2 position = aPosition + velocity * delta;
+    if (position.y < FLOOR) {
+        position.y = FLOOR;
+        velocity.y = abs(velocity.y) * bounce;
+    }
+    Position = position;
+    Velocity = velocity;
+    Age = aAge + delta;
+    Lifetime = aLifetime;
+}
@@ -0,0 +1,172 @@
+#include "BaseApplication.hpp"
+#include "JobSystem.hpp"
+#include "Utils.hpp"
+
+#include <fmt/core.h>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+/* Several chapters in one process, every scene renders on its own thread into its own context */
+
+std::unique_ptr<BaseApplication> createHelloTriangle(void);
+std::unique_ptr<BaseApplication> createShading(void);
+std::unique_ptr<BaseApplication> createTexture(void);
+std::unique_ptr<BaseApplication> createMatrix(void);
+std::unique_ptr<BaseApplication> createSprites(void);
+std::unique_ptr<BaseApplication> createStress(void);
+std::unique_ptr<BaseApplication> createPostProcess(void);
+std::unique_ptr<BaseApplication> createParticles(void);
+
+struct SceneFactory
+{
+    std::string_view name;
+    std::unique_ptr<BaseApplication> (*create)(void);
+};
+
+static constexpr std::array<SceneFactory, 8> SCENE_FACTORIES{{{"HelloTriangle", createHelloTriangle},
+                                                              {"Shading", createShading},
+                                                              {"Texture", createTexture},
+                                                              {"Matrix", createMatrix},
+                                                              {"Sprites", createSprites},
+                                                              {"Stress", createStress},
+                                                              {"PostProcess", createPostProcess},
+                                                              {"Particles", createParticles}}};
+
+struct Scene
+{
+    std::string_view name;
+    std::unique_ptr<BaseApplication> application;
+};
+
+static std::vector<Scene> createScenes(std::string_view names);
+static bool loadGl(GLFWwindow *window);
+
+/*
+ * Launch options:
+ *   --scenes=A,B,...  scenes to run side by side, by executable name and possibly repeated, every chapter by default
+ *   --seconds=S       run for S seconds, 10 by default
+ * Every other option is handed to the scenes, --headless renders offscreen into hidden windows.
+ */
+int
+main(int argc, char **argv)
+{
+    const Utils::CommandLine options{argc, argv};
+    const double run_seconds = std::max(options.getNumber<double>("seconds", 10.0), 0.0);
+    std::vector<Scene> scenes = createScenes(options.getValue("scenes").value_or(""));
+    if (scenes.empty()) {
+        return 1;
+    }
+
+    Utils::JobSystem::configure({options.getNumber<std::size_t>("workers", 0), options.hasFlag("pin-workers")});
+    /* The scenes decode the same images and read the same shaders */
+    Utils::FileCache::getInstance().setEnabled(true);
+    if (GLFW_FALSE == glfwInit()) {
+        fmt::print(stderr, "main: {}\n", "Failed to initialise GLFW.");
+        return 1;
+    }
+
+    GLFWwindow *first_window = nullptr;
+    for (Scene &scene : scenes) {
+        if (0 > scene.application->openHostedWindow(options)) {
+            glfwTerminate();
+            return 1;
+        }
+        if (nullptr == first_window) {
+            first_window = scene.application->getWindow();
+        }
+    }
+    if (!loadGl(first_window)) {
+        glfwTerminate();
+        return 1;
+    }
+
+    std::atomic<std::size_t> finished{0};
+    std::vector<std::jthread> threads{};
+    threads.reserve(scenes.size());
+    for (Scene &scene : scenes) {
+        threads.emplace_back([&scene, &finished] {
+            scene.application->runHosted();
+            finished.fetch_add(1, std::memory_order_release);
+            glfwPostEmptyEvent();
+        });
+    }
+
+    /* Window events are only delivered on the main thread */
+    const double start = glfwGetTime();
+    bool close_requested = false;
+    while (finished.load(std::memory_order_acquire) < scenes.size()) {
+        const double elapsed = glfwGetTime() - start;
+        if (!close_requested && elapsed >= run_seconds) {
+            for (Scene &scene : scenes) {
+                scene.application->requestClose();
+            }
+            close_requested = true;
+        }
+        glfwWaitEventsTimeout(close_requested ? 0.1 : run_seconds - elapsed);
+    }
+    threads.clear();
+
+    double total_fps = 0.0;
+    for (Scene &scene : scenes) {
+        const std::uint64_t frames = scene.application->getFrameCount();
+        const double seconds = scene.application->getLoopSeconds();
+        const double fps = 0.0 < seconds ? static_cast<double>(frames) / seconds : 0.0;
+        total_fps += fps;
+        fmt::print("{:<16} {:>8} frames in {:.2f} s, {:.1f} fps\n", scene.name, frames, seconds, fps);
+        /* GL objects are deleted with their context current */
+        glfwMakeContextCurrent(scene.application->getWindow());
+        scene.application.reset();
+    }
+    glfwMakeContextCurrent(nullptr);
+    const Utils::FileCache &cache = Utils::FileCache::getInstance();
+    fmt::print("{} scenes on {} hardware threads: {:.1f} fps in total, {} files loaded, {} served from the cache\n", scenes.size(),
+               std::thread::hardware_concurrency(), total_fps, cache.getLoadCount(), cache.getHitCount());
+
+    glfwTerminate();
+    return 0;
+}
+
+static std::vector<Scene>
+createScenes(std::string_view names)
+{
+    std::vector<Scene> scenes{};
+    if (names.empty()) {
+        for (const SceneFactory &factory : SCENE_FACTORIES) {
+            scenes.push_back({factory.name, factory.create()});
+        }
+        return scenes;
+    }
+    while (!names.empty()) {
+        const std::size_t separator = std::min(names.find(','), names.size());
+        const std::string_view name = names.substr(0, separator);
+        names.remove_prefix(std::min(separator + 1, names.size()));
+        const auto factory = std::find_if(SCENE_FACTORIES.begin(), SCENE_FACTORIES.end(), [name](const SceneFactory &entry) { return entry.name == name; });
+        if (SCENE_FACTORIES.end() == factory) {
+            fmt::print(stderr, "createScenes: Unknown scene {}.\n", name);
+            return {};
+        }
+        scenes.push_back({factory->name, factory->create()});
+    }
+    return scenes;
+}
+
+/* The entry points are shared by every context, they all come from the same driver */
+static bool
+loadGl(GLFWwindow *window)
+{
+    glfwMakeContextCurrent(window);
+    const bool is_loaded = 0 != gladLoadGLLoader(reinterpret_cast<GLADloadproc>(glfwGetProcAddress));
+    glfwMakeContextCurrent(nullptr);
+    if (!is_loaded) {
+        fmt::print(stderr, "loadGl: {}\n", "Failed to initialise GLAD.");
+    }
+    return is_loaded;
+}
@@ -0,0 +1,142 @@
+#include "Telemetry.hpp"
+#include "Utils.hpp"
+
+#include <fmt/core.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+/* Follows the frame telemetry an application publishes with --telemetry, from another process */
+
+struct RollingStats
+{
+    double fps;
+    double average_ms, p99_ms, max_ms;
+    double input_ms, render_ms, present_ms;
+    double draws, gl_calls;
+    std::uint64_t gpu_memory_bytes;
+};
+
+static RollingStats getRollingStats(const std::deque<Telemetry::FrameRecord> &window);
+static void writeCsvRecords(std::ofstream &stream, const std::vector<Telemetry::FrameRecord> &frames);
+
+/*
+ * Launch options:
+ *   --name=NAME     shared memory ring to follow, the default one of --telemetry otherwise
+ *   --interval=S    seconds between two printed lines, 1 by default
+ *   --window=N      frames the rolling statistics are computed over, 240 by default
+ *   --csv=PATH      also write every frame received to PATH
+ * Waits for the application to start and exits once it closed the ring.
+ */
+int
+main(int argc, char **argv)
+{
+    const Utils::CommandLine options{argc, argv};
+    const std::string name = Telemetry::getSharedName(options.getValue("name").value_or(Telemetry::DEFAULT_NAME));
+    const auto interval = std::chrono::duration<double>(std::max(options.getNumber<double>("interval", 1.0), 0.01));
+    const std::size_t window_size = std::max(options.getNumber<std::size_t>("window", 240), std::size_t{1});
+
+    std::ofstream csv{};
+    if (const auto csv_path = options.getValue("csv")) {
+        csv.open(std::string{*csv_path}, std::ios::out | std::ios::trunc);
+        if (!csv.is_open()) {
+            fmt::print(stderr, "main: Failed to open file {}.\n", *csv_path);
+            return 1;
+        }
+        csv << "frame,time,frame_ms,input_ms,render_ms,present_ms,draws,gl_calls,gpu_memory_bytes\n";
+    }
+
+    std::unique_ptr<Telemetry::Subscriber> subscriber = std::make_unique<Telemetry::Subscriber>(name);
+    if (!subscriber->isOpen()) {
+        fmt::print("Waiting for {}...\n", name);
+        while (!subscriber->isOpen()) {
+            std::this_thread::sleep_for(interval);
+            subscriber = std::make_unique<Telemetry::Subscriber>(name);
+        }
+    }
+
+    fmt::print("{:>8} {:>8} {:>9} {:>9} {:>9} {:>9} {:>9} {:>9} {:>7} {:>8} {:>9} {:>6}\n", "Frame", "FPS", "avg ms", "p99 ms", "max ms", "input", "render",
+               "present", "draws", "GL calls", "GPU MiB", "lost");
+    std::deque<Telemetry::FrameRecord> window{};
+    std::vector<Telemetry::FrameRecord> frames{};
+    std::uint64_t total_lost = 0;
+    while (true) {
+        const bool is_publisher_open = subscriber->isPublisherOpen();
+        frames.clear();
+        const std::uint64_t lost = subscriber->read(frames);
+        total_lost += lost;
+        if (csv.is_open()) {
+            writeCsvRecords(csv, frames);
+        }
+        for (const Telemetry::FrameRecord &frame : frames) {
+            window.push_back(frame);
+            if (window.size() > window_size) {
+                window.pop_front();
+            }
+        }
+        if (!frames.empty()) {
+            static constexpr double MEBIBYTE{1024.0 * 1024.0};
+            const RollingStats stats = getRollingStats(window);
+            fmt::print("{:>8} {:>8.1f} {:>9.3f} {:>9.3f} {:>9.3f} {:>9.3f} {:>9.3f} {:>9.3f} {:>7.0f} {:>8.0f} {:>9.2f} {:>6}\n", window.back().frame, stats.fps,
+                       stats.average_ms, stats.p99_ms, stats.max_ms, stats.input_ms, stats.render_ms, stats.present_ms, stats.draws, stats.gl_calls,
+                       static_cast<double>(stats.gpu_memory_bytes) / MEBIBYTE, lost);
+        }
+        /* Checked before reading so that the last frames are not missed */
+        if (!is_publisher_open) {
+            break;
+        }
+        std::this_thread::sleep_for(interval);
+    }
+    fmt::print("Publisher closed, {} frames lost to overruns.\n", total_lost);
+    return 0;
+}
+
+static RollingStats
+getRollingStats(const std::deque<Telemetry::FrameRecord> &window)
+{
+    RollingStats stats{0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, window.back().gpu_memory_bytes};
+    std::vector<double> frame_ms{};
+    frame_ms.reserve(window.size());
+    for (const Telemetry::FrameRecord &frame : window) {
+        frame_ms.push_back(static_cast<double>(frame.frame_ms));
+        stats.input_ms += static_cast<double>(frame.input_ms);
+        stats.render_ms += static_cast<double>(frame.render_ms);
+        stats.present_ms += static_cast<double>(frame.present_ms);
+        stats.draws += static_cast<double>(frame.draws);
+        stats.gl_calls += static_cast<double>(frame.gl_calls);
+    }
+    std::sort(frame_ms.begin(), frame_ms.end());
+    const double count = static_cast<double>(window.size());
+    for (double duration : frame_ms) {
+        stats.average_ms += duration;
+    }
+    stats.average_ms /= count;
+    stats.p99_ms = frame_ms[static_cast<std::size_t>(0.99 * (count - 1.0))];
+    stats.max_ms = frame_ms.back();
+    stats.input_ms /= count;
+    stats.render_ms /= count;
+    stats.present_ms /= count;
+    stats.draws /= count;
+    stats.gl_calls /= count;
+    /* From the frame start times, idle rendering makes it lower than 1000 / average_ms */
+    const double elapsed = window.back().time - window.front().time;
+    stats.fps = 1 < window.size() && 0.0 < elapsed ? (count - 1.0) / elapsed : 0.0;
+    return stats;
+}
+
+static void
+writeCsvRecords(std::ofstream &stream, const std::vector<Telemetry::FrameRecord> &frames)
+{
+    for (const Telemetry::FrameRecord &frame : frames) {
+        stream << fmt::format("{},{:.6f},{:.4f},{:.4f},{:.4f},{:.4f},{},{},{}\n", frame.frame, frame.time, frame.frame_ms, frame.input_ms, frame.render_ms,
+                              frame.present_ms, frame.draws, frame.gl_calls, frame.gpu_memory_bytes);
+    }
+    stream.flush();
+}